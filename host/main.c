@@ -0,0 +1,49 @@
+// main.c — Firmware auf dem Host: Optionen lesen, dann app_main() wie auf dem Board
+//
+//   look_host --frames host/test/frames [--port 8080] [--fps 25] [--ssid look-host]
+//             [--nvs look.nvs]
+//
+// RTSP lauscht auf RTSP_PORT (im Host-Build 8554). LOOK_LOG=debug|warn|…
+// stellt die Log-Stufe ein.
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_camera.h"
+#include "esp_http_server.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+
+void app_main(void);
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s --frames DIR [--port N] [--fps N] [--ssid S] [--nvs FILE]\n",
+            prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *frames = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) usage(argv[0]);
+        if (strcmp(arg, "--frames") == 0)    frames = val;
+        else if (strcmp(arg, "--port") == 0) host_httpd_setup((uint16_t)atoi(val));
+        else if (strcmp(arg, "--fps") == 0)  host_camera_setup(NULL, atoi(val));
+        else if (strcmp(arg, "--ssid") == 0) host_wifi_setup(val);
+        else if (strcmp(arg, "--nvs") == 0)  host_nvs_setup(val);
+        else usage(argv[0]);
+        i++;
+    }
+    if (!frames) usage(argv[0]);
+    host_camera_setup(frames, 0);
+
+    // Abgebrochene Verbindungen liefern EPIPE statt eines Signals (wie lwIP)
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stderr, NULL, _IOLBF, 0);
+    app_main();
+    return 0;
+}
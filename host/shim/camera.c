@@ -0,0 +1,377 @@
+// camera.c — esp32-camera-Ersatz: spielt aufgezeichnete JPEGs als Sensor ab
+//
+// Alle *.jpg aus --frames werden beim Start geladen und nach ihrer SOF-Größe
+// gruppiert; jede Gruppe läuft als Endlosschleife in Dateinamen-Reihenfolge.
+// esp_camera_fb_get() liefert im Takt der Sensor-Bildrate (--fps) und
+// verhält sich beim Moduswechsel wie der Treiber: fb->width/height kommen aus
+// sensor.status, der erste Frame danach ist noch im alten Format.
+// Fehlt eine Größe, wird die nächstgelegene mit umgeschriebenem SOF geliefert
+// (Länge und Timing stimmen dann ungefähr, der Bildinhalt nicht).
+//
+// Der Sensor hat eine Registerdatei mit den Startwerten des OV5640 für PLL,
+// Timing und Belichtung, damit ov5640_ae und die SCCB-Bursts etwas lesen.
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_camera.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "host_shim.h"
+#include "jpeg_scan.h"
+
+static const char *TAG = "host_cam";
+
+#define CAM_MAX_FRAMES   512
+#define CAM_SCCB_ADDR    0x3C
+
+const resolution_info_t resolution[FRAMESIZE_INVALID] = {
+    {   96,   96, 0 }, {  160,  120, 0 }, {  128,  128, 0 }, {  176,  144, 0 },
+    {  240,  176, 0 }, {  240,  240, 0 }, {  320,  240, 0 }, {  320,  320, 0 },
+    {  400,  296, 0 }, {  480,  320, 0 }, {  640,  480, 0 }, {  800,  600, 0 },
+    { 1024,  768, 0 }, { 1280,  720, 0 }, { 1280, 1024, 0 }, { 1600, 1200, 0 },
+    { 1920, 1080, 0 }, {  720, 1280, 0 }, {  864, 1536, 0 }, { 2048, 1536, 0 },
+    { 2560, 1440, 0 }, { 2560, 1600, 0 }, { 1080, 1920, 0 }, { 2560, 1920, 0 },
+    { 2592, 1944, 0 },
+};
+
+typedef struct {
+    uint8_t *jpg;
+    size_t   len;
+    uint16_t w, h;
+} cam_frame_t;
+
+typedef struct {
+    camera_fb_t fb;
+    bool        used;
+} cam_fb_slot_t;
+
+static const char     *s_dir;
+static int             s_fps = 25;
+static cam_frame_t     s_frames[CAM_MAX_FRAMES];
+static int             s_nframes;
+static int             s_next[FRAMESIZE_INVALID];     // nächster Frame pro Größe
+static bool            s_warned[FRAMESIZE_INVALID];
+static uint8_t        *s_subst[CAM_MAX_FRAMES][FRAMESIZE_INVALID];
+
+static pthread_mutex_t s_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_cv = PTHREAD_COND_INITIALIZER;
+static cam_fb_slot_t  *s_fbs;
+static size_t          s_fb_count;
+static int64_t         s_next_us;
+static framesize_t     s_stale_size;
+static int             s_stale;          // Frames im alten Format, die noch kommen
+static sensor_t        s_sensor;
+static uint8_t         s_regs[0x10000];
+static bool            s_ready;
+
+void host_camera_setup(const char *frames_dir, int fps)
+{
+    s_dir = frames_dir;
+    if (fps > 0) s_fps = fps;
+}
+
+// -----------------------------------------------------------------------------
+// Registerdatei
+// -----------------------------------------------------------------------------
+uint8_t host_sccb_addr(void)                    { return CAM_SCCB_ADDR; }
+uint8_t host_sccb_read(uint16_t reg)            { return s_regs[reg]; }
+void    host_sccb_write(uint16_t reg, uint8_t v) { s_regs[reg] = v; }
+
+static void regs_timing(framesize_t fs)
+{
+    // Wie die Modustabellen des Treibers: bis 1280 px Breite gebinnt
+    // (1896 × 984), darüber volle Auflösung (2844 × 1968)
+    bool bin = resolution[fs].width <= 1280;
+    uint16_t hts = bin ? 1896 : 2844, vts = bin ? 984 : 1968;
+    s_regs[0x380C] = hts >> 8;
+    s_regs[0x380D] = hts & 0xFF;
+    s_regs[0x380E] = vts >> 8;
+    s_regs[0x380F] = vts & 0xFF;
+    s_regs[0x3820] = (s_regs[0x3820] & ~0x01) | (bin ? 0x01 : 0x00);
+}
+
+static void regs_init(void)
+{
+    s_regs[0x300A] = 0x56;          // Chip-ID
+    s_regs[0x300B] = 0x40;
+    s_regs[0x3034] = 0x1A;          // PLL: 10-Bit-MIPI, ×0x46, ÷3, Root ÷2
+    s_regs[0x3035] = 0x11;
+    s_regs[0x3036] = 0x46;
+    s_regs[0x3037] = 0x13;
+    s_regs[0x3108] = 0x01;
+    s_regs[0x3500] = 0x00;          // Belichtung 0x0320 Zeilen (× 16)
+    s_regs[0x3501] = 0x32;
+    s_regs[0x3502] = 0x00;
+    s_regs[0x3503] = 0x00;          // AEC/AGC automatisch
+    s_regs[0x350A] = 0x00;          // Verstärkung 2×
+    s_regs[0x350B] = 0x20;
+    regs_timing(FRAMESIZE_VGA);
+}
+
+// -----------------------------------------------------------------------------
+// Sensor-Funktionen
+// -----------------------------------------------------------------------------
+static int set_framesize(sensor_t *s, framesize_t fs)
+{
+    if (fs < 0 || fs >= FRAMESIZE_INVALID) return -1;
+    pthread_mutex_lock(&s_mu);
+    if (fs != s->status.framesize) {
+        // Im Ring liegt noch ein Frame im alten Modus
+        if (!s_stale) s_stale_size = s->status.framesize;
+        s_stale = 1;
+        s->status.framesize = fs;
+        regs_timing(fs);
+    }
+    pthread_mutex_unlock(&s_mu);
+    return 0;
+}
+
+static int set_quality(sensor_t *s, int q)    { s->status.quality  = q; return 0; }
+static int set_hmirror(sensor_t *s, int on)   { s->status.hmirror  = !!on; return 0; }
+static int set_vflip(sensor_t *s, int on)     { s->status.vflip    = !!on; return 0; }
+static int set_colorbar(sensor_t *s, int on)  { s->status.colorbar = !!on; return 0; }
+
+static int get_reg(sensor_t *s, int reg, int mask)
+{
+    return s_regs[reg & 0xFFFF] & mask;
+}
+
+static int set_reg(sensor_t *s, int reg, int mask, int value)
+{
+    uint8_t *r = &s_regs[reg & 0xFFFF];
+    *r = (*r & ~mask) | (value & mask);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Frames laden
+// -----------------------------------------------------------------------------
+static int name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static framesize_t size_index(uint16_t w, uint16_t h)
+{
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+        if (resolution[i].width == w && resolution[i].height == h) return i;
+    }
+    return FRAMESIZE_INVALID;
+}
+
+static esp_err_t frames_load(void)
+{
+    DIR *d = s_dir ? opendir(s_dir) : NULL;
+    if (!d) {
+        ESP_LOGE(TAG, "cannot open frame directory %s", s_dir ? s_dir : "(none)");
+        return ESP_ERR_NOT_FOUND;
+    }
+    char *names[CAM_MAX_FRAMES];
+    int n = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) && n < CAM_MAX_FRAMES) {
+        const char *dot = strrchr(e->d_name, '.');
+        if (dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0)) {
+            names[n++] = strdup(e->d_name);
+        }
+    }
+    closedir(d);
+    qsort(names, n, sizeof(names[0]), name_cmp);
+
+    for (int i = 0; i < n; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", s_dir, names[i]);
+        FILE *f = fopen(path, "rb");
+        free(names[i]);
+        if (!f) continue;
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        cam_frame_t *fr = &s_frames[s_nframes];
+        fr->jpg = len > 0 ? malloc(len) : NULL;
+        if (fr->jpg && fread(fr->jpg, 1, len, f) == (size_t)len &&
+            jpeg_frame_size(fr->jpg, len, &fr->w, &fr->h) == ESP_OK) {
+            fr->len = len;
+            s_nframes++;
+        } else {
+            ESP_LOGW(TAG, "%s: not a baseline JPEG, skipped", path);
+            free(fr->jpg);
+        }
+        fclose(f);
+    }
+    if (!s_nframes) {
+        ESP_LOGE(TAG, "no JPEG frames in %s", s_dir);
+        return ESP_ERR_NOT_FOUND;
+    }
+    for (int fs = 0; fs < FRAMESIZE_INVALID; fs++) {
+        int k = 0;
+        for (int i = 0; i < s_nframes; i++) {
+            k += s_frames[i].w == resolution[fs].width && s_frames[i].h == resolution[fs].height;
+        }
+        if (k) ESP_LOGI(TAG, "%ux%u: %d frame(s)", resolution[fs].width, resolution[fs].height, k);
+    }
+    for (int i = 0; i < s_nframes; i++) {
+        if (size_index(s_frames[i].w, s_frames[i].h) == FRAMESIZE_INVALID) {
+            ESP_LOGW(TAG, "%ux%u is not a sensor frame size, never delivered",
+                     s_frames[i].w, s_frames[i].h);
+        }
+    }
+    return ESP_OK;
+}
+
+// Frame mit SOF-Größe w×h kopieren (Ersatz für eine fehlende Größe)
+static uint8_t *sof_rewrite(const cam_frame_t *src, uint16_t w, uint16_t h)
+{
+    uint8_t *p = malloc(src->len);
+    if (!p) return NULL;
+    memcpy(p, src->jpg, src->len);
+    for (size_t i = 2; i + 9 < src->len; ) {
+        if (p[i] != 0xFF) return p;
+        uint8_t m = p[i + 1];
+        size_t seg = (size_t)p[i + 2] << 8 | p[i + 3];
+        if (m == 0xC0 || m == 0xC1) {
+            p[i + 5] = h >> 8;
+            p[i + 6] = h & 0xFF;
+            p[i + 7] = w >> 8;
+            p[i + 8] = w & 0xFF;
+            return p;
+        }
+        i += 2 + seg;
+    }
+    return p;
+}
+
+// Nächster Frame für fs (Aufrufer hält s_mu)
+static void frame_pick(framesize_t fs, uint8_t **jpg, size_t *len)
+{
+    const uint16_t w = resolution[fs].width, h = resolution[fs].height;
+    int best = -1;
+    long best_d = 0;
+    for (int k = 0; k < s_nframes; k++) {
+        int i = (s_next[fs] + k) % s_nframes;
+        if (s_frames[i].w == w && s_frames[i].h == h) {
+            s_next[fs] = i + 1;
+            *jpg = s_frames[i].jpg;
+            *len = s_frames[i].len;
+            return;
+        }
+        long d = labs((long)s_frames[i].w * s_frames[i].h - (long)w * h);
+        if (best < 0 || d < best_d) {
+            best   = i;
+            best_d = d;
+        }
+    }
+    // Größe fehlt: nächstliegende Größe mit passendem SOF
+    if (!s_warned[fs]) {
+        s_warned[fs] = true;
+        ESP_LOGW(TAG, "no %ux%u frames, substituting %ux%u with rewritten SOF",
+                 w, h, s_frames[best].w, s_frames[best].h);
+    }
+    if (!s_subst[best][fs]) s_subst[best][fs] = sof_rewrite(&s_frames[best], w, h);
+    *jpg = s_subst[best][fs] ? s_subst[best][fs] : s_frames[best].jpg;
+    *len = s_frames[best].len;
+}
+
+// -----------------------------------------------------------------------------
+// esp_camera-API
+// -----------------------------------------------------------------------------
+esp_err_t esp_camera_init(const camera_config_t *config)
+{
+    if (s_ready) return ESP_ERR_INVALID_STATE;
+    if (config->pixel_format != PIXFORMAT_JPEG) return ESP_ERR_NOT_SUPPORTED;
+    esp_err_t err = frames_load();
+    if (err != ESP_OK) return err;
+
+    s_fb_count = config->fb_count ? config->fb_count : 1;
+    s_fbs = calloc(s_fb_count, sizeof(*s_fbs));
+    if (!s_fbs) return ESP_ERR_NO_MEM;
+
+    regs_init();
+    s_sensor = (sensor_t){
+        .id            = { .PID = OV5640_PID },
+        .slv_addr      = CAM_SCCB_ADDR,
+        .pixformat     = PIXFORMAT_JPEG,
+        .xclk_freq_hz  = config->xclk_freq_hz ? config->xclk_freq_hz : 20000000,
+        .set_framesize = set_framesize,
+        .set_quality   = set_quality,
+        .set_hmirror   = set_hmirror,
+        .set_vflip     = set_vflip,
+        .set_colorbar  = set_colorbar,
+        .get_reg       = get_reg,
+        .set_reg       = set_reg,
+    };
+    s_sensor.status.framesize = config->frame_size;
+    s_sensor.status.quality   = config->jpeg_quality;
+    regs_timing(config->frame_size);
+    s_next_us = esp_timer_get_time();
+    s_ready   = true;
+    ESP_LOGI(TAG, "replaying %d frame(s) from %s at %d fps", s_nframes, s_dir, s_fps);
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit(void)
+{
+    s_ready = false;
+    return ESP_OK;
+}
+
+sensor_t *esp_camera_sensor_get(void)
+{
+    return s_ready ? &s_sensor : NULL;
+}
+
+camera_fb_t *esp_camera_fb_get(void)
+{
+    if (!s_ready) return NULL;
+
+    // Sensor-Takt: ein Frame pro 1/fps, verpasste Frames fallen weg
+    int64_t period = 1000000 / s_fps;
+    pthread_mutex_lock(&s_mu);
+    int64_t now = esp_timer_get_time();
+    if (s_next_us < now - period) s_next_us = now;
+    int64_t due = s_next_us;
+    s_next_us += period;
+    pthread_mutex_unlock(&s_mu);
+    if (due > now) {
+        struct timespec ts = { (due - now) / 1000000, ((due - now) % 1000000) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+
+    pthread_mutex_lock(&s_mu);
+    cam_fb_slot_t *slot = NULL;
+    while (!slot) {
+        for (size_t i = 0; i < s_fb_count && !slot; i++) {
+            if (!s_fbs[i].used) slot = &s_fbs[i];
+        }
+        if (!slot) pthread_cond_wait(&s_cv, &s_mu);
+    }
+    framesize_t fs = s_sensor.status.framesize;
+    if (s_stale) {
+        s_stale--;
+        fs = s_stale_size;
+    }
+    slot->used = true;
+    camera_fb_t *fb = &slot->fb;
+    frame_pick(fs, &fb->buf, &fb->len);
+    fb->width  = resolution[s_sensor.status.framesize].width;
+    fb->height = resolution[s_sensor.status.framesize].height;
+    fb->format = PIXFORMAT_JPEG;
+    int64_t ts = esp_timer_get_time();
+    fb->timestamp.tv_sec  = ts / 1000000;
+    fb->timestamp.tv_usec = ts % 1000000;
+    pthread_mutex_unlock(&s_mu);
+    return fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    pthread_mutex_lock(&s_mu);
+    for (size_t i = 0; i < s_fb_count; i++) {
+        if (&s_fbs[i].fb == fb) s_fbs[i].used = false;
+    }
+    pthread_cond_signal(&s_cv);
+    pthread_mutex_unlock(&s_mu);
+}
@@ -0,0 +1,126 @@
+// drivers.c — LEDC-, GPIO- und Legacy-I2C-Ersatz
+//
+// LEDC und GPIO haben keine Wirkung. I2C-Command-Links werden gesammelt und
+// bei i2c_master_cmd_begin() gegen die Registerdatei des Ersatz-Sensors
+// ausgeführt: Schreiben = 2 Byte Registeradresse + Daten, Lesen ab der
+// zuletzt gesetzten Adresse, beides mit automatischem Weiterzählen.
+#include <stdlib.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "driver/ledc.h"
+#include "host_shim.h"
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *cfg)     { return ESP_OK; }
+esp_err_t ledc_channel_config(const ledc_channel_config_t *cfg) { return ESP_OK; }
+
+esp_err_t gpio_reset_pin(gpio_num_t n)                           { return ESP_OK; }
+esp_err_t gpio_set_direction(gpio_num_t n, gpio_mode_t mode)     { return ESP_OK; }
+esp_err_t gpio_set_level(gpio_num_t n, uint32_t level)           { return ESP_OK; }
+esp_err_t gpio_set_pull_mode(gpio_num_t n, gpio_pull_mode_t p)   { return ESP_OK; }
+
+#define I2C_MAX_OPS 16
+
+typedef enum { OP_START, OP_STOP, OP_WRITE, OP_READ } i2c_op_kind_t;
+
+typedef struct {
+    i2c_op_kind_t  kind;
+    const uint8_t *wdata;
+    uint8_t       *rdata;
+    size_t         len;
+    uint8_t        byte;      // einzelnes Schreib-Byte (write_byte)
+} i2c_op_t;
+
+struct host_i2c_cmd {
+    i2c_op_t ops[I2C_MAX_OPS];
+    int      n;
+    bool     overflow;
+};
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1, sizeof(struct host_i2c_cmd));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd)
+{
+    free(cmd);
+}
+
+static esp_err_t op_add(i2c_cmd_handle_t cmd, i2c_op_t op)
+{
+    if (cmd->n == I2C_MAX_OPS) {
+        cmd->overflow = true;
+        return ESP_ERR_NO_MEM;
+    }
+    cmd->ops[cmd->n++] = op;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd)
+{
+    return op_add(cmd, (i2c_op_t){ .kind = OP_START });
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd)
+{
+    return op_add(cmd, (i2c_op_t){ .kind = OP_STOP });
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en)
+{
+    return op_add(cmd, (i2c_op_t){ .kind = OP_WRITE, .byte = data, .len = 1 });
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t len, bool ack_en)
+{
+    return op_add(cmd, (i2c_op_t){ .kind = OP_WRITE, .wdata = data, .len = len });
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t len, i2c_ack_type_t ack)
+{
+    return op_add(cmd, (i2c_op_t){ .kind = OP_READ, .rdata = data, .len = len });
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks)
+{
+    if (cmd->overflow) return ESP_ERR_INVALID_STATE;
+    static uint16_t ptr;          // Adresszeiger des Sensors
+    bool addressed = false;       // nach START: nächstes Byte ist die Slave-Adresse
+    bool writing = false;
+    int  addr_bytes = 0;          // Registeradresse: 2 Byte nach der Slave-Adresse
+
+    for (int i = 0; i < cmd->n; i++) {
+        const i2c_op_t *op = &cmd->ops[i];
+        switch (op->kind) {
+        case OP_START:
+            addressed = false;
+            break;
+        case OP_STOP:
+            addressed = false;
+            break;
+        case OP_WRITE:
+            for (size_t k = 0; k < op->len; k++) {
+                uint8_t b = op->wdata ? op->wdata[k] : op->byte;
+                if (!addressed) {
+                    if (b >> 1 != host_sccb_addr()) return ESP_FAIL;   // kein ACK
+                    addressed  = true;
+                    writing    = !(b & 1);
+                    addr_bytes = 0;
+                } else if (!writing) {
+                    return ESP_FAIL;
+                } else if (addr_bytes < 2) {
+                    ptr = addr_bytes++ ? (ptr & 0xFF00) | b : (uint16_t)(b << 8);
+                } else {
+                    host_sccb_write(ptr++, b);
+                }
+            }
+            break;
+        case OP_READ:
+            if (!addressed || writing) return ESP_FAIL;
+            for (size_t k = 0; k < op->len; k++) op->rdata[k] = host_sccb_read(ptr++);
+            break;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,191 @@
+// esp_system.c — Log, esp_timer, Heap, Zufall und Fehlernamen für den Host
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/random.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+
+// -----------------------------------------------------------------------------
+// Log
+// -----------------------------------------------------------------------------
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+static pthread_mutex_t s_log_mu    = PTHREAD_MUTEX_INITIALIZER;
+
+__attribute__((constructor))
+static void log_init(void)
+{
+    static const char *const names[] = { "none", "error", "warn", "info", "debug", "verbose" };
+    const char *env = getenv("LOOK_LOG");
+    for (int i = 0; env && i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcasecmp(env, names[i]) == 0) s_log_level = (esp_log_level_t)i;
+    }
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    if (strcmp(tag, "*") == 0) s_log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    if (level > s_log_level) return;
+    static const char letters[] = "NEWIDV";
+    va_list ap;
+    va_start(ap, fmt);
+    pthread_mutex_lock(&s_log_mu);
+    fprintf(stderr, "%c (%lld) %s: ", letters[level],
+            (long long)(esp_timer_get_time() / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    pthread_mutex_unlock(&s_log_mu);
+    va_end(ap);
+}
+
+// -----------------------------------------------------------------------------
+// esp_timer: ein Thread pro Timer, wartet auf die Frist oder einen Neustart
+// -----------------------------------------------------------------------------
+struct esp_timer {
+    esp_timer_create_args_t args;
+    pthread_t               th;
+    pthread_mutex_t         mu;
+    pthread_cond_t          cv;
+    int64_t                 due_us;   // 0: nicht gestartet
+};
+
+static struct timespec s_t0;
+
+__attribute__((constructor))
+static void timer_clock_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_t0);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)(ts.tv_sec - s_t0.tv_sec) * 1000000 + (ts.tv_nsec - s_t0.tv_nsec) / 1000;
+}
+
+static void *timer_thread(void *arg)
+{
+    struct esp_timer *t = arg;
+    pthread_setname_np(pthread_self(), "esp_timer");
+    pthread_mutex_lock(&t->mu);
+    while (1) {
+        if (!t->due_us) {
+            pthread_cond_wait(&t->cv, &t->mu);
+            continue;
+        }
+        int64_t left = t->due_us - esp_timer_get_time();
+        if (left > 0) {
+            struct timespec dl;
+            clock_gettime(CLOCK_REALTIME, &dl);
+            int64_t ns = dl.tv_nsec + left * 1000;
+            dl.tv_sec += ns / 1000000000;
+            dl.tv_nsec = ns % 1000000000;
+            pthread_cond_timedwait(&t->cv, &t->mu, &dl);
+            continue;
+        }
+        t->due_us = 0;
+        pthread_mutex_unlock(&t->mu);
+        t->args.callback(t->args.arg);
+        pthread_mutex_lock(&t->mu);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    struct esp_timer *t = calloc(1, sizeof(*t));
+    if (!t) return ESP_ERR_NO_MEM;
+    t->args = *args;
+    pthread_mutex_init(&t->mu, NULL);
+    pthread_cond_init(&t->cv, NULL);
+    if (pthread_create(&t->th, NULL, timer_thread, t) != 0) {
+        free(t);
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_detach(t->th);
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    pthread_mutex_lock(&t->mu);
+    bool running = t->due_us != 0;
+    if (!running) {
+        t->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+        if (!t->due_us) t->due_us = 1;
+        pthread_cond_signal(&t->cv);
+    }
+    pthread_mutex_unlock(&t->mu);
+    return running ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    pthread_mutex_lock(&t->mu);
+    bool running = t->due_us != 0;
+    t->due_us = 0;
+    pthread_cond_signal(&t->cv);
+    pthread_mutex_unlock(&t->mu);
+    return running ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+// -----------------------------------------------------------------------------
+// Heap: PSRAM und interner RAM sind derselbe Host-Heap
+// -----------------------------------------------------------------------------
+void *heap_caps_malloc(size_t size, uint32_t caps)            { return malloc(size); }
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)  { return calloc(n, size); }
+void *heap_caps_realloc(void *p, size_t size, uint32_t caps)  { return realloc(p, size); }
+void  heap_caps_free(void *p)                                 { free(p); }
+
+// Feste Werte in der Größenordnung des Boards (4 MB PSRAM, ~300 kB intern)
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return caps & MALLOC_CAP_SPIRAM ? 4u << 20 : 300u << 10;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+// -----------------------------------------------------------------------------
+// Zufall und Fehlernamen
+// -----------------------------------------------------------------------------
+uint32_t esp_random(void)
+{
+    uint32_t v;
+    if (getrandom(&v, sizeof(v), 0) != sizeof(v)) v = (uint32_t)rand();
+    return v;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_NVS_NOT_FOUND:    return "ESP_ERR_NVS_NOT_FOUND";
+    default:                       return "UNKNOWN ERROR";
+    }
+}
@@ -0,0 +1,364 @@
+// freertos.c — FreeRTOS-Ersatz auf POSIX-Threads
+//
+// Jede Task ist ein Thread; Priorität und Kern werden nur gemerkt (für
+// /debug/tasks), der Host-Scheduler entscheidet. Laufzeitzähler sind die
+// CPU-Zeit des Threads in µs; die Idle-Tasks pro Kern rechnen die Zeit, in
+// der der Prozess nicht gerechnet hat, auf die zwei Kerne um.
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define HOST_MAX_TASKS    64
+#define HOST_STACK_MIN    (256 * 1024)   // ESP-Stacks sind für Host-libc zu klein
+
+struct host_task {
+    pthread_t       th;
+    clockid_t       clk;
+    char            name[16];
+    UBaseType_t     num;
+    UBaseType_t     prio;
+    BaseType_t      core;
+    uint32_t        stack;
+    TaskFunction_t  fn;
+    void           *arg;
+    bool            used;
+    bool            idle;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    uint32_t        notify;
+};
+
+static pthread_mutex_t  s_tasks_mu = PTHREAD_MUTEX_INITIALIZER;
+static struct host_task s_tasks[HOST_MAX_TASKS];
+static UBaseType_t      s_task_num;
+static __thread struct host_task *t_self;
+static struct timespec  s_boot;
+static pthread_once_t   s_once = PTHREAD_ONCE_INIT;
+
+static void host_boot(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &s_boot);
+    // Idle-Tasks pro Kern (nur Einträge, kein Thread)
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        struct host_task *t = &s_tasks[i];
+        snprintf(t->name, sizeof(t->name), "IDLE%d", i);
+        t->used = t->idle = true;
+        t->core = i;
+        t->num  = ++s_task_num;
+    }
+}
+
+static int64_t mono_us(void)
+{
+    pthread_once(&s_once, host_boot);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)(ts.tv_sec - s_boot.tv_sec) * 1000000 + (ts.tv_nsec - s_boot.tv_nsec) / 1000;
+}
+
+static struct timespec deadline(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ull;
+    ts.tv_sec += ns / 1000000000ull;
+    ts.tv_nsec = ns % 1000000000ull;
+    return ts;
+}
+
+// Wartet auf cv, bis pred erfüllt ist oder ticks ablaufen (mu gehalten)
+#define WAIT_UNTIL(pred, cv, mu, ticks) ({                                  \
+        bool _ok = true;                                                    \
+        struct timespec _dl = deadline(ticks);                              \
+        while (!(pred)) {                                                   \
+            if ((ticks) == 0) { _ok = false; break; }                       \
+            if ((ticks) == portMAX_DELAY) { pthread_cond_wait(cv, mu); continue; } \
+            if (pthread_cond_timedwait(cv, mu, &_dl) == ETIMEDOUT) {        \
+                _ok = (pred);                                               \
+                break;                                                      \
+            }                                                               \
+        }                                                                   \
+        _ok; })
+
+static struct host_task *task_alloc(const char *name)
+{
+    pthread_once(&s_once, host_boot);
+    pthread_mutex_lock(&s_tasks_mu);
+    struct host_task *t = NULL;
+    for (int i = 0; i < HOST_MAX_TASKS; i++) {
+        if (!s_tasks[i].used) {
+            t = &s_tasks[i];
+            break;
+        }
+    }
+    if (t) {
+        memset(t, 0, sizeof(*t));
+        t->used = true;
+        t->num  = ++s_task_num;
+        snprintf(t->name, sizeof(t->name), "%s", name);
+        pthread_mutex_init(&t->mu, NULL);
+        pthread_cond_init(&t->cv, NULL);
+    }
+    pthread_mutex_unlock(&s_tasks_mu);
+    return t;
+}
+
+static void task_free(struct host_task *t)
+{
+    pthread_mutex_lock(&s_tasks_mu);
+    t->used = false;
+    pthread_mutex_unlock(&s_tasks_mu);
+}
+
+// Thread ohne xTaskCreate (main, Timer, Event-Loop) bekommt beim ersten
+// Bedarf einen Eintrag
+static struct host_task *self(void)
+{
+    if (!t_self) {
+        char name[16] = "main";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        t_self = task_alloc(name);
+        if (!t_self) abort();
+        t_self->th   = pthread_self();
+        t_self->core = tskNO_AFFINITY;
+        t_self->prio = 1;
+        pthread_getcpuclockid(t_self->th, &t_self->clk);
+    }
+    return t_self;
+}
+
+static void *task_entry(void *arg)
+{
+    struct host_task *t = arg;
+    t_self = t;
+    pthread_getcpuclockid(pthread_self(), &t->clk);
+    pthread_setname_np(pthread_self(), t->name);
+    t->fn(t->arg);
+    // FreeRTOS-Tasks dürfen nicht zurückkehren
+    fprintf(stderr, "task %s returned\n", t->name);
+    abort();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack,
+                                   void *arg, UBaseType_t prio, TaskHandle_t *out,
+                                   BaseType_t core)
+{
+    struct host_task *t = task_alloc(name);
+    if (!t) return pdFAIL;
+    t->fn    = fn;
+    t->arg   = arg;
+    t->prio  = prio;
+    t->core  = core;
+    t->stack = stack;
+    if (out) *out = t;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, stack * 4 > HOST_STACK_MIN ? stack * 4 : HOST_STACK_MIN);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rc = pthread_create(&t->th, &attr, task_entry, t);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        task_free(t);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t t)
+{
+    if (t && t != t_self) {
+        fprintf(stderr, "vTaskDelete: only the calling task can be deleted on the host\n");
+        abort();
+    }
+    struct host_task *me = self();
+    t_self = NULL;
+    task_free(me);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = { ticks / 1000, (ticks % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(mono_us() / 1000);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *prev, TickType_t inc)
+{
+    TickType_t next = *prev + inc;
+    TickType_t now  = xTaskGetTickCount();
+    *prev = next;
+    if ((int32_t)(next - now) <= 0) return pdFALSE;
+    vTaskDelay(next - now);
+    return pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return self();
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core)
+{
+    pthread_once(&s_once, host_boot);
+    return core >= 0 && core < portNUM_PROCESSORS ? &s_tasks[core] : NULL;
+}
+
+void xTaskNotifyGive(TaskHandle_t t)
+{
+    pthread_mutex_lock(&t->mu);
+    t->notify++;
+    pthread_cond_signal(&t->cv);
+    pthread_mutex_unlock(&t->mu);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    struct host_task *t = self();
+    pthread_mutex_lock(&t->mu);
+    WAIT_UNTIL(t->notify > 0, &t->cv, &t->mu, ticks);
+    uint32_t n = t->notify;
+    if (n) t->notify = clear ? 0 : n - 1;
+    pthread_mutex_unlock(&t->mu);
+    return n;
+}
+
+static uint32_t cpu_us(clockid_t clk)
+{
+    struct timespec ts;
+    if (clock_gettime(clk, &ts) != 0) return 0;
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *st, UBaseType_t n,
+                                 configRUN_TIME_COUNTER_TYPE *total)
+{
+    self();
+    int64_t wall = mono_us();
+    uint32_t proc = cpu_us(CLOCK_PROCESS_CPUTIME_ID);
+    // Nicht vom Prozess genutzte Rechenzeit gleichmäßig auf die Kerne
+    int64_t idle = (wall * portNUM_PROCESSORS - proc) / portNUM_PROCESSORS;
+    if (idle < 0) idle = 0;
+
+    UBaseType_t k = 0;
+    pthread_mutex_lock(&s_tasks_mu);
+    for (int i = 0; i < HOST_MAX_TASKS && k < n; i++) {
+        struct host_task *t = &s_tasks[i];
+        if (!t->used) continue;
+        st[k] = (TaskStatus_t){
+            .xHandle              = t,
+            .pcTaskName           = t->name,
+            .xTaskNumber          = t->num,
+            .eCurrentState        = t == t_self ? eRunning : eBlocked,
+            .uxCurrentPriority    = t->prio,
+            .uxBasePriority       = t->prio,
+            .ulRunTimeCounter     = t->idle ? (uint32_t)idle : cpu_us(t->clk),
+            .usStackHighWaterMark = t->stack / 2,
+            .xCoreID              = t->core,
+        };
+        k++;
+    }
+    pthread_mutex_unlock(&s_tasks_mu);
+    if (total) *total = (uint32_t)wall;
+    return k;
+}
+
+// -----------------------------------------------------------------------------
+// Queues und Semaphoren
+// -----------------------------------------------------------------------------
+struct host_queue {
+    pthread_mutex_t mu;
+    pthread_cond_t  not_empty;
+    pthread_cond_t  not_full;
+    UBaseType_t     len, size, count, head;
+    uint8_t        *buf;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->len  = len;
+    q->size = item_size;
+    q->buf  = item_size ? calloc(len, item_size) : NULL;
+    if (item_size && !q->buf) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->mu, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (!q) return;
+    pthread_mutex_destroy(&q->mu);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->buf);
+    free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    pthread_mutex_lock(&q->mu);
+    bool ok = WAIT_UNTIL(q->count < q->len, &q->not_full, &q->mu, ticks);
+    if (ok) {
+        if (q->size) {
+            memcpy(q->buf + ((q->head + q->count) % q->len) * q->size, item, q->size);
+        }
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->mu);
+    return ok ? pdPASS : pdFAIL;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    pthread_mutex_lock(&q->mu);
+    bool ok = WAIT_UNTIL(q->count > 0, &q->not_empty, &q->mu, ticks);
+    if (ok) {
+        if (q->size) memcpy(item, q->buf + q->head * q->size, q->size);
+        q->head = (q->head + 1) % q->len;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->mu);
+    return ok ? pdPASS : pdFAIL;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->mu);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->mu);
+    return n;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xQueueCreate(1, 0);
+}
+
+// Mutex ohne Besitzer/Prioritätsvererbung: reicht für die Sperren hier
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    QueueHandle_t q = xQueueCreate(1, 0);
+    if (q) xQueueSend(q, NULL, 0);
+    return q;
+}
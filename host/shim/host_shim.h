@@ -0,0 +1,9 @@
+// host_shim.h — interne Schnittstellen zwischen den Host-Ersatzmodulen
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Registerdatei des Ersatz-Sensors (SCCB, 16-Bit-Adressen), shim/camera.c
+uint8_t host_sccb_read(uint16_t reg);
+void    host_sccb_write(uint16_t reg, uint8_t val);
+uint8_t host_sccb_addr(void);
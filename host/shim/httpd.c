@@ -0,0 +1,762 @@
+// httpd.c — esp_http_server-Ersatz auf POSIX-Sockets
+//
+// Bildet das Verhalten nach, auf das sich die Firmware verlässt: ein einziger
+// Server-Task ("httpd") nimmt Verbindungen an und ruft die Handler; ein
+// Handler, der httpd_req_async_handler_begin() ruft, gibt seine Session ab,
+// bis httpd_req_async_handler_complete() kommt, und der Server liest so lange
+// nicht von ihrem Socket. httpd_sess_trigger_close() schließt im Server-Task
+// über close_fn. Ist die Session-Tabelle voll, schließt LRU-Purge die am
+// längsten unbenutzte Session. WebSocket: Handshake, danach ruft der Server
+// den Handler pro eingehendem Frame (Kopf schon gelesen, wie in ESP-IDF).
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "freertos/task.h"
+#include "host_shim.h"
+#include "lwip/sockets.h"
+
+static const char *TAG = "host_httpd";
+
+#define SESS_BUF_LEN     2048
+#define RESP_MAX_HDRS    8
+#define SOCK_TIMEOUT_S   5
+
+typedef struct {
+    int      fd;              // -1: frei
+    bool     async;           // gehört gerade einem async-Request
+    bool     ws;              // nach dem Handshake: WebSocket-Frames
+    int      ws_uri;          // Index des WebSocket-Handlers
+    uint64_t lru;
+    char     buf[SESS_BUF_LEN];
+    size_t   buf_len;         // gelesen, noch nicht verbraucht
+} sess_t;
+
+typedef struct host_server {
+    httpd_config_t cfg;
+    int            listen_fd;
+    int            ctrl[2];          // Pipe: Session schließen / wieder lesen
+    httpd_uri_t   *uris;
+    int            nuris;
+    sess_t        *sess;
+    uint64_t       lru_counter;
+    pthread_mutex_t mu;
+} server_t;
+
+typedef struct {
+    httpd_req_t r;                   // muss vorne stehen (Cast von httpd_req_t *)
+    server_t   *srv;
+    sess_t     *sess;
+    int         fd;
+    char        head[SESS_BUF_LEN];  // Request-Kopf ab der zweiten Zeile
+    size_t      body_left;
+    bool        close_after;         // Connection: close
+    const char *status;
+    const char *type;
+    const char *hdr_k[RESP_MAX_HDRS];
+    const char *hdr_v[RESP_MAX_HDRS];
+    int         nhdrs;
+    bool        hdr_sent;            // Kopf gesendet (chunked läuft)
+    bool        done;                // Antwort vollständig
+    // WebSocket-Frame in Arbeit
+    bool        ws_hdr;
+    httpd_ws_type_t ws_type;
+    bool        ws_final;
+    size_t      ws_len;
+    uint8_t     ws_mask[4];
+    bool        ws_payload_read;
+} req_t;
+
+static uint16_t s_port_override;
+
+void host_httpd_setup(uint16_t port)
+{
+    s_port_override = port;
+}
+
+// -----------------------------------------------------------------------------
+// Socket-Hilfen
+// -----------------------------------------------------------------------------
+static int send_all(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    while (len) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Liest genau len Byte: erst aus dem Session-Puffer, dann vom Socket
+static int recv_exact(sess_t *s, void *buf, size_t len)
+{
+    uint8_t *p = buf;
+    size_t take = s->buf_len < len ? s->buf_len : len;
+    memcpy(p, s->buf, take);
+    memmove(s->buf, s->buf + take, s->buf_len - take);
+    s->buf_len -= take;
+    for (size_t got = take; got < len; ) {
+        ssize_t n = recv(s->fd, p + got, len - got, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        got += n;
+    }
+    return 0;
+}
+
+static void ctrl_post(server_t *srv, int fd)
+{
+    int32_t v = fd;
+    (void)!write(srv->ctrl[1], &v, sizeof(v));
+}
+
+// -----------------------------------------------------------------------------
+// Sessions
+// -----------------------------------------------------------------------------
+static sess_t *sess_find(server_t *srv, int fd)
+{
+    for (int i = 0; i < srv->cfg.max_open_sockets; i++) {
+        if (srv->sess[i].fd == fd) return &srv->sess[i];
+    }
+    return NULL;
+}
+
+static void sess_close(server_t *srv, sess_t *s)
+{
+    int fd = s->fd;
+    pthread_mutex_lock(&srv->mu);
+    s->fd = -1;
+    s->async = s->ws = false;
+    s->buf_len = 0;
+    pthread_mutex_unlock(&srv->mu);
+    if (srv->cfg.close_fn) srv->cfg.close_fn(srv, fd);
+    else close(fd);
+}
+
+static void sess_accept(server_t *srv)
+{
+    int fd = accept(srv->listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    sess_t *s = sess_find(srv, -1);
+    if (!s && srv->cfg.lru_purge_enable) {
+        sess_t *old = NULL;
+        for (int i = 0; i < srv->cfg.max_open_sockets; i++) {
+            if (!old || srv->sess[i].lru < old->lru) old = &srv->sess[i];
+        }
+        ESP_LOGW(TAG, "session table full, closing LRU fd %d", old->fd);
+        sess_close(srv, old);
+        s = old;
+    }
+    if (!s) {
+        ESP_LOGW(TAG, "session table full, rejecting connection");
+        close(fd);
+        return;
+    }
+    struct timeval tv = { SOCK_TIMEOUT_S, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    pthread_mutex_lock(&srv->mu);
+    s->fd      = fd;
+    s->buf_len = 0;
+    s->lru     = ++srv->lru_counter;
+    pthread_mutex_unlock(&srv->mu);
+}
+
+// -----------------------------------------------------------------------------
+// Antworten
+// -----------------------------------------------------------------------------
+static const char *err_status(httpd_err_code_t e)
+{
+    switch (e) {
+    case HTTPD_400_BAD_REQUEST:        return "400 Bad Request";
+    case HTTPD_404_NOT_FOUND:          return "404 Not Found";
+    case HTTPD_405_METHOD_NOT_ALLOWED: return "405 Method Not Allowed";
+    case HTTPD_408_REQ_TIMEOUT:        return "408 Request Timeout";
+    default:                           return "500 Internal Server Error";
+    }
+}
+
+static int send_head(req_t *q, ssize_t content_len)
+{
+    char h[1024];
+    int n = snprintf(h, sizeof(h), "HTTP/1.1 %s\r\nContent-Type: %s\r\n",
+                     q->status ? q->status : "200 OK", q->type ? q->type : "text/html");
+    if (content_len >= 0) {
+        n += snprintf(h + n, sizeof(h) - n, "Content-Length: %zd\r\n", content_len);
+    } else {
+        n += snprintf(h + n, sizeof(h) - n, "Transfer-Encoding: chunked\r\n");
+    }
+    for (int i = 0; i < q->nhdrs && n < (int)sizeof(h); i++) {
+        n += snprintf(h + n, sizeof(h) - n, "%s: %s\r\n", q->hdr_k[i], q->hdr_v[i]);
+    }
+    if (n + 3 > (int)sizeof(h)) return -1;
+    n += snprintf(h + n, sizeof(h) - n, "\r\n");
+    q->hdr_sent = true;
+    return send_all(q->fd, h, n);
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    ((req_t *)r)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    ((req_t *)r)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    req_t *q = (req_t *)r;
+    if (q->nhdrs == RESP_MAX_HDRS) return ESP_ERR_HTTPD_RESP_HDR;
+    q->hdr_k[q->nhdrs] = field;
+    q->hdr_v[q->nhdrs] = value;
+    q->nhdrs++;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t len)
+{
+    req_t *q = (req_t *)r;
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? strlen(buf) : 0;
+    q->done = true;
+    if (send_head(q, len) != 0 || (len && send_all(q->fd, buf, len) != 0)) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t len)
+{
+    req_t *q = (req_t *)r;
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? strlen(buf) : 0;
+    if (!q->hdr_sent && send_head(q, -1) != 0) return ESP_ERR_HTTPD_RESP_SEND;
+    char sz[16];
+    int n = snprintf(sz, sizeof(sz), "%zx\r\n", len);
+    if (send_all(q->fd, sz, n) != 0 ||
+        (len && send_all(q->fd, buf, len) != 0) ||
+        send_all(q->fd, "\r\n", 2) != 0) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    if (!len) q->done = true;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg)
+{
+    req_t *q = (req_t *)r;
+    q->status = err_status(error);
+    q->type   = "text/html";
+    return httpd_resp_send(r, msg ? msg : q->status, HTTPD_RESP_USE_STRLEN);
+}
+
+// -----------------------------------------------------------------------------
+// Request-Daten
+// -----------------------------------------------------------------------------
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *qs = strchr(r->uri, '?');
+    return qs ? strlen(qs + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t len)
+{
+    const char *qs = strchr(r->uri, '?');
+    if (!qs) return ESP_ERR_NOT_FOUND;
+    snprintf(buf, len, "%s", qs + 1);
+    return strlen(qs + 1) >= len ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t len)
+{
+    size_t klen = strlen(key);
+    for (const char *p = qry; p && *p; ) {
+        const char *end = strchr(p, '&');
+        if (!end) end = p + strlen(p);
+        if ((size_t)(end - p) > klen && strncmp(p, key, klen) == 0 && p[klen] == '=') {
+            const char *v = p + klen + 1;
+            size_t vlen = end - v;
+            size_t n = vlen < len ? vlen : len - 1;
+            memcpy(val, v, n);
+            val[n] = '\0';
+            return vlen < len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+        }
+        p = *end ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// Header-Zeile "field: value" im Kopf suchen; Wert ohne führende Leerzeichen
+static const char *hdr_find(const req_t *q, const char *field, size_t *vlen)
+{
+    size_t flen = strlen(field);
+    for (const char *line = q->head; *line; ) {
+        const char *eol = strstr(line, "\r\n");
+        if (!eol) eol = line + strlen(line);
+        if ((size_t)(eol - line) > flen && strncasecmp(line, field, flen) == 0 &&
+            line[flen] == ':') {
+            const char *v = line + flen + 1;
+            while (*v == ' ' || *v == '\t') v++;
+            *vlen = eol - v;
+            return v;
+        }
+        line = *eol ? eol + 2 : eol;
+    }
+    return NULL;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t len)
+{
+    size_t vlen;
+    const char *v = hdr_find((req_t *)r, field, &vlen);
+    if (!v) return ESP_ERR_NOT_FOUND;
+    size_t n = vlen < len ? vlen : len - 1;
+    memcpy(val, v, n);
+    val[n] = '\0';
+    return vlen < len ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t len)
+{
+    req_t *q = (req_t *)r;
+    if (len > q->body_left) len = q->body_left;
+    if (!len) return 0;
+    sess_t *s = q->sess;
+    ssize_t n;
+    if (s->buf_len) {
+        n = s->buf_len < len ? s->buf_len : len;
+        memcpy(buf, s->buf, n);
+        memmove(s->buf, s->buf + n, s->buf_len - n);
+        s->buf_len -= n;
+    } else {
+        n = recv(q->fd, buf, len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        }
+        if (n <= 0) return HTTPD_SOCK_ERR_FAIL;
+    }
+    q->body_left -= n;
+    return n;
+}
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return ((req_t *)r)->fd;
+}
+
+// -----------------------------------------------------------------------------
+// Async-Requests und Session-Ende
+// -----------------------------------------------------------------------------
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out)
+{
+    req_t *q = (req_t *)r;
+    req_t *copy = malloc(sizeof(*copy));
+    if (!copy) return ESP_ERR_NO_MEM;
+    memcpy(copy, q, sizeof(*copy));
+    pthread_mutex_lock(&q->srv->mu);
+    q->sess->async = true;
+    pthread_mutex_unlock(&q->srv->mu);
+    *out = &copy->r;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r)
+{
+    req_t *q = (req_t *)r;
+    server_t *srv = q->srv;
+    pthread_mutex_lock(&srv->mu);
+    if (q->sess->fd == q->fd) q->sess->async = false;
+    pthread_mutex_unlock(&srv->mu);
+    free(q);
+    ctrl_post(srv, -1);           // Server liest wieder von der Session
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd)
+{
+    server_t *srv = handle;
+    pthread_mutex_lock(&srv->mu);
+    bool known = sess_find(srv, sockfd) != NULL;
+    pthread_mutex_unlock(&srv->mu);
+    if (!known) return ESP_ERR_NOT_FOUND;
+    ctrl_post(srv, sockfd);
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+// WebSocket
+// -----------------------------------------------------------------------------
+static void sha1(const uint8_t *msg, size_t len, uint8_t out[20])
+{
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+    size_t total = ((len + 8) / 64 + 1) * 64;
+    uint8_t *m = calloc(1, total);
+    memcpy(m, msg, len);
+    m[len] = 0x80;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) m[total - 1 - i] = bits >> (8 * i);
+    for (size_t off = 0; off < total; off += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = m[off + 4 * i] << 24 | m[off + 4 * i + 1] << 16 |
+                   m[off + 4 * i + 2] << 8 | m[off + 4 * i + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = x << 1 | x >> 31;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+            uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = b << 30 | b >> 2;
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    free(m);
+    for (int i = 0; i < 20; i++) out[i] = h[i / 4] >> (24 - 8 * (i % 4));
+}
+
+static void base64(const uint8_t *in, size_t len, char *out)
+{
+    static const char tab[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = in[i] << 16 | (i + 1 < len ? in[i + 1] << 8 : 0) |
+                     (i + 2 < len ? in[i + 2] : 0);
+        out[o++] = tab[v >> 18 & 63];
+        out[o++] = tab[v >> 12 & 63];
+        out[o++] = i + 1 < len ? tab[v >> 6 & 63] : '=';
+        out[o++] = i + 2 < len ? tab[v & 63] : '=';
+    }
+    out[o] = '\0';
+}
+
+static esp_err_t ws_handshake(req_t *q)
+{
+    size_t klen;
+    const char *key = hdr_find(q, "Sec-WebSocket-Key", &klen);
+    if (!key || klen > 64) return ESP_FAIL;
+    char src[128];
+    snprintf(src, sizeof(src), "%.*s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", (int)klen, key);
+    uint8_t dig[20];
+    char acc[32], resp[256];
+    sha1((const uint8_t *)src, strlen(src), dig);
+    base64(dig, sizeof(dig), acc);
+    int n = snprintf(resp, sizeof(resp),
+                     "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                     "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n", acc);
+    return send_all(q->fd, resp, n) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+// Frame-Kopf lesen (Server, vor dem Handler)
+static esp_err_t ws_read_header(req_t *q)
+{
+    uint8_t h[2];
+    if (recv_exact(q->sess, h, 2) != 0) return ESP_FAIL;
+    q->ws_final = h[0] & 0x80;
+    q->ws_type  = h[0] & 0x0F;
+    uint64_t len = h[1] & 0x7F;
+    if (len == 126) {
+        uint8_t e[2];
+        if (recv_exact(q->sess, e, 2) != 0) return ESP_FAIL;
+        len = e[0] << 8 | e[1];
+    } else if (len == 127) {
+        uint8_t e[8];
+        if (recv_exact(q->sess, e, 8) != 0) return ESP_FAIL;
+        len = 0;
+        for (int i = 0; i < 8; i++) len = len << 8 | e[i];
+    }
+    memset(q->ws_mask, 0, sizeof(q->ws_mask));
+    if ((h[1] & 0x80) && recv_exact(q->sess, q->ws_mask, 4) != 0) return ESP_FAIL;
+    q->ws_len          = len;
+    q->ws_hdr          = true;
+    q->ws_payload_read = false;
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len)
+{
+    req_t *q = (req_t *)req;
+    if (!q->ws_hdr) return ESP_ERR_INVALID_STATE;
+    pkt->type       = q->ws_type;
+    pkt->final      = q->ws_final;
+    pkt->fragmented = !q->ws_final;
+    pkt->len        = q->ws_len;
+    if (!max_len) return ESP_OK;
+    if (q->ws_payload_read || max_len < q->ws_len) return ESP_ERR_INVALID_SIZE;
+    if (recv_exact(q->sess, pkt->payload, q->ws_len) != 0) return ESP_FAIL;
+    for (size_t i = 0; i < q->ws_len; i++) pkt->payload[i] ^= q->ws_mask[i % 4];
+    q->ws_payload_read = true;
+    return ESP_OK;
+}
+
+static esp_err_t ws_frame(server_t *srv, sess_t *s)
+{
+    req_t *q = calloc(1, sizeof(*q));
+    if (!q) return ESP_ERR_NO_MEM;
+    const httpd_uri_t *u = &srv->uris[s->ws_uri];
+    q->srv = srv;
+    q->sess = s;
+    q->fd = s->fd;
+    q->r.handle   = srv;
+    q->r.method   = 0;
+    q->r.user_ctx = u->user_ctx;
+    strncpy((char *)q->r.uri, u->uri, HTTPD_MAX_URI_LEN);
+
+    esp_err_t err = ws_read_header(q);
+    if (err == ESP_OK) {
+        bool ctrl = q->ws_type & 0x08;
+        if (ctrl && !u->handle_ws_control_frames) {
+            // Ohne handle_ws_control_frames: PING/CLOSE beantwortet der Server
+            uint8_t payload[125];
+            httpd_ws_frame_t f = { .payload = payload };
+            err = httpd_ws_recv_frame(&q->r, &f, sizeof(payload));
+            if (err == ESP_OK && q->ws_type == HTTPD_WS_TYPE_PING) {
+                uint8_t pong[2 + 125] = { 0x80 | HTTPD_WS_TYPE_PONG, (uint8_t)f.len };
+                memcpy(pong + 2, payload, f.len);
+                send_all(q->fd, pong, 2 + f.len);
+            } else if (q->ws_type == HTTPD_WS_TYPE_CLOSE) {
+                err = ESP_FAIL;
+            }
+        } else {
+            err = u->handler(&q->r);
+            // Nicht gelesene Nutzdaten verwerfen
+            if (err == ESP_OK && !q->ws_payload_read && q->ws_len) {
+                uint8_t *skip = malloc(q->ws_len);
+                err = skip && recv_exact(s, skip, q->ws_len) == 0 ? ESP_OK : ESP_FAIL;
+                free(skip);
+            }
+        }
+    }
+    free(q);
+    return err;
+}
+
+// -----------------------------------------------------------------------------
+// HTTP-Requests
+// -----------------------------------------------------------------------------
+static int method_parse(const char *m, size_t len)
+{
+    static const struct { const char *name; int m; } k[] = {
+        { "GET", HTTP_GET }, { "POST", HTTP_POST }, { "PUT", HTTP_PUT },
+        { "HEAD", HTTP_HEAD }, { "DELETE", HTTP_DELETE },
+    };
+    for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); i++) {
+        if (strlen(k[i].name) == len && memcmp(m, k[i].name, len) == 0) return k[i].m;
+    }
+    return -1;
+}
+
+// Einen Request aus dem Session-Puffer bearbeiten; ESP_FAIL schließt die Session
+static esp_err_t http_request(server_t *srv, sess_t *s)
+{
+    // Kopf bis zur Leerzeile einlesen
+    char *end;
+    while (!(end = memmem(s->buf, s->buf_len, "\r\n\r\n", 4))) {
+        if (s->buf_len == SESS_BUF_LEN) return ESP_FAIL;        // Kopf zu lang
+        ssize_t n = recv(s->fd, s->buf + s->buf_len, SESS_BUF_LEN - s->buf_len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return ESP_FAIL;
+        s->buf_len += n;
+    }
+    size_t head_len = end + 4 - s->buf;
+
+    req_t *q = calloc(1, sizeof(*q));
+    if (!q) return ESP_ERR_NO_MEM;
+    q->srv  = srv;
+    q->sess = s;
+    q->fd   = s->fd;
+    q->r.handle = srv;
+
+    // Anfragezeile: METHODE URI HTTP/1.x
+    char *line_end = memmem(s->buf, head_len, "\r\n", 2);
+    char *sp1 = memchr(s->buf, ' ', line_end - s->buf);
+    char *sp2 = sp1 ? memchr(sp1 + 1, ' ', line_end - sp1 - 1) : NULL;
+    esp_err_t err = ESP_OK;
+    if (!sp1 || !sp2 || sp2 - sp1 - 1 > HTTPD_MAX_URI_LEN) {
+        err = ESP_FAIL;
+    } else {
+        q->r.method = method_parse(s->buf, sp1 - s->buf);
+        memcpy((char *)q->r.uri, sp1 + 1, sp2 - sp1 - 1);
+        size_t hl = head_len - (line_end + 2 - s->buf);
+        memcpy(q->head, line_end + 2, hl);
+        q->head[hl] = '\0';
+    }
+    memmove(s->buf, s->buf + head_len, s->buf_len - head_len);
+    s->buf_len -= head_len;
+    if (err != ESP_OK) {
+        free(q);
+        return err;
+    }
+
+    char v[32];
+    if (httpd_req_get_hdr_value_str(&q->r, "Content-Length", v, sizeof(v)) == ESP_OK) {
+        q->r.content_len = strtoul(v, NULL, 10);
+    }
+    q->body_left   = q->r.content_len;
+    q->close_after = httpd_req_get_hdr_value_str(&q->r, "Connection", v, sizeof(v)) == ESP_OK &&
+                     strcasecmp(v, "close") == 0;
+    s->lru = ++srv->lru_counter;
+
+    // Handler suchen: Pfad ohne Query, exakt
+    size_t plen = strcspn(q->r.uri, "?");
+    const httpd_uri_t *u = NULL;
+    bool path_known = false;
+    for (int i = 0; i < srv->nuris; i++) {
+        if (strlen(srv->uris[i].uri) != plen || strncmp(srv->uris[i].uri, q->r.uri, plen)) continue;
+        path_known = true;
+        if ((int)srv->uris[i].method == q->r.method) {
+            u = &srv->uris[i];
+            break;
+        }
+    }
+    if (!u) {
+        httpd_resp_send_err(&q->r, path_known ? HTTPD_405_METHOD_NOT_ALLOWED
+                                              : HTTPD_404_NOT_FOUND, NULL);
+    } else if (u->is_websocket) {
+        q->r.user_ctx = u->user_ctx;
+        err = ws_handshake(q);
+        if (err == ESP_OK) {
+            s->ws     = true;
+            s->ws_uri = u - srv->uris;
+            err = u->handler(&q->r);
+        }
+        q->close_after = false;
+    } else {
+        q->r.user_ctx = u->user_ctx;
+        err = u->handler(&q->r);
+    }
+
+    // Session an einen async-Request abgegeben: nichts mehr anfassen
+    pthread_mutex_lock(&srv->mu);
+    bool async = s->async;
+    pthread_mutex_unlock(&srv->mu);
+    if (!async && err == ESP_OK) {
+        // Nicht gelesenen Body verwerfen, sonst steht er vor dem nächsten Request
+        char skip[256];
+        while (q->body_left) {
+            int n = httpd_req_recv(&q->r, skip, sizeof(skip));
+            if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+            if (n <= 0) {
+                err = ESP_FAIL;
+                break;
+            }
+        }
+        if (q->close_after) err = ESP_FAIL;
+    }
+    free(q);
+    return err;
+}
+
+// -----------------------------------------------------------------------------
+// Server-Task
+// -----------------------------------------------------------------------------
+static void server_task(void *arg)
+{
+    server_t *srv = arg;
+    while (1) {
+        fd_set rd;
+        FD_ZERO(&rd);
+        FD_SET(srv->listen_fd, &rd);
+        FD_SET(srv->ctrl[0], &rd);
+        int maxfd = srv->listen_fd > srv->ctrl[0] ? srv->listen_fd : srv->ctrl[0];
+        pthread_mutex_lock(&srv->mu);
+        for (int i = 0; i < srv->cfg.max_open_sockets; i++) {
+            const sess_t *s = &srv->sess[i];
+            if (s->fd < 0 || s->async) continue;
+            FD_SET(s->fd, &rd);
+            if (s->fd > maxfd) maxfd = s->fd;
+        }
+        pthread_mutex_unlock(&srv->mu);
+
+        if (select(maxfd + 1, &rd, NULL, NULL, NULL) < 0) {
+            if (errno != EINTR) ESP_LOGE(TAG, "select: errno %d", errno);
+            continue;
+        }
+        if (FD_ISSET(srv->ctrl[0], &rd)) {
+            int32_t fd;
+            if (read(srv->ctrl[0], &fd, sizeof(fd)) == sizeof(fd) && fd >= 0) {
+                sess_t *s = sess_find(srv, fd);
+                if (s) sess_close(srv, s);
+            }
+            continue;             // Session-Tabelle neu aufbauen
+        }
+        if (FD_ISSET(srv->listen_fd, &rd)) sess_accept(srv);
+
+        for (int i = 0; i < srv->cfg.max_open_sockets; i++) {
+            sess_t *s = &srv->sess[i];
+            if (s->fd < 0 || s->async || !FD_ISSET(s->fd, &rd)) continue;
+            esp_err_t err;
+            do {
+                err = s->ws ? ws_frame(srv, s) : http_request(srv, s);
+                // Pipelining: weitere vollständige Köpfe im Puffer sofort bearbeiten
+            } while (err == ESP_OK && !s->ws && !s->async && s->fd >= 0 &&
+                     memmem(s->buf, s->buf_len, "\r\n\r\n", 4));
+            if (err != ESP_OK && s->fd >= 0) {
+                pthread_mutex_lock(&srv->mu);
+                bool async = s->async;
+                pthread_mutex_unlock(&srv->mu);
+                if (!async) sess_close(srv, s);
+            }
+        }
+    }
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    server_t *srv = calloc(1, sizeof(*srv));
+    if (!srv) return ESP_ERR_NO_MEM;
+    srv->cfg  = *config;
+    srv->uris = calloc(config->max_uri_handlers, sizeof(*srv->uris));
+    srv->sess = calloc(config->max_open_sockets, sizeof(*srv->sess));
+    if (!srv->uris || !srv->sess || pipe(srv->ctrl) != 0) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < config->max_open_sockets; i++) srv->sess[i].fd = -1;
+    pthread_mutex_init(&srv->mu, NULL);
+
+    uint16_t port = s_port_override ? s_port_override : config->server_port;
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons(port),
+                             .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(srv->listen_fd, (struct sockaddr *)&a, sizeof(a)) != 0 ||
+        listen(srv->listen_fd, config->backlog_conn) != 0) {
+        ESP_LOGE(TAG, "cannot listen on port %u: errno %d", port, errno);
+        close(srv->listen_fd);
+        return ESP_ERR_HTTPD_TASK;
+    }
+    if (xTaskCreatePinnedToCore(server_task, "httpd", config->stack_size, srv,
+                                config->task_priority, NULL, config->core_id) != pdPASS) {
+        return ESP_ERR_HTTPD_TASK;
+    }
+    ESP_LOGI(TAG, "listening on port %u", port);
+    *handle = srv;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri)
+{
+    server_t *srv = handle;
+    if (srv->nuris == srv->cfg.max_uri_handlers) return ESP_ERR_HTTPD_HANDLERS_FULL;
+    srv->uris[srv->nuris++] = *uri;
+    return ESP_OK;
+}
@@ -0,0 +1,15 @@
+// gpio.h — Host-Ersatz (Pins ohne Wirkung)
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+typedef enum { GPIO_MODE_INPUT = 1, GPIO_MODE_OUTPUT = 2 } gpio_mode_t;
+typedef enum { GPIO_PULLUP_ONLY, GPIO_PULLDOWN_ONLY, GPIO_PULLUP_PULLDOWN, GPIO_FLOATING } gpio_pull_mode_t;
+
+#define GPIO_IS_VALID_GPIO(n) ((n) >= 0 && (n) < 40)
+
+esp_err_t gpio_reset_pin(gpio_num_t n);
+esp_err_t gpio_set_direction(gpio_num_t n, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t n, uint32_t level);
+esp_err_t gpio_set_pull_mode(gpio_num_t n, gpio_pull_mode_t pull);
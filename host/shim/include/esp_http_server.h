@@ -0,0 +1,139 @@
+// esp_http_server.h — Host-Ersatz: ein Server-Task wie bei ESP-IDF (ein Worker,
+// async-Requests, Session-Close, LRU-Purge, WebSocket-Handshake und Frames)
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef void *httpd_handle_t;
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET    = 1,
+    HTTP_HEAD   = 2,
+    HTTP_POST   = 3,
+    HTTP_PUT    = 4,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_405_METHOD_NOT_ALLOWED,
+    HTTPD_408_REQ_TIMEOUT,
+    HTTPD_500_INTERNAL_SERVER_ERROR,
+} httpd_err_code_t;
+
+#define HTTPD_RESP_USE_STRLEN   -1
+#define HTTPD_SOCK_ERR_FAIL     -1
+#define HTTPD_SOCK_ERR_INVALID  -2
+#define HTTPD_SOCK_ERR_TIMEOUT  -3
+#define HTTPD_MAX_REQ_HDR_LEN   1024
+#define HTTPD_MAX_URI_LEN       512
+
+typedef struct {
+    unsigned           task_priority;
+    size_t             stack_size;
+    BaseType_t         core_id;
+    uint16_t           server_port;
+    uint16_t           ctrl_port;
+    uint16_t           max_open_sockets;
+    uint16_t           max_uri_handlers;
+    uint16_t           max_resp_headers;
+    uint16_t           backlog_conn;
+    bool               lru_purge_enable;
+    uint16_t           recv_wait_timeout;
+    uint16_t           send_wait_timeout;
+    httpd_close_func_t close_fn;
+} httpd_config_t;
+
+#define HTTPD_DEFAULT_CONFIG() {            \
+        .task_priority     = 5,             \
+        .stack_size        = 4096,          \
+        .core_id           = tskNO_AFFINITY,\
+        .server_port       = 80,            \
+        .ctrl_port         = 32768,         \
+        .max_open_sockets  = 7,             \
+        .max_uri_handlers  = 8,             \
+        .max_resp_headers  = 8,             \
+        .backlog_conn      = 5,             \
+        .lru_purge_enable  = false,         \
+        .recv_wait_timeout = 5,             \
+        .send_wait_timeout = 5,             \
+        .close_fn          = NULL,          \
+}
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int            method;
+    const char     uri[HTTPD_MAX_URI_LEN + 1];
+    size_t         content_len;
+    void          *aux;
+    void          *user_ctx;
+} httpd_req_t;
+
+typedef struct httpd_uri {
+    const char    *uri;
+    httpd_method_t method;
+    esp_err_t    (*handler)(httpd_req_t *r);
+    void          *user_ctx;
+    bool           is_websocket;
+    bool           handle_ws_control_frames;
+    const char    *supported_subprotocol;
+} httpd_uri_t;
+
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT     = 0x1,
+    HTTPD_WS_TYPE_BINARY   = 0x2,
+    HTTPD_WS_TYPE_CLOSE    = 0x8,
+    HTTPD_WS_TYPE_PING     = 0x9,
+    HTTPD_WS_TYPE_PONG     = 0xA,
+} httpd_ws_type_t;
+
+typedef struct httpd_ws_frame {
+    bool            final;
+    bool            fragmented;
+    httpd_ws_type_t type;
+    uint8_t        *payload;
+    size_t          len;
+} httpd_ws_frame_t;
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri);
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t len);
+esp_err_t httpd_resp_send_err(httpd_req_t *r, httpd_err_code_t error, const char *msg);
+
+static inline esp_err_t httpd_resp_sendstr(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send(r, str, str ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+static inline esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str)
+{
+    return httpd_resp_send_chunk(r, str, str ? HTTPD_RESP_USE_STRLEN : 0);
+}
+
+size_t    httpd_req_get_url_query_len(httpd_req_t *r);
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t len);
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t len);
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t len);
+int       httpd_req_recv(httpd_req_t *r, char *buf, size_t len);
+int       httpd_req_to_sockfd(httpd_req_t *r);
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r);
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int sockfd);
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len);
+
+// Nur Host: Port statt config.server_port (80 braucht root)
+void host_httpd_setup(uint16_t port);
@@ -0,0 +1,5 @@
+// esp_random.h — Host-Ersatz
+#pragma once
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,35 @@
+// FreeRTOS.h — Host-Ersatz: FreeRTOS-API auf POSIX-Threads (1 Tick = 1 ms)
+#pragma once
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t     TickType_t;
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t      StackType_t;
+
+#define configTICK_RATE_HZ          1000
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+#define portTICK_PERIOD_MS          (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY               ((TickType_t)0xFFFFFFFF)
+#define portNUM_PROCESSORS          2
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define pdPASS                      pdTRUE
+#define pdFAIL                      pdFALSE
+#define tskNO_AFFINITY              ((BaseType_t)0x7FFFFFFF)
+#define tskIDLE_PRIORITY            0
+
+// Kritische Abschnitte: rekursive Mutexe statt Spinlocks
+typedef struct {
+    pthread_mutex_t mu;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+#define portENTER_CRITICAL(m)        pthread_mutex_lock(&(m)->mu)
+#define portEXIT_CRITICAL(m)         pthread_mutex_unlock(&(m)->mu)
+#define portENTER_CRITICAL_ISR(m)    portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_ISR(m)     portEXIT_CRITICAL(m)
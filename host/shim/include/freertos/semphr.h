@@ -0,0 +1,12 @@
+// semphr.h — Host-Ersatz: Semaphoren sind Queues ohne Nutzdaten (wie in FreeRTOS)
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+#define xSemaphoreTake(s, ticks) xQueueReceive((s), NULL, (ticks))
+#define xSemaphoreGive(s)        xQueueSend((s), NULL, 0)
+#define vSemaphoreDelete(s)      vQueueDelete(s)
@@ -0,0 +1,39 @@
+// task.h — Host-Ersatz: Tasks als Threads, Task-Notify, Laufzeitzähler
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted, eInvalid } eTaskState;
+
+typedef struct {
+    TaskHandle_t                xHandle;
+    const char                 *pcTaskName;
+    UBaseType_t                 xTaskNumber;
+    eTaskState                  eCurrentState;
+    UBaseType_t                 uxCurrentPriority;
+    UBaseType_t                 uxBasePriority;
+    configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;   // CPU-Zeit des Threads in µs
+    StackType_t                *pxStackBase;
+    uint32_t                    usStackHighWaterMark;
+    BaseType_t                  xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack,
+                                   void *arg, UBaseType_t prio, TaskHandle_t *out,
+                                   BaseType_t core);
+#define xTaskCreate(fn, name, stack, arg, prio, out) \
+    xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY)
+void         vTaskDelete(TaskHandle_t t);          // nur NULL (eigene Task)
+void         vTaskDelay(TickType_t ticks);
+BaseType_t   xTaskDelayUntil(TickType_t *prev, TickType_t inc);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TaskHandle_t xTaskGetIdleTaskHandleForCore(BaseType_t core);
+
+void       xTaskNotifyGive(TaskHandle_t t);
+uint32_t   ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *st, UBaseType_t n,
+                                 configRUN_TIME_COUNTER_TYPE *total);
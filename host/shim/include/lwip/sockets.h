@@ -0,0 +1,14 @@
+// sockets.h — Host-Ersatz: lwIP-Sockets sind die POSIX-Sockets des Hosts
+#pragma once
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define lwip_writev writev
+#define lwip_close  close
@@ -0,0 +1,2 @@
+// stats.h — Host-Ersatz: keine lwIP-Statistik (LWIP_STATS bleibt 0)
+#pragma once
@@ -0,0 +1,9 @@
+// nvs_flash.h — Host-Ersatz
+#pragma once
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+// Nur Host: NVS-Inhalt aus dieser Datei laden und bei jedem Commit schreiben
+void host_nvs_setup(const char *path);
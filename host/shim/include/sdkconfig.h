@@ -0,0 +1,8 @@
+// sdkconfig.h — Kconfig-Werte für den Host-Build
+#pragma once
+
+// WLAN-Seed passend zum simulierten AP (host_wifi_setup, Vorgabe "look-host")
+#define CONFIG_LOOK_WIFI_SSID1 "look-host"
+#define CONFIG_LOOK_WIFI_PASS1 ""
+#define CONFIG_LOOK_WIFI_SSID2 ""
+#define CONFIG_LOOK_WIFI_PASS2 ""
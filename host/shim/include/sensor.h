@@ -0,0 +1,109 @@
+// sensor.h — Host-Ersatz für esp32-camera/driver/include/sensor.h (nur das Benötigte)
+#pragma once
+#include <stdint.h>
+
+#define OV5640_PID 0x5640
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_YUV420,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+    PIXFORMAT_RGB888,
+    PIXFORMAT_RAW,
+    PIXFORMAT_RGB444,
+    PIXFORMAT_RGB555,
+} pixformat_t;
+
+typedef enum {
+    FRAMESIZE_96X96,    // 96x96
+    FRAMESIZE_QQVGA,    // 160x120
+    FRAMESIZE_128X128,  // 128x128
+    FRAMESIZE_QCIF,     // 176x144
+    FRAMESIZE_HQVGA,    // 240x176
+    FRAMESIZE_240X240,  // 240x240
+    FRAMESIZE_QVGA,     // 320x240
+    FRAMESIZE_320X320,  // 320x320
+    FRAMESIZE_CIF,      // 400x296
+    FRAMESIZE_HVGA,     // 480x320
+    FRAMESIZE_VGA,      // 640x480
+    FRAMESIZE_SVGA,     // 800x600
+    FRAMESIZE_XGA,      // 1024x768
+    FRAMESIZE_HD,       // 1280x720
+    FRAMESIZE_SXGA,     // 1280x1024
+    FRAMESIZE_UXGA,     // 1600x1200
+    FRAMESIZE_FHD,      // 1920x1080
+    FRAMESIZE_P_HD,     //  720x1280
+    FRAMESIZE_P_3MP,    //  864x1536
+    FRAMESIZE_QXGA,     // 2048x1536
+    FRAMESIZE_QHD,      // 2560x1440
+    FRAMESIZE_WQXGA,    // 2560x1600
+    FRAMESIZE_P_FHD,    // 1080x1920
+    FRAMESIZE_QSXGA,    // 2560x1920
+    FRAMESIZE_5MP,      // 2592x1944
+    FRAMESIZE_INVALID
+} framesize_t;
+
+typedef struct {
+    const uint16_t width;
+    const uint16_t height;
+    const uint8_t  aspect_ratio;
+} resolution_info_t;
+
+extern const resolution_info_t resolution[];
+
+typedef struct {
+    uint8_t  MIDH;
+    uint8_t  MIDL;
+    uint16_t PID;
+    uint8_t  VER;
+} sensor_id_t;
+
+typedef struct {
+    framesize_t framesize;
+    uint8_t scale;
+    uint8_t binning;
+    uint8_t quality;
+    int8_t  brightness;
+    int8_t  contrast;
+    int8_t  saturation;
+    int8_t  sharpness;
+    uint8_t denoise;
+    uint8_t special_effect;
+    uint8_t wb_mode;
+    uint8_t awb;
+    uint8_t awb_gain;
+    uint8_t aec;
+    uint8_t aec2;
+    int8_t  ae_level;
+    uint16_t aec_value;
+    uint8_t agc;
+    uint8_t agc_gain;
+    uint8_t gainceiling;
+    uint8_t bpc;
+    uint8_t wpc;
+    uint8_t raw_gma;
+    uint8_t lenc;
+    uint8_t hmirror;
+    uint8_t vflip;
+    uint8_t dcw;
+    uint8_t colorbar;
+} camera_status_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor {
+    sensor_id_t     id;
+    uint8_t         slv_addr;
+    pixformat_t     pixformat;
+    camera_status_t status;
+    int             xclk_freq_hz;
+
+    int (*set_framesize)(sensor_t *sensor, framesize_t framesize);
+    int (*set_quality)  (sensor_t *sensor, int quality);
+    int (*set_hmirror)  (sensor_t *sensor, int enable);
+    int (*set_vflip)    (sensor_t *sensor, int enable);
+    int (*set_colorbar) (sensor_t *sensor, int enable);
+    int (*get_reg)      (sensor_t *sensor, int reg, int mask);
+    int (*set_reg)      (sensor_t *sensor, int reg, int mask, int value);
+};
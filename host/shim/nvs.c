@@ -0,0 +1,294 @@
+// nvs.c — NVS-Ersatz: Schlüssel im Speicher, optional in einer Datei (--nvs)
+//
+// Dateiformat: pro Eintrag Namespace, Schlüssel (je 16 Byte), Typ (1 Byte),
+// Länge (u32) und Daten. Geschrieben wird bei jedem nvs_commit().
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+static const char *TAG = "nvs";
+
+#define NVS_KEY_LEN     16
+#define NVS_MAX_ENTRIES 128
+#define NVS_MAX_HANDLES 16
+
+enum { T_U8 = 1, T_U32 = 4, T_STR = 0x21, T_BLOB = 0x42 };
+
+typedef struct {
+    char     ns[NVS_KEY_LEN];
+    char     key[NVS_KEY_LEN];
+    uint8_t  type;
+    uint32_t len;
+    uint8_t *data;
+} nvs_ent_t;
+
+typedef struct {
+    bool            used;
+    char            ns[NVS_KEY_LEN];
+    nvs_open_mode_t mode;
+} nvs_hnd_t;
+
+static pthread_mutex_t s_mu = PTHREAD_MUTEX_INITIALIZER;
+static nvs_ent_t       s_ent[NVS_MAX_ENTRIES];
+static nvs_hnd_t       s_hnd[NVS_MAX_HANDLES];
+static const char     *s_path;
+static bool            s_ready;
+
+void host_nvs_setup(const char *path)
+{
+    s_path = path;
+}
+
+static void store_load(void)
+{
+    FILE *f = s_path ? fopen(s_path, "rb") : NULL;
+    if (!f) return;
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        nvs_ent_t *e = &s_ent[i];
+        if (fread(e->ns, NVS_KEY_LEN, 1, f) != 1 || fread(e->key, NVS_KEY_LEN, 1, f) != 1 ||
+            fread(&e->type, 1, 1, f) != 1 || fread(&e->len, 4, 1, f) != 1) {
+            memset(e, 0, sizeof(*e));
+            break;
+        }
+        e->data = malloc(e->len ? e->len : 1);
+        if (!e->data || fread(e->data, 1, e->len, f) != e->len) {
+            free(e->data);
+            memset(e, 0, sizeof(*e));
+            break;
+        }
+    }
+    fclose(f);
+    ESP_LOGI(TAG, "loaded %s", s_path);
+}
+
+static void store_save(void)
+{
+    if (!s_path) return;
+    FILE *f = fopen(s_path, "wb");
+    if (!f) {
+        ESP_LOGW(TAG, "cannot write %s", s_path);
+        return;
+    }
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        const nvs_ent_t *e = &s_ent[i];
+        if (!e->type) continue;
+        fwrite(e->ns, NVS_KEY_LEN, 1, f);
+        fwrite(e->key, NVS_KEY_LEN, 1, f);
+        fwrite(&e->type, 1, 1, f);
+        fwrite(&e->len, 4, 1, f);
+        fwrite(e->data, 1, e->len, f);
+    }
+    fclose(f);
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    pthread_mutex_lock(&s_mu);
+    if (!s_ready) {
+        store_load();
+        s_ready = true;
+    }
+    pthread_mutex_unlock(&s_mu);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&s_mu);
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        free(s_ent[i].data);
+        memset(&s_ent[i], 0, sizeof(s_ent[i]));
+    }
+    store_save();
+    pthread_mutex_unlock(&s_mu);
+    return ESP_OK;
+}
+
+static bool ns_exists(const char *ns)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (s_ent[i].type && strcmp(s_ent[i].ns, ns) == 0) return true;
+    }
+    return false;
+}
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t mode, nvs_handle_t *out)
+{
+    if (!ns || strlen(ns) >= NVS_KEY_LEN) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = ESP_ERR_NO_MEM;
+    pthread_mutex_lock(&s_mu);
+    if (!s_ready) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (mode == NVS_READONLY && !ns_exists(ns)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+            if (s_hnd[i].used) continue;
+            s_hnd[i].used = true;
+            s_hnd[i].mode = mode;
+            strcpy(s_hnd[i].ns, ns);
+            *out = i + 1;
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_mu);
+    return err;
+}
+
+void nvs_close(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_mu);
+    if (h >= 1 && h <= NVS_MAX_HANDLES) s_hnd[h - 1].used = false;
+    pthread_mutex_unlock(&s_mu);
+}
+
+esp_err_t nvs_commit(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_mu);
+    store_save();
+    pthread_mutex_unlock(&s_mu);
+    return ESP_OK;
+}
+
+// Aufrufer hält s_mu
+static nvs_hnd_t *hnd(nvs_handle_t h)
+{
+    return h >= 1 && h <= NVS_MAX_HANDLES && s_hnd[h - 1].used ? &s_hnd[h - 1] : NULL;
+}
+
+static nvs_ent_t *find(const char *ns, const char *key)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        nvs_ent_t *e = &s_ent[i];
+        if (e->type && strcmp(e->ns, ns) == 0 && strcmp(e->key, key) == 0) return e;
+    }
+    return NULL;
+}
+
+static esp_err_t set(nvs_handle_t h, const char *key, uint8_t type, const void *val, size_t len)
+{
+    if (!key || strlen(key) >= NVS_KEY_LEN) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&s_mu);
+    nvs_hnd_t *hd = hnd(h);
+    nvs_ent_t *e  = hd ? find(hd->ns, key) : NULL;
+    if (!hd || hd->mode != NVS_READWRITE) {
+        err = ESP_ERR_INVALID_ARG;
+    } else {
+        for (int i = 0; !e && i < NVS_MAX_ENTRIES; i++) {
+            if (!s_ent[i].type) e = &s_ent[i];
+        }
+        uint8_t *data = e ? malloc(len ? len : 1) : NULL;
+        if (!data) {
+            err = ESP_ERR_NVS_NO_FREE_PAGES;
+        } else {
+            memcpy(data, val, len);
+            free(e->data);
+            strcpy(e->ns, hd->ns);
+            strcpy(e->key, key);
+            e->type = type;
+            e->len  = len;
+            e->data = data;
+        }
+    }
+    pthread_mutex_unlock(&s_mu);
+    return err;
+}
+
+// *len: Puffergröße rein, gespeicherte Länge raus; out NULL fragt nur die Länge ab
+static esp_err_t get(nvs_handle_t h, const char *key, uint8_t type, void *out, size_t *len)
+{
+    esp_err_t err = ESP_OK;
+    pthread_mutex_lock(&s_mu);
+    nvs_hnd_t *hd = hnd(h);
+    nvs_ent_t *e  = hd ? find(hd->ns, key) : NULL;
+    if (!hd) {
+        err = ESP_ERR_INVALID_ARG;
+    } else if (!e || e->type != type) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out && *len < e->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        if (out) memcpy(out, e->data, e->len);
+        *len = e->len;
+    }
+    pthread_mutex_unlock(&s_mu);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t h, const char *key)
+{
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+    pthread_mutex_lock(&s_mu);
+    nvs_hnd_t *hd = hnd(h);
+    nvs_ent_t *e  = hd ? find(hd->ns, key) : NULL;
+    if (e) {
+        free(e->data);
+        memset(e, 0, sizeof(*e));
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_mu);
+    return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t h)
+{
+    pthread_mutex_lock(&s_mu);
+    nvs_hnd_t *hd = hnd(h);
+    for (int i = 0; hd && i < NVS_MAX_ENTRIES; i++) {
+        if (s_ent[i].type && strcmp(s_ent[i].ns, hd->ns) == 0) {
+            free(s_ent[i].data);
+            memset(&s_ent[i], 0, sizeof(s_ent[i]));
+        }
+    }
+    pthread_mutex_unlock(&s_mu);
+    return hd ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *key, const void *val, size_t len)
+{
+    return set(h, key, T_BLOB, val, len);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *key, void *out, size_t *len)
+{
+    return get(h, key, T_BLOB, out, len);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t h, const char *key, const char *val)
+{
+    return set(h, key, T_STR, val, strlen(val) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t h, const char *key, char *out, size_t *len)
+{
+    return get(h, key, T_STR, out, len);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t h, const char *key, uint8_t val)
+{
+    return set(h, key, T_U8, &val, sizeof(val));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t h, const char *key, uint8_t *out)
+{
+    size_t len = sizeof(*out);
+    return get(h, key, T_U8, out, &len);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t h, const char *key, uint32_t val)
+{
+    return set(h, key, T_U32, &val, sizeof(val));
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t h, const char *key, uint32_t *out)
+{
+    size_t len = sizeof(*out);
+    return get(h, key, T_U32, out, &len);
+}
@@ -0,0 +1,256 @@
+// wifi.c — esp_wifi/esp_event/esp_netif-Ersatz: ein simulierter AP
+//
+// Der Scan findet genau einen AP (--ssid, Kanal 6+10, −50 dBm, WPA2). Verbinden
+// mit dieser SSID meldet STA_CONNECTED und GOT_IP 127.0.0.1, jede andere
+// SSID DISCONNECTED mit NO_AP_FOUND. Events laufen wie in ESP-IDF über einen
+// eigenen Event-Task, nie im Aufrufer.
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+static const char *TAG = "host_wifi";
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT   = "IP_EVENT";
+
+#define EVT_MAX_HANDLERS  16
+#define EVT_QUEUE_LEN     16
+#define EVT_DATA_MAX      64
+
+#define SIM_CHANNEL       6
+#define SIM_RSSI          -50
+
+typedef struct {
+    esp_event_base_t    base;
+    int32_t             id;
+    esp_event_handler_t fn;
+    void               *arg;
+} evt_handler_t;
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t          id;
+    size_t           size;
+    uint8_t          data[EVT_DATA_MAX];
+} evt_msg_t;
+
+static pthread_mutex_t  s_mu = PTHREAD_MUTEX_INITIALIZER;
+static evt_handler_t    s_handlers[EVT_MAX_HANDLERS];
+static int              s_nhandlers;
+static QueueHandle_t    s_evt_q;
+
+static const char      *s_sim_ssid;
+static const uint8_t    k_sim_bssid[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static wifi_config_t    s_cfg;
+static bool             s_connected;
+static bool             s_scan_done;
+static wifi_ps_type_t   s_ps = WIFI_PS_MIN_MODEM;
+static wifi_bandwidth_t s_bw = WIFI_BW_HT20;
+static wifi_bandwidth_t s_bw_cfg = WIFI_BW_HT20;
+static int8_t           s_tx_power = 80;        // 0.25 dBm
+
+void host_wifi_setup(const char *ssid)
+{
+    s_sim_ssid = ssid;
+}
+
+// -----------------------------------------------------------------------------
+// Event-Loop
+// -----------------------------------------------------------------------------
+static void event_task(void *arg)
+{
+    evt_msg_t m;
+    while (1) {
+        if (xQueueReceive(s_evt_q, &m, portMAX_DELAY) != pdTRUE) continue;
+        evt_handler_t hs[EVT_MAX_HANDLERS];
+        pthread_mutex_lock(&s_mu);
+        int n = s_nhandlers;
+        memcpy(hs, s_handlers, sizeof(hs));
+        pthread_mutex_unlock(&s_mu);
+        for (int i = 0; i < n; i++) {
+            if (hs[i].base == m.base && (hs[i].id == m.id || hs[i].id == ESP_EVENT_ANY_ID)) {
+                hs[i].fn(hs[i].arg, m.base, m.id, m.size ? m.data : NULL);
+            }
+        }
+    }
+}
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    if (s_evt_q) return ESP_ERR_INVALID_STATE;
+    s_evt_q = xQueueCreate(EVT_QUEUE_LEN, sizeof(evt_msg_t));
+    if (!s_evt_q) return ESP_ERR_NO_MEM;
+    return xTaskCreate(event_task, "sys_evt", 4096, NULL, 20, NULL) == pdPASS
+           ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id,
+                                              esp_event_handler_t handler, void *arg,
+                                              esp_event_handler_instance_t *instance)
+{
+    esp_err_t err = ESP_ERR_NO_MEM;
+    pthread_mutex_lock(&s_mu);
+    if (s_nhandlers < EVT_MAX_HANDLERS) {
+        s_handlers[s_nhandlers++] = (evt_handler_t){ base, id, handler, arg };
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_mu);
+    return err;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data,
+                         size_t size, TickType_t ticks)
+{
+    if (!s_evt_q) return ESP_ERR_INVALID_STATE;
+    if (size > EVT_DATA_MAX) return ESP_ERR_INVALID_ARG;
+    evt_msg_t m = { .base = base, .id = id, .size = size };
+    if (size) memcpy(m.data, data, size);
+    return xQueueSend(s_evt_q, &m, ticks) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// -----------------------------------------------------------------------------
+// Netif
+// -----------------------------------------------------------------------------
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    static int dummy;
+    return (esp_netif_t *)&dummy;
+}
+
+// -----------------------------------------------------------------------------
+// Wi-Fi
+// -----------------------------------------------------------------------------
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)  { return ESP_OK; }
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage)     { return ESP_OK; }
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)              { return ESP_OK; }
+
+esp_err_t esp_wifi_start(void)
+{
+    if (!s_sim_ssid) s_sim_ssid = "look-host";
+    ESP_LOGI(TAG, "simulated AP \"%s\" on channel %d", s_sim_ssid, SIM_CHANNEL);
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t iface, wifi_config_t *conf)
+{
+    s_cfg = *conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    const char *ssid = (const char *)s_cfg.sta.ssid;
+    bool match = strncmp(ssid, s_sim_ssid, sizeof(s_cfg.sta.ssid)) == 0 &&
+                 (!s_cfg.sta.bssid_set || memcmp(s_cfg.sta.bssid, k_sim_bssid, 6) == 0);
+    if (!match) {
+        wifi_event_sta_disconnected_t d = { .reason = WIFI_REASON_NO_AP_FOUND, .rssi = -127 };
+        d.ssid_len = strnlen(ssid, sizeof(d.ssid));
+        memcpy(d.ssid, ssid, d.ssid_len);
+        return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &d, sizeof(d),
+                              portMAX_DELAY);
+    }
+    // Bandbreite gilt wie beim echten Treiber ab der Assoziation
+    s_bw = s_bw_cfg;
+    s_connected = true;
+    wifi_event_sta_connected_t c = { .channel = SIM_CHANNEL, .authmode = WIFI_AUTH_WPA2_PSK };
+    c.ssid_len = strlen(s_sim_ssid) < sizeof(c.ssid) ? strlen(s_sim_ssid) : sizeof(c.ssid);
+    memcpy(c.ssid, s_sim_ssid, c.ssid_len);
+    memcpy(c.bssid, k_sim_bssid, 6);
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &c, sizeof(c), portMAX_DELAY);
+
+    ip_event_got_ip_t ip = { 0 };
+    uint8_t *a = (uint8_t *)&ip.ip_info.ip.addr, *m = (uint8_t *)&ip.ip_info.netmask.addr;
+    a[0] = 127;                                   // 127.0.0.1/8, Netzwerk-Byte-Reihenfolge
+    a[3] = 1;
+    m[0] = 255;
+    return esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &ip, sizeof(ip), portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    if (!s_connected) return ESP_ERR_WIFI_NOT_CONNECT;
+    s_connected = false;
+    wifi_event_sta_disconnected_t d = { .reason = 8 /* ASSOC_LEAVE */, .rssi = SIM_RSSI };
+    d.ssid_len = strlen(s_sim_ssid) < sizeof(d.ssid) ? strlen(s_sim_ssid) : sizeof(d.ssid);
+    memcpy(d.ssid, s_sim_ssid, d.ssid_len);
+    memcpy(d.bssid, k_sim_bssid, 6);
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &d, sizeof(d), portMAX_DELAY);
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+    s_scan_done = !config || !config->channel || config->channel == SIM_CHANNEL;
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_SCAN_DONE, NULL, 0, portMAX_DELAY);
+}
+
+static void ap_record(wifi_ap_record_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    memcpy(r->bssid, k_sim_bssid, 6);
+    strncpy((char *)r->ssid, s_sim_ssid, sizeof(r->ssid) - 1);
+    r->primary  = SIM_CHANNEL;
+    r->second   = WIFI_SECOND_CHAN_ABOVE;          // HT40-fähiger AP
+    r->rssi     = SIM_RSSI;
+    r->authmode = WIFI_AUTH_WPA2_PSK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records)
+{
+    if (*number && s_scan_done) {
+        ap_record(&ap_records[0]);
+        *number = 1;
+    } else {
+        *number = 0;
+    }
+    s_scan_done = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (!s_connected) return ESP_ERR_WIFI_NOT_CONNECT;
+    ap_record(ap_info);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+    s_ps = type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t iface, wifi_bandwidth_t bw)
+{
+    s_bw_cfg = bw;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t iface, wifi_bandwidth_t *bw)
+{
+    *bw = s_connected ? s_bw : s_bw_cfg;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_max_tx_power(int8_t power)
+{
+    s_tx_power = power;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_max_tx_power(int8_t *power)
+{
+    *power = s_tx_power;
+    return ESP_OK;
+}
@@ -0,0 +1,177 @@
+// test_motion.c — Bewegungserkennung gegen aufgezeichnete JPEGs (host/test/frames)
+//
+// Bindet main/motion.c direkt ein und füttert process_frame() ohne Task und
+// Frame-Ring. Die Fixtures erzeugt tools/gen_frames.py: ruhige Szene,
+// wandernder heller Block in der Bildmitte, Belichtungssprung, dazu XGA.
+#include "../../main/motion.c"
+
+#include <stdarg.h>
+
+static int s_failed;
+
+#define CHECK(cond, ...) do {                                        \
+        if (!(cond)) {                                               \
+            printf("FAIL %s:%d: %s — ", __FILE__, __LINE__, #cond);  \
+            printf(__VA_ARGS__);                                     \
+            printf("\n");                                            \
+            s_failed++;                                              \
+        }                                                            \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// Hilfen
+// ---------------------------------------------------------------------------
+static void feed(const char *fmt, ...)
+{
+    char path[512], name[128];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(name, sizeof(name), fmt, ap);
+    va_end(ap);
+    snprintf(path, sizeof(path), "%s/%s", FRAMES_DIR, name);
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("FAIL missing fixture %s (tools/gen_frames.py host/test/frames)\n", path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc(len);
+    if (!buf || fread(buf, 1, len, f) != (size_t)len) {
+        printf("FAIL cannot read %s\n", path);
+        exit(1);
+    }
+    fclose(f);
+
+    frame_t fr = { .buf = buf, .len = len };
+    process_frame(&fr);
+    free(buf);
+}
+
+// Zustand wie nach dem Öffnen eines neuen Readers
+static void reset(int hold)
+{
+    s_bg_valid = false;
+    s_quiet    = 0;
+    s_gw = s_gh = 0;
+    s_status = (motion_status_t){ .enabled = true };
+    s_params.hold_frames = hold;
+    motion_roi_clear();
+}
+
+// Geänderte Zellen nur in den Zeilen des Blocks (Bildmitte ± eine Zelle)?
+static bool map_in_block_rows(int *hits)
+{
+    // Block aus gen_frames.py: Kante w/8, vertikal zentriert
+    int gw = s_status.grid_w, gh = s_status.grid_h, cell = s_status.cell_px;
+    int w = s_dec.info.width, h = s_dec.info.height;
+    int y0 = (h / 2 - w / 16) / cell - 1, y1 = (h / 2 + w / 16) / cell + 1;
+    bool ok = true;
+    *hits = 0;
+    for (int y = 0; y < gh; y++) {
+        for (int x = 0; x < gw; x++) {
+            if (!s_map[y * gw + x]) continue;
+            (*hits)++;
+            if (y < y0 || y > y1) ok = false;
+        }
+    }
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Fälle
+// ---------------------------------------------------------------------------
+static void test_still(void)
+{
+    reset(3);
+    for (int i = 0; i < 4; i++) feed("still_640x480_%02d.jpg", i);
+    CHECK(s_status.grid_w == 40 && s_status.grid_h == 30, "grid %dx%d",
+          s_status.grid_w, s_status.grid_h);
+    CHECK(s_status.cell_px == 16, "cell_px %d", s_status.cell_px);
+    CHECK(!s_status.motion && s_status.events == 0, "motion %d events %lu",
+          s_status.motion, (unsigned long)s_status.events);
+    CHECK(s_status.changed == 0, "changed %d", s_status.changed);
+}
+
+static void test_aec(void)
+{
+    // Ganze Szene heller: globaler Offset wird herausgerechnet
+    reset(3);
+    feed("still_640x480_00.jpg");
+    feed("aec_640x480_00.jpg");
+    CHECK(s_status.changed < s_params.min_cells, "changed %d", s_status.changed);
+    CHECK(!s_status.motion, "motion on exposure step");
+}
+
+static void test_moving(void)
+{
+    reset(3);
+    feed("still_640x480_00.jpg");
+    int hits = 0;
+    for (int i = 0; i < 5; i++) {
+        feed("moving_640x480_%02d.jpg", i);
+        CHECK(s_status.changed >= s_params.min_cells, "frame %d: changed %d", i,
+              s_status.changed);
+        CHECK(map_in_block_rows(&hits), "frame %d: changed cells outside block rows", i);
+    }
+    CHECK(s_status.motion && s_status.events == 1, "motion %d events %lu",
+          s_status.motion, (unsigned long)s_status.events);
+    CHECK(s_status.last_motion_us > 0, "last_motion_us unset");
+
+    // Zurück zur ruhigen Szene: Bewegung hält hold_frames ruhige Frames, dann Ende
+    int quiet = 0, frames = 0;
+    while (s_status.motion && frames < 40) {
+        feed("still_640x480_%02d.jpg", frames % 4);
+        frames++;
+        quiet = s_status.changed < s_params.min_cells ? quiet + 1 : 0;
+        if (s_status.motion) {
+            CHECK(quiet < s_params.hold_frames, "still on after %d quiet frames", quiet);
+        }
+    }
+    CHECK(!s_status.motion, "motion did not end after %d frames", frames);
+    CHECK(quiet == s_params.hold_frames, "ended after %d quiet frames", quiet);
+    CHECK(s_status.events == 1, "events %lu", (unsigned long)s_status.events);
+}
+
+static void test_roi(void)
+{
+    // Oberes Drittel: der Block in der Bildmitte liegt außerhalb
+    reset(3);
+    CHECK(motion_roi_add(0, 0, 100, 33) == ESP_OK, "roi_add");
+    feed("still_640x480_00.jpg");
+    for (int i = 0; i < 5; i++) feed("moving_640x480_%02d.jpg", i);
+    CHECK(!s_status.motion && s_status.events == 0, "motion %d events %lu",
+          s_status.motion, (unsigned long)s_status.events);
+    int hits = 0;
+    map_in_block_rows(&hits);
+    CHECK(hits == 0, "%d cells outside ROI", hits);
+}
+
+static void test_xga(void)
+{
+    // Über SVGA: größere Zellen statt "outside motion grid"
+    reset(3);
+    feed("still_1024x768_00.jpg");
+    CHECK(s_status.frames == 1, "XGA frame skipped");
+    CHECK(s_status.grid_w <= MOTION_GRID_MAX_W && s_status.grid_h <= MOTION_GRID_MAX_H,
+          "grid %dx%d", s_status.grid_w, s_status.grid_h);
+    CHECK(s_status.cell_px == 24, "cell_px %d", s_status.cell_px);
+    for (int i = 0; i < 2; i++) feed("moving_1024x768_%02d.jpg", i);
+    int hits = 0;
+    CHECK(map_in_block_rows(&hits) && hits > 0, "%d hits", hits);
+    CHECK(s_status.motion, "no motion at XGA");
+}
+
+int main(void)
+{
+    s_lock = xSemaphoreCreateMutex();
+    test_still();
+    test_aec();
+    test_moving();
+    test_roi();
+    test_xga();
+    printf("%s\n", s_failed ? "FAILED" : "OK");
+    return s_failed ? 1 : 0;
+}
@@ -1,19 +1,90 @@
 #include "camera.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
 #include "esp_log.h"
 #include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
 #include "camera_pins.h"
-#include "driver/i2c.h"
+#include "ov5640_regs.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/ledc.h"
 #include "driver/gpio.h"
 #include "esp_http_server.h"
+#include "http_server.h"
+#include "lwip/sockets.h"
+#include "frame_ring.h"
+#include "jpeg_scan.h"
+#include "jpeg_thumb.h"
+#include "nvs.h"
+#include "rate_ctrl.h"
+#include "task_prof.h"
+#include "clip_store.h"
+#include "metrics.h"
+#include "ov5640_ae.h"
+#include "ov5640_af.h"
+#include "ov5640_seq.h"
+#include "wifi.h"
 
 static const char *TAG = "camera";
 
+#define CAPTURE_IDLE_MS      50      // Pause, solange kein Client liest
+#define STREAM_FRAME_TIMEOUT_MS 5000 // kein neuer Frame → Stream beenden
+#define STREAM_SNDBUF        (32 * 1024)  // gewünschter TCP-Sendepuffer (falls lwIP SO_SNDBUF kann)
+#define STREAM_PART_HDR_MAX  256     // Part-Header mit Sequenz- und Zeitangaben
+#define SNAP_QUEUE_LEN       8       // wartende Snapshot-Anfragen
+#define SNAP_MAXAGE_MAX_MS   60000
+#define MODE_SWITCH_MAX_FRAMES  6    // max. verworfene Frames nach Moduswechsel
+#define SNAP_AF_TIMEOUT_MS   1500    // Einzelfokus, wenn der Dauer-AF nicht steht
+#define BURST_MAX_FRAMES     30
+#define BURST_MAX_INTERVAL_MS 5000
+#define BURST_QUEUE_LEN      2       // kopierte Frames zwischen Aufnahme und Versand
+#define BURST_PART_BOUNDARY  "burstframe"
+#define BURST_QUEUE_WAIT_MS  1000    // so lange darf ein langsamer Client die Aufnahme (s_cam_lock) halten
+#define BURST_TS_SLACK_US    5000    // Frames so weit vor dem Termin gelten noch als pünktlich
+#define BURST_MAX_STALE      3       // ältere Frames (aus der Treiber-Queue) höchstens verwerfen
+#define THUMB_QUALITY        60      // IJG-Qualität der verkleinerten Frames
+#define THUMB_MAX_AGE_MS     500     // älterer Frame im Ring → auf den nächsten warten
+#define CTRL_NVS_NS          "camctrl"
+#define CTRL_Q_MIN           4       // beste JPEG-Qualität, die der Treiber annimmt
+#define CTRL_Q_MAX           63
+#define CTRL_KBPS_MAX        50000   // über dem, was das WLAN trägt
+#define CTRL_SETTLE_FRAMES   2       // nach Spiegeln/Testbild verworfene Frames
+#define CTRL_BODY_MAX        256
+
+// Framebuffer-Pipeline: 2–3 Puffer im PSRAM, Treiber liefert immer den neuesten
+#define CAMERA_FB_COUNT      2
+#define STREAM_DEFAULT_FPS   15
+#define STREAM_MAX_FPS       30
+#define PACING_WINDOW_US     1000000LL         // Messfenster für Sendezeiten
+#define PACING_STATS_US      (10 * 1000000LL)  // Pacing-Statistik alle 10 s loggen
+
 // Zwei globale Config-Strukturen
 static camera_config_t stream_cfg;
 static camera_config_t snap_cfg;
 
+// Schützt den Kameratreiber: Capture-Task vs. Snapshot-Moduswechsel
+static SemaphoreHandle_t s_cam_lock;
+
+// Frame-Pacing: Ziel-FPS und Messwerte der Clients
+static volatile int  s_target_fps  = STREAM_DEFAULT_FPS;
+static int64_t       s_send_min_us = INT64_MAX;   // schnellster Send im Fenster
+static portMUX_TYPE  s_pace_mux    = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_err_t snapshot_start(void);
+
+// Laufzeit-Einstellungen: HTTP schreibt, der Capture-Task übernimmt
+static portMUX_TYPE  s_ctrl_mux = portMUX_INITIALIZER_UNLOCKED;
+static camera_ctrl_t s_ctrl;           // angefordert (= gespeichert)
+static volatile bool s_ctrl_dirty;     // Capture-Task übernimmt vor dem nächsten Frame
+static framesize_t   s_fb_max_size;    // Framebuffer beim Start dafür angelegt
+
 // XCLK (20 MHz) konfigurieren
 static void init_xclk(void)
 {
@@ -74,18 +145,21 @@ static void prepare_configs(void)
         .ledc_timer     = LEDC_TIMER_0,
         .ledc_channel   = LEDC_CHANNEL_0,
         .xclk_freq_hz   = 20000000,
-        .sccb_i2c_port  = I2C_NUM_1,
+        .sccb_i2c_port  = SCCB_I2C_PORT,
     };
 
-    // Streaming-Konfiguration: VGA, 30% JPEG, 1 Framebuffer
+    // Streaming-Konfiguration: VGA, 30% JPEG, CAMERA_FB_COUNT Framebuffer
     stream_cfg = base;
     stream_cfg.pixel_format = PIXFORMAT_JPEG;
     stream_cfg.frame_size   = FRAMESIZE_VGA;
     stream_cfg.jpeg_quality = 30;
-    stream_cfg.fb_count     = 1;
-    stream_cfg.grab_mode    = CAMERA_GRAB_WHEN_EMPTY;
+    stream_cfg.fb_count     = CAMERA_FB_COUNT;
+    stream_cfg.fb_location  = CAMERA_FB_IN_PSRAM;
+    stream_cfg.grab_mode    = CAMERA_FB_COUNT > 1 ? CAMERA_GRAB_LATEST
+                                                  : CAMERA_GRAB_WHEN_EMPTY;
 
     // Snapshot-Konfiguration: 5 MP, 10% JPEG, 1 Framebuffer
+    // (zur Laufzeit zählen nur frame_size und jpeg_quality, siehe switch_mode)
     snap_cfg = base;
     snap_cfg.pixel_format = PIXFORMAT_JPEG;
     snap_cfg.frame_size   = FRAMESIZE_UXGA;
@@ -94,6 +168,469 @@ static void prepare_configs(void)
     snap_cfg.grab_mode    = CAMERA_GRAB_WHEN_EMPTY;
 }
 
+// ---------------------------------------------------------------------------
+// ROI / Digitalzoom
+//
+// Statt das VGA-Bild zu beschneiden, wird das Sensorfenster (X_ADDR_*) auf den
+// Ausschnitt gelegt und ohne Binning ausgelesen; der ISP-Scaler bringt ihn auf
+// die Stream-Auflösung. Ein 640x480-Fenster kommt so 1:1 aus dem Pixelfeld
+// (4x Zoom) bei unveränderter JPEG-Größe. Geschrieben wird per Group-Hold:
+// der Sensor übernimmt alle Fensterregister gemeinsam am nächsten Frame-Beginn.
+// ---------------------------------------------------------------------------
+#define OV5640_FIELD_W       2560    // Pixelfeld (4:3-Zeile der ratio_table im Treiber)
+#define OV5640_FIELD_H       1920
+#define OV5640_ISP_OFF_X     32      // Randpixel für das ISP-Fenster
+#define OV5640_ISP_OFF_Y     16
+#define OV5640_HTS_FULL      2844    // Zeilenlänge ohne Binning
+#define OV5640_VTS_PAD       48      // Zeilen über der Fensterhöhe (Rand + Austastung)
+#define ROI_GROUP            0x03    // Group-Hold-Puffer für die Fensterregister
+
+static portMUX_TYPE  s_roi_mux = portMUX_INITIALIZER_UNLOCKED;
+static camera_roi_t  s_roi;            // angeforderter Ausschnitt, w == 0: Vollbild
+static volatile bool s_roi_dirty;      // Capture-Task übernimmt vor dem nächsten Frame
+
+// Ausschnitt r für die Stream-Auflösung von cfg programmieren (hält s_cam_lock).
+// Das Fenster wird um seine Mitte auf das Seitenverhältnis der Ausgabe
+// erweitert und nie kleiner als die Ausgabe (mehr Zoom wäre nur Hochskalieren).
+static esp_err_t roi_program(sensor_t *s, const camera_config_t *cfg, const camera_roi_t *r)
+{
+    if (r->w <= 0 || r->h <= 0) {
+        // Vollbild: Treibereinstellung der Auflösung (mit Binning) zurück
+        return s->set_framesize(s, cfg->frame_size) == 0 ? ESP_OK : ESP_FAIL;
+    }
+    const int out_w = resolution[cfg->frame_size].width;
+    const int out_h = resolution[cfg->frame_size].height;
+    int cx = (r->x * 2 + r->w) * OV5640_FIELD_W / 200;
+    int cy = (r->y * 2 + r->h) * OV5640_FIELD_H / 200;
+    int w  = r->w * OV5640_FIELD_W / 100;
+    int h  = r->h * OV5640_FIELD_H / 100;
+
+    if (w * out_h < h * out_w) w = h * out_w / out_h;
+    else                       h = w * out_h / out_w;
+    if (w < out_w) { w = out_w; h = out_h; }
+    if (w > OV5640_FIELD_W) { w = OV5640_FIELD_W; h = w * out_h / out_w; }
+    if (h > OV5640_FIELD_H) { h = OV5640_FIELD_H; w = h * out_w / out_h; }
+    w &= ~1;
+    h &= ~1;
+
+    int x = cx - w / 2, y = cy - h / 2;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x > OV5640_FIELD_W - w) x = OV5640_FIELD_W - w;
+    if (y > OV5640_FIELD_H - h) y = OV5640_FIELD_H - h;
+    x &= ~1;                             // Bayer-Muster beibehalten
+    y &= ~1;
+
+    // Group-Hold, Fensterblock 0x3800–0x3815 (ein Burst), Auslese ohne
+    // Binning, Scaler, Hold-Ende und Launch am nächsten Frame-Beginn
+    const uint16_t v16[] = {
+        x, y,                                                      // X/Y_ADDR_ST
+        x + w + 2 * OV5640_ISP_OFF_X - 1, y + h + 2 * OV5640_ISP_OFF_Y - 1,  // X/Y_ADDR_END
+        out_w, out_h,                                              // X/Y_OUTPUT_SIZE
+        OV5640_HTS_FULL, h + OV5640_VTS_PAD,                       // X/Y_TOTAL_SIZE
+        OV5640_ISP_OFF_X, OV5640_ISP_OFF_Y,                        // X/Y_OFFSET
+    };
+    ov5640_reg_t regs[1 + 2 * 10 + 6 + 2];
+    size_t n = 0;
+    regs[n++] = (ov5640_reg_t){ SYSTEM_GROUP_ACCESS, ROI_GROUP, OV5640_STROBE, 0 };
+    for (int i = 0; i < 10; i++) {
+        regs[n++] = (ov5640_reg_t){ X_ADDR_ST_H + 2 * i,     v16[i] >> 8,   0xFF, 0 };
+        regs[n++] = (ov5640_reg_t){ X_ADDR_ST_H + 2 * i + 1, v16[i] & 0xFF, 0xFF, 0 };
+    }
+    regs[n++] = (ov5640_reg_t){ X_INCREMENT, 0x11, 0xFF, 0 };        // kein Subsampling
+    regs[n++] = (ov5640_reg_t){ Y_INCREMENT, 0x11, 0xFF, 0 };
+    regs[n++] = (ov5640_reg_t){ TIMING_TC_REG20, 0x40, 0x41, 0 };   // Binning aus
+    regs[n++] = (ov5640_reg_t){ TIMING_TC_REG21, 0x00, 0x01, 0 };
+    regs[n++] = (ov5640_reg_t){ 0x4514, s->status.vflip ? 0x00 : s->status.hmirror ? 0xBB : 0x88,
+                                0xFF, 0 };
+    regs[n++] = (ov5640_reg_t){ 0x4520, 0x10, 0xFF, 0 };
+    regs[n++] = (ov5640_reg_t){ ISP_CONTROL_01, (w != out_w || h != out_h) ? 0x20 : 0x00,
+                                0x20, 0 };
+    regs[n++] = (ov5640_reg_t){ SYSTEM_GROUP_ACCESS, 0x10 | ROI_GROUP, OV5640_STROBE, 0 };
+    regs[n++] = (ov5640_reg_t){ SYSTEM_GROUP_ACCESS, 0xA0 | ROI_GROUP, OV5640_STROBE, 0 };
+    const ov5640_seq_t seq = { "roi", regs, n };
+    ov5640_seq_stat_t st;
+    if (ov5640_seq_apply(s, &seq, 0, &st) != ESP_OK) return ESP_FAIL;
+
+    ESP_LOGI(TAG, "roi: window %dx%d at %d,%d -> %dx%d (zoom %d.%dx), %u regs in %lld us",
+             w, h, x, y, out_w, out_h,
+             OV5640_FIELD_W / w, OV5640_FIELD_W * 10 / w % 10, st.regs, (long long)st.us);
+    return ESP_OK;
+}
+
+// Aktuellen Ausschnitt übernehmen (hält s_cam_lock)
+static void roi_apply(const camera_config_t *cfg)
+{
+    sensor_t *s = esp_camera_sensor_get();
+    portENTER_CRITICAL(&s_roi_mux);
+    camera_roi_t r = s_roi;
+    s_roi_dirty = false;
+    portEXIT_CRITICAL(&s_roi_mux);
+    if (s && roi_program(s, cfg, &r) != ESP_OK) {
+        ESP_LOGW(TAG, "roi: programming window failed");
+    }
+}
+
+static bool roi_active(void)
+{
+    portENTER_CRITICAL(&s_roi_mux);
+    bool on = s_roi.w > 0;
+    portEXIT_CRITICAL(&s_roi_mux);
+    return on;
+}
+
+esp_err_t camera_set_roi(const camera_roi_t *roi)
+{
+    camera_roi_t r = { 0 };
+    if (roi && roi->w > 0 && roi->h > 0) {
+        if (roi->x < 0 || roi->y < 0 || roi->x + roi->w > 100 || roi->y + roi->h > 100) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        r = *roi;
+    }
+    portENTER_CRITICAL(&s_roi_mux);
+    s_roi = r;
+    s_roi_dirty = true;
+    portEXIT_CRITICAL(&s_roi_mux);
+    return ESP_OK;
+}
+
+void camera_get_roi(camera_roi_t *roi)
+{
+    portENTER_CRITICAL(&s_roi_mux);
+    *roi = s_roi;
+    portEXIT_CRITICAL(&s_roi_mux);
+}
+
+// Im Stream eingeschwungene Belichtung, während der Sensor im Snapshot-Modus ist
+static ov5640_ae_t s_snap_ae;
+
+// Schaltet Auflösung und JPEG-Qualität bei laufendem Treiber um.
+// Der OV5640-Treiber programmiert dabei Fenster (X_ADDR_*), Ausgabegröße
+// (X_OUTPUT_SIZE_*) und Scaler (ISP_CONTROL_01) neu. Frames im alten Format
+// werden verworfen; der erste passende wird in *out_fb zurückgegeben
+// (oder freigegeben, wenn out_fb NULL ist). Ein aktiver Stream-Ausschnitt wird
+// danach wieder gesetzt. Aufrufer hält s_cam_lock.
+static esp_err_t switch_mode(const camera_config_t *cfg, camera_fb_t **out_fb,
+                             int64_t *elapsed_us)
+{
+    int64_t t0 = esp_timer_get_time();
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s) return ESP_ERR_INVALID_STATE;
+
+    if (s->set_framesize(s, cfg->frame_size) != 0) {
+        ESP_LOGE(TAG, "set_framesize(%d) failed", cfg->frame_size);
+        return ESP_FAIL;
+    }
+    s->set_quality(s, cfg->jpeg_quality);
+    if (cfg == &stream_cfg && roi_active()) roi_apply(cfg);
+    // Belichtung: in den Snapshot die umgerechneten Stream-Werte, zurück im
+    // Stream die eingefrorenen Werte und wieder die Automatik
+    if (s_snap_ae.held) {
+        esp_err_t ae = cfg == &snap_cfg ? ov5640_ae_transfer(s, &s_snap_ae)
+                                        : ov5640_ae_release(s, &s_snap_ae);
+        if (ae != ESP_OK) ESP_LOGW(TAG, "exposure hand-off failed: 0x%x", ae);
+    }
+
+    const uint16_t w = resolution[cfg->frame_size].width;
+    const uint16_t h = resolution[cfg->frame_size].height;
+    esp_err_t err = ESP_ERR_TIMEOUT;
+    for (int i = 0; i < MODE_SWITCH_MAX_FRAMES; i++) {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (!fb) break;
+        // fb->width/height setzt der Treiber aus sensor.status, also schon
+        // auf die neue Größe — ein Frame, der noch im alten Modus im Ring
+        // lag, trägt sie auch. Maßgeblich ist das SOF des JPEG.
+        uint16_t jw = 0, jh = 0;
+        if (jpeg_frame_size(fb->buf, fb->len, &jw, &jh) == ESP_OK && jw == w && jh == h) {
+            if (out_fb) *out_fb = fb;
+            else esp_camera_fb_return(fb);
+            err = ESP_OK;
+            break;
+        }
+        esp_camera_fb_return(fb);
+    }
+
+    int64_t us = esp_timer_get_time() - t0;
+    if (elapsed_us) *elapsed_us = us;
+    metrics_observe(MET_H_MODE_SWITCH_US, (uint32_t)us);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "mode switch to %ux%u failed: 0x%x", w, h, err);
+    } else {
+        ESP_LOGI(TAG, "mode switch to %ux%u q%d in %lld ms",
+                 w, h, cfg->jpeg_quality, (long long)(us / 1000));
+    }
+    return err;
+}
+
+void camera_set_target_fps(int fps)
+{
+    if (fps < 1) fps = 1;
+    if (fps > STREAM_MAX_FPS) fps = STREAM_MAX_FPS;
+    s_target_fps = fps;
+}
+
+int camera_get_target_fps(void)
+{
+    return s_target_fps;
+}
+
+void camera_report_send_time(int64_t us)
+{
+    portENTER_CRITICAL(&s_pace_mux);
+    if (us < s_send_min_us) s_send_min_us = us;
+    portEXIT_CRITICAL(&s_pace_mux);
+}
+
+// Schläft bis zur Deadline (auf ganze Ticks aufgerundet)
+static void sleep_until_us(int64_t deadline_us)
+{
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    int64_t wait = deadline_us - esp_timer_get_time();
+    if (wait > 0) vTaskDelay((wait + tick_us - 1) / tick_us);
+}
+
+// Neue Stream-Einstellung des Bitraten-Reglers anwenden (hält s_cam_lock).
+// Nur Qualität: ein Registerzugriff; neue Auflösung: Moduswechsel.
+static void apply_rate_setting(const rate_ctrl_setting_t *rc)
+{
+    stream_cfg.jpeg_quality = rc->quality;
+    if (rc->frame_size != stream_cfg.frame_size) {
+        stream_cfg.frame_size = rc->frame_size;
+        switch_mode(&stream_cfg, NULL, NULL);
+    } else {
+        sensor_t *s = esp_camera_sensor_get();
+        if (s) s->set_quality(s, rc->quality);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Laufzeit-Einstellungen (/control)
+//
+// camera_set_ctrl() legt nur den neuen Satz ab; der Capture-Task übernimmt
+// ihn vollständig zwischen zwei Frames unter s_cam_lock — wie Bitraten-Regler
+// und ROI. Snapshot und Burst halten dieselbe Sperre und sehen snap_cfg
+// daher nie halb geändert. Neue Auflösung oder Ausrichtung laufen über
+// switch_mode (set_framesize schreibt Spiegeln/Kippen mit, ROI kommt wieder
+// drauf); Frames, die während des Schreibens entstanden, werden verworfen.
+// ---------------------------------------------------------------------------
+static bool ctrl_valid(const camera_ctrl_t *c)
+{
+    return (int)c->frame_size >= 0 && c->frame_size <= s_fb_max_size &&
+           (int)c->snap_frame_size >= 0 && c->snap_frame_size <= s_fb_max_size &&
+           c->quality >= CTRL_Q_MIN && c->quality <= CTRL_Q_MAX &&
+           c->snap_quality >= CTRL_Q_MIN && c->snap_quality <= CTRL_Q_MAX &&
+           c->fps >= 1 && c->fps <= STREAM_MAX_FPS &&
+           c->bitrate_kbps >= 0 && c->bitrate_kbps <= CTRL_KBPS_MAX;
+}
+
+esp_err_t camera_set_ctrl(const camera_ctrl_t *c)
+{
+    if (!ctrl_valid(c)) return ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&s_ctrl_mux);
+    s_ctrl = *c;
+    s_ctrl_dirty = true;
+    portEXIT_CRITICAL(&s_ctrl_mux);
+    return ESP_OK;
+}
+
+void camera_get_ctrl(camera_ctrl_t *c)
+{
+    portENTER_CRITICAL(&s_ctrl_mux);
+    *c = s_ctrl;
+    portEXIT_CRITICAL(&s_ctrl_mux);
+}
+
+// Frames verwerfen, die während eines Registerwechsels belichtet wurden
+static void ctrl_settle(void)
+{
+    for (int i = 0; i < CTRL_SETTLE_FRAMES; i++) {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb) esp_camera_fb_return(fb);
+    }
+}
+
+// Angeforderte Einstellungen übernehmen (Capture-Task, hält s_cam_lock)
+static void ctrl_apply(void)
+{
+    portENTER_CRITICAL(&s_ctrl_mux);
+    camera_ctrl_t c = s_ctrl;
+    s_ctrl_dirty = false;
+    portEXIT_CRITICAL(&s_ctrl_mux);
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s) return;
+
+    int64_t t0 = esp_timer_get_time();
+    snap_cfg.frame_size   = c.snap_frame_size;
+    snap_cfg.jpeg_quality = c.snap_quality;
+    camera_set_target_fps(c.fps);
+
+    bool orient  = s->status.hmirror != c.hmirror || s->status.vflip != c.vflip;
+    bool pattern = s->status.colorbar != c.test_pattern;
+    bool resize  = stream_cfg.frame_size != c.frame_size;
+    if (orient) {
+        s->set_hmirror(s, c.hmirror);
+        s->set_vflip(s, c.vflip);
+    }
+    if (pattern) s->set_colorbar(s, c.test_pattern);
+
+    // Neue Obergrenze für den Bitraten-Regler, der von dort neu anfängt
+    rate_ctrl_init(c.quality, c.frame_size);
+    rate_ctrl_enable(c.adaptive);
+    rate_ctrl_set_target_kbps(c.bitrate_kbps);
+    stream_cfg.frame_size   = c.frame_size;
+    stream_cfg.jpeg_quality = c.quality;
+    if (resize || orient) {
+        switch_mode(&stream_cfg, NULL, NULL);
+    } else {
+        s->set_quality(s, c.quality);
+    }
+    if (orient || pattern) ctrl_settle();
+
+    ESP_LOGI(TAG, "control: %ux%u q%d %d fps%s %d kbps%s%s%s, snapshot %ux%u q%d in %lld ms",
+             resolution[c.frame_size].width, resolution[c.frame_size].height,
+             c.quality, c.fps, c.adaptive ? ", adaptive" : ", fixed", c.bitrate_kbps,
+             c.hmirror ? ", mirror" : "", c.vflip ? ", flip" : "",
+             c.test_pattern ? ", test pattern" : "",
+             resolution[c.snap_frame_size].width, resolution[c.snap_frame_size].height,
+             c.snap_quality, (long long)((esp_timer_get_time() - t0) / 1000));
+}
+
+// Einziger Aufrufer von esp_camera_fb_get() im Stream-Betrieb:
+// holt Frames und veröffentlicht sie im Frame-Ring für alle Clients.
+// Pacing über Deadlines statt fester Pause: Periode = 1/Ziel-FPS, aber nie
+// kürzer als der schnellste Client senden kann (sonst nur verworfene Kopien).
+static void capture_task(void *arg)
+{
+    int64_t next_us   = 0;
+    int64_t send_us   = 0;   // schnellste Sendedauer des letzten Fensters
+    int64_t cap_sum   = 0;
+    int64_t stats_t0  = esp_timer_get_time();
+    int64_t win_t0    = stats_t0;
+    uint32_t frames   = 0;
+
+    while (1) {
+        if (frame_ring_reader_count() == 0 && !clip_store_recording()) {
+            if (s_ctrl_dirty) {
+                // Auch ohne Stream übernehmen (Snapshot-Profil, GET zeigt den Stand)
+                xSemaphoreTake(s_cam_lock, portMAX_DELAY);
+                ctrl_apply();
+                xSemaphoreGive(s_cam_lock);
+            }
+            vTaskDelay(pdMS_TO_TICKS(CAPTURE_IDLE_MS));
+            next_us = 0;
+            continue;
+        }
+
+        int64_t period = 1000000LL / s_target_fps;
+        if (send_us > period) period = send_us;
+        rate_ctrl_setting_t rc;
+        bool rc_changed = rate_ctrl_poll(period, &rc);
+
+        int64_t t0 = esp_timer_get_time();
+        xSemaphoreTake(s_cam_lock, portMAX_DELAY);
+        if (s_ctrl_dirty) ctrl_apply();
+        else if (rc_changed) apply_rate_setting(&rc);
+        if (s_roi_dirty) roi_apply(&stream_cfg);
+        int64_t t_get = esp_timer_get_time();
+        camera_fb_t *fb = esp_camera_fb_get();
+        metrics_observe(MET_H_FB_GET_US, (uint32_t)(esp_timer_get_time() - t_get));
+        if (fb) {
+            if (fb->len >= 2 && fb->buf[0]==0xFF && fb->buf[1]==0xD8) {
+                metrics_observe(MET_H_JPEG_BYTES, fb->len);
+                if (frame_ring_publish(fb) == ESP_OK) {
+                    frames++;
+                    metrics_add(MET_C_FRAMES_CAPTURED, 1);
+                } else {
+                    metrics_add(MET_C_FRAMES_DROPPED, 1);
+                }
+                clip_store_add(fb);
+            }
+            esp_camera_fb_return(fb);
+        }
+        xSemaphoreGive(s_cam_lock);
+        int64_t now = esp_timer_get_time();
+        if (!fb) {
+            metrics_add(MET_C_FB_GET_FAIL, 1);
+            ESP_LOGW(TAG, "capture_task: no frame");
+            vTaskDelay(pdMS_TO_TICKS(CAPTURE_IDLE_MS));
+            continue;
+        }
+        cap_sum += now - t0;
+
+        // Nächste Deadline; bei Verspätung neu aufsetzen statt aufzuholen
+        next_us = next_us ? next_us + period : t0 + period;
+        if (next_us < now) next_us = now;
+        sleep_until_us(next_us);
+
+        // Fenster auswerten: schnellste Sendezeit übernehmen
+        if (now - win_t0 >= PACING_WINDOW_US) {
+            portENTER_CRITICAL(&s_pace_mux);
+            int64_t sm = s_send_min_us;
+            s_send_min_us = INT64_MAX;
+            portEXIT_CRITICAL(&s_pace_mux);
+            send_us = (sm == INT64_MAX) ? 0 : sm;
+            win_t0  = now;
+        }
+        if (now - stats_t0 >= PACING_STATS_US) {
+            ESP_LOGI(TAG, "pacing: %lu fps (target %d), capture %lld ms, send %lld ms",
+                     (unsigned long)(frames * 1000000LL / (now - stats_t0)), s_target_fps,
+                     (long long)(frames ? cap_sum / frames / 1000 : 0),
+                     (long long)(send_us / 1000));
+            stats_t0 = now;
+            frames   = 0;
+            cap_sum  = 0;
+        }
+    }
+}
+
+// Gespeicherte Einstellungen laden und in stream_cfg/snap_cfg übernehmen;
+// ohne (gültigen) Eintrag gelten die Werte aus prepare_configs()
+static void ctrl_load(void)
+{
+    // Framebuffer werden für die Snapshot-Auflösung angelegt — größer geht
+    // zur Laufzeit nicht
+    s_fb_max_size = snap_cfg.frame_size;
+    s_ctrl = (camera_ctrl_t){
+        .frame_size      = stream_cfg.frame_size,
+        .quality         = stream_cfg.jpeg_quality,
+        .fps             = STREAM_DEFAULT_FPS,
+        .adaptive        = true,
+        .snap_frame_size = snap_cfg.frame_size,
+        .snap_quality    = snap_cfg.jpeg_quality,
+    };
+
+    nvs_handle_t h;
+    camera_ctrl_t c;
+    size_t len = sizeof(c);
+    if (nvs_open(CTRL_NVS_NS, NVS_READONLY, &h) != ESP_OK) return;
+    bool ok = nvs_get_blob(h, "ctrl", &c, &len) == ESP_OK && len == sizeof(c);
+    nvs_close(h);
+    if (!ok) return;
+    if (!ctrl_valid(&c)) {
+        ESP_LOGW(TAG, "control: stored settings out of range, using defaults");
+        return;
+    }
+    s_ctrl = c;
+    stream_cfg.frame_size   = c.frame_size;
+    stream_cfg.jpeg_quality = c.quality;
+    snap_cfg.frame_size     = c.snap_frame_size;
+    snap_cfg.jpeg_quality   = c.snap_quality;
+    camera_set_target_fps(c.fps);
+    ESP_LOGI(TAG, "control: settings loaded from NVS");
+}
+
+static esp_err_t ctrl_save(const camera_ctrl_t *c)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(CTRL_NVS_NS, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, "ctrl", c, sizeof(*c));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
 // Initialisiert die Kamera im Streaming-Modus
 esp_err_t camera_init(void)
 {
@@ -102,107 +639,915 @@ esp_err_t camera_init(void)
     vTaskDelay(pdMS_TO_TICKS(50));
 
     prepare_configs();
+    ctrl_load();
+    rate_ctrl_init(stream_cfg.jpeg_quality, stream_cfg.frame_size);
+    rate_ctrl_enable(s_ctrl.adaptive);
+    rate_ctrl_set_target_kbps(s_ctrl.bitrate_kbps);
 
-    esp_err_t err = esp_camera_init(&stream_cfg);
+    // Framebuffer für die Snapshot-Auflösung anlegen, damit später nur
+    // noch der Sensor umgeschaltet werden muss (kein deinit/init)
+    camera_config_t init_cfg = stream_cfg;
+    init_cfg.frame_size = s_fb_max_size;
+    esp_err_t err = esp_camera_init(&init_cfg);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "stream esp_camera_init failed: 0x%x", err);
-    } else {
-        ESP_LOGI(TAG, "camera_init OK (VGA @30q)");
+        return err;
     }
+    // Registersequenzen als SCCB-Bursts über den Bus des Treibers
+    ov5640_seq_init(init_cfg.sccb_i2c_port);
+    // Gespeicherte Ausrichtung/Testbild vor dem ersten Moduswechsel setzen,
+    // set_framesize übernimmt sie dann mit
+    sensor_t *s = esp_camera_sensor_get();
+    if (s) {
+        s->set_hmirror(s, s_ctrl.hmirror);
+        s->set_vflip(s, s_ctrl.vflip);
+        s->set_colorbar(s, s_ctrl.test_pattern);
+    }
+    err = switch_mode(&stream_cfg, NULL, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "switch to stream mode failed: 0x%x", err);
+        return err;
+    }
+    ESP_LOGI(TAG, "camera_init OK (%ux%u @%dq)", resolution[stream_cfg.frame_size].width,
+             resolution[stream_cfg.frame_size].height, stream_cfg.jpeg_quality);
+
+    // Autofokus: Firmware laden und im Stream dauerhaft nachführen, damit
+    // Snapshots nur noch die Linse festhalten müssen
+    if (s && ov5640_af_init(s) == ESP_OK) {
+        ov5640_af_continuous(s);
+    }
+
+    s_cam_lock = xSemaphoreCreateMutex();
+    err = s_cam_lock ? frame_ring_init() : ESP_ERR_NO_MEM;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "frame ring init failed: 0x%x", err);
+        return err;
+    }
+    // Pre-Event-Puffer ist optional: ohne PSRAM-Arena läuft der Rest weiter
+    if (clip_store_init() != ESP_OK) {
+        ESP_LOGW(TAG, "clip store disabled");
+    }
+    if (snapshot_start() != ESP_OK) {
+        ESP_LOGE(TAG, "snapshot task create failed");
+        return ESP_ERR_NO_MEM;
+    }
+    if (task_create(TASK_CAPTURE, capture_task, NULL, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "capture task create failed");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot: Cache + Single-Flight
+//
+// Der Handler beantwortet Anfragen, denen das letzte Foto frisch genug ist
+// (?maxage=ms), direkt aus dem Cache. Alle anderen werden als async-Request
+// an den Snapshot-Task übergeben. Der nimmt genau ein Foto auf und beantwortet
+// damit jede Anfrage, die bis zum Ende der Aufnahme eingetroffen ist — ein
+// Moduswechsel pro Schwall statt einer pro Client.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint8_t *jpg;
+    size_t   len;
+    int64_t  ts_us;          // Aufnahmezeitpunkt (esp_timer)
+    int64_t  to_snap_us, to_stream_us;
+    int64_t  focus_us;       // Fokuszeit, 0 = stand schon, -1 = kein AF
+    int      refs;           // Cache + laufende Antworten
+    char     etag[24];
+} snap_entry_t;
+
+typedef struct {
+    httpd_req_t *req;
+    char inm[24];            // If-None-Match der Anfrage
+} snap_job_t;
+
+static portMUX_TYPE  s_snap_mux = portMUX_INITIALIZER_UNLOCKED;
+static snap_entry_t *s_snap_cache;    // letztes Foto (hält eine Referenz)
+static uint32_t      s_snap_boot;     // unterscheidet ETags über Neustarts
+static uint32_t      s_snap_id;
+static QueueHandle_t s_snap_queue;
+
+static snap_entry_t *snap_cache_get(void)
+{
+    portENTER_CRITICAL(&s_snap_mux);
+    snap_entry_t *e = s_snap_cache;
+    if (e) e->refs++;
+    portEXIT_CRITICAL(&s_snap_mux);
+    return e;
+}
+
+static void snap_entry_put(snap_entry_t *e)
+{
+    if (!e) return;
+    portENTER_CRITICAL(&s_snap_mux);
+    bool last = --e->refs == 0;
+    portEXIT_CRITICAL(&s_snap_mux);
+    if (last) heap_caps_free(e);      // Eintrag und JPEG in einem Block
+}
+
+static void snap_cache_set(snap_entry_t *e)
+{
+    e->refs++;
+    portENTER_CRITICAL(&s_snap_mux);
+    snap_entry_t *old = s_snap_cache;
+    s_snap_cache = e;
+    portEXIT_CRITICAL(&s_snap_mux);
+    snap_entry_put(old);
+}
+
+// Sensor in den Snapshot-Modus schalten und scharf stellen (hält s_cam_lock).
+// Hat der Dauer-AF schon scharf gestellt, wird nur die Linse gehalten —
+// sonst würde er nach dem Fensterwechsel neu suchen. Andernfalls ein
+// Einzelfokus; der Frame aus der Fokusfahrt wird verworfen.
+static esp_err_t snap_mode_enter(int64_t *to_snap_us, int64_t *focus_us)
+{
+    sensor_t *s = esp_camera_sensor_get();
+    bool af = s && ov5640_af_ready();
+    bool held = af && ov5640_af_focused(s) && ov5640_af_pause(s) == ESP_OK;
+    *focus_us = held ? 0 : -1;
+
+    // AEC/AGC einfrieren; switch_mode rechnet die Werte auf den Snapshot um,
+    // sodass schon der erste 5-MP-Frame richtig belichtet ist
+    if (s) ov5640_ae_hold(s, &s_snap_ae);
+
+    esp_err_t err = switch_mode(&snap_cfg, NULL, to_snap_us);
+    if (err == ESP_OK && af && !held) {
+        ov5640_af_single(s, SNAP_AF_TIMEOUT_MS, focus_us);
+        camera_fb_t *stale = esp_camera_fb_get();
+        if (stale) esp_camera_fb_return(stale);
+    }
+    if (*focus_us >= 0) metrics_observe(MET_H_AF_LOCK_US, (uint32_t)*focus_us);
     return err;
 }
 
-// Kurzer OV5640-Autofokus
-static void do_autofocus(sensor_t *s)
+// Zurück in den Stream-Modus, Dauer-AF wieder freigeben (hält s_cam_lock)
+static void snap_mode_leave(int64_t *to_stream_us)
 {
-    s->set_reg(s, 0x3022, 0xFF, 0x20);
-    for (int i = 0; i < 20; ++i) {
-        int st = s->get_reg(s, 0x3820, 0xFF);
-        if (st & 0x01) break;
-        vTaskDelay(pdMS_TO_TICKS(50));
+    if (switch_mode(&stream_cfg, NULL, to_stream_us) != ESP_OK) {
+        ESP_LOGE(TAG, "snapshot: return to stream mode failed");
     }
-    s->set_reg(s, 0x3022, 0xFF, 0x00);
+    sensor_t *s = esp_camera_sensor_get();
+    if (s && ov5640_af_ready()) ov5640_af_continuous(s);
 }
 
-// Handler für 5 MP-Snapshot mit Autofokus
-esp_err_t snapshot_handler(httpd_req_t *req)
+// Ein Foto aufnehmen; liefert einen Eintrag mit einer Referenz oder NULL
+static snap_entry_t *snap_capture(void)
 {
-    // 1) Stream stoppen
-    esp_camera_deinit();
+    int64_t to_snap_us = 0, to_stream_us = 0, focus_us = -1;
+    camera_fb_t *fb = NULL;
+    snap_entry_t *e = NULL;
+
+    // Capture-Task anhalten, solange der Sensor im Snapshot-Modus ist
+    xSemaphoreTake(s_cam_lock, portMAX_DELAY);
+
+    // 1) Snapshot-Modus aktivieren (Treiber bleibt aktiv), Fokus, Foto
+    esp_err_t err = snap_mode_enter(&to_snap_us, &focus_us);
+    if (err == ESP_OK) fb = esp_camera_fb_get();
+
+    // 2) JPEG kopieren, damit der Stream nicht auf das Senden warten muss
+    if (fb) {
+        e = heap_caps_malloc(sizeof(*e) + fb->len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (e) {
+            memset(e, 0, sizeof(*e));
+            e->jpg   = (uint8_t *)(e + 1);
+            e->len   = fb->len;
+            e->ts_us = esp_timer_get_time();
+            memcpy(e->jpg, fb->buf, fb->len);
+        }
+        esp_camera_fb_return(fb);
+    }
+
+    // 3) Zurück in den Stream-Modus
+    snap_mode_leave(&to_stream_us);
+    xSemaphoreGive(s_cam_lock);
 
-    // 2) Snapshot-Modus aktivieren
-    esp_err_t err = esp_camera_init(&snap_cfg);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "snap esp_camera_init failed: 0x%x", err);
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "snap init fail");
-        // Rückfall auf Stream
-        esp_camera_deinit();
-        esp_camera_init(&stream_cfg);
-        return ESP_FAIL;
+        ESP_LOGE(TAG, "snapshot: snap mode switch failed");
+        return NULL;
+    }
+    if (!e) {
+        ESP_LOGE(TAG, "snapshot: capture failed");
+        return NULL;
     }
+    e->to_snap_us   = to_snap_us;
+    e->to_stream_us = to_stream_us;
+    e->focus_us     = focus_us;
+    e->refs         = 1;
+    metrics_add(MET_C_SNAPSHOTS, 1);
+    snprintf(e->etag, sizeof(e->etag), "\"%08lx-%lu\"",
+             (unsigned long)s_snap_boot, (unsigned long)++s_snap_id);
+    return e;
+}
 
-    // 3) Autofokus (OV5640)
-    sensor_t *s = esp_camera_sensor_get();
-    if (s) do_autofocus(s);
-
-    // 4) Foto aufnehmen
-    camera_fb_t *fb = esp_camera_fb_get();
-    if (!fb) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "capture fail");
-        esp_camera_deinit();
-        esp_camera_init(&stream_cfg);
-        return ESP_FAIL;
+static esp_err_t snap_send(httpd_req_t *req, const snap_entry_t *e,
+                           const char *inm, const char *cache_state)
+{
+    char age_ms[24], snap_ms[24], stream_ms[24], focus_ms[24];
+    snprintf(age_ms,    sizeof(age_ms),    "%lld",
+             (long long)((esp_timer_get_time() - e->ts_us) / 1000));
+    snprintf(snap_ms,   sizeof(snap_ms),   "%lld", (long long)(e->to_snap_us / 1000));
+    snprintf(stream_ms, sizeof(stream_ms), "%lld", (long long)(e->to_stream_us / 1000));
+    httpd_resp_set_hdr(req, "ETag", e->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "X-Cache", cache_state);
+    httpd_resp_set_hdr(req, "X-Capture-Age-Ms", age_ms);
+    httpd_resp_set_hdr(req, "X-Mode-Switch-Ms", snap_ms);
+    httpd_resp_set_hdr(req, "X-Mode-Restore-Ms", stream_ms);
+    if (e->focus_us >= 0) {
+        snprintf(focus_ms, sizeof(focus_ms), "%lld", (long long)(e->focus_us / 1000));
+        httpd_resp_set_hdr(req, "X-Focus-Ms", focus_ms);
     }
 
-    // 5) JPEG zurücksenden
+    if (inm && inm[0] && strcmp(inm, e->etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
     httpd_resp_set_type(req, "image/jpeg");
-    err = httpd_resp_send(req, (const char*)fb->buf, fb->len);
-    esp_camera_fb_return(fb);
-
-    // 6) Zurück in den Stream-Modus
-    esp_camera_deinit();
-    esp_camera_init(&stream_cfg);
-    return err;
+    metrics_add(MET_C_SNAPSHOT_BYTES, e->len);
+    return httpd_resp_send(req, (const char *)e->jpg, e->len);
 }
 
-// MJPEG-Stream-Handler (VGA-Modus)
-esp_err_t stream_handler(httpd_req_t *req)
+static void snapshot_task(void *arg)
 {
-    httpd_resp_set_type(req, "multipart/x-mixed-replace;boundary=frame");
+    snap_job_t batch[SNAP_QUEUE_LEN];
     while (1) {
+        if (xQueueReceive(s_snap_queue, &batch[0], portMAX_DELAY) != pdTRUE) continue;
+        wifi_link_acquire();
+
+        snap_entry_t *e = snap_capture();
+        if (e) snap_cache_set(e);
+
+        // Alles, was während der Aufnahme dazukam, bekommt dasselbe Foto
+        int n = 1;
+        while (n < SNAP_QUEUE_LEN && xQueueReceive(s_snap_queue, &batch[n], 0) == pdTRUE) n++;
+        if (n > 1) ESP_LOGI(TAG, "snapshot: %d requests coalesced", n);
+
+        for (int i = 0; i < n; i++) {
+            httpd_req_t *req = batch[i].req;
+            if (e) {
+                snap_send(req, e, batch[i].inm, i ? "COALESCED" : "MISS");
+            } else {
+                httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "capture fail");
+            }
+            http_async_done(req, false);
+        }
+        snap_entry_put(e);
+        wifi_link_release();
+    }
+}
+
+static esp_err_t snapshot_start(void)
+{
+    s_snap_boot  = esp_random();
+    s_snap_queue = xQueueCreate(SNAP_QUEUE_LEN, sizeof(snap_job_t));
+    if (!s_snap_queue) return ESP_ERR_NO_MEM;
+    if (task_create(TASK_SNAPSHOT, snapshot_task, NULL, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// HTTP-Handler für Snapshot: /snapshot[?maxage=ms], If-None-Match → 304
+esp_err_t snapshot_handler(httpd_req_t *req)
+{
+    snap_job_t job = { 0 };
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", job.inm, sizeof(job.inm)) != ESP_OK) {
+        job.inm[0] = '\0';
+    }
+
+    int64_t maxage_ms = 0;
+    char query[32], val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "maxage", val, sizeof(val)) == ESP_OK) {
+        maxage_ms = atoi(val);
+        if (maxage_ms < 0) maxage_ms = 0;
+        if (maxage_ms > SNAP_MAXAGE_MAX_MS) maxage_ms = SNAP_MAXAGE_MAX_MS;
+    }
+
+    // 1) Frisch genug im Cache → sofort antworten
+    if (maxage_ms) {
+        snap_entry_t *e = snap_cache_get();
+        if (e && esp_timer_get_time() - e->ts_us <= maxage_ms * 1000) {
+            metrics_add(MET_C_SNAPSHOT_HITS, 1);
+            wifi_link_acquire();
+            esp_err_t err = snap_send(req, e, job.inm, "HIT");
+            wifi_link_release();
+            snap_entry_put(e);
+            return err;
+        }
+        snap_entry_put(e);
+    }
+
+    // 2) Sonst an den Snapshot-Task übergeben (läuft ggf. schon eine Aufnahme,
+    //    wird diese Anfrage mit ihr beantwortet)
+    if (httpd_req_async_handler_begin(req, &job.req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "async begin fail");
+    }
+    http_async_claim(job.req);
+    if (xQueueSend(s_snap_queue, &job, 0) != pdTRUE) {
+        httpd_resp_set_status(job.req, "503 Service Unavailable");
+        httpd_resp_send(job.req, "too many snapshot requests", HTTPD_RESP_USE_STRLEN);
+        http_async_done(job.req, false);
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Burst: N Frames in Snapshot-Auflösung nach einem einzigen Moduswechsel
+//
+// Ein eigener Task hält den Sensor im Snapshot-Modus, nimmt die Frames im
+// gewünschten Abstand auf und kopiert sie ins PSRAM; ein Sender-Task schickt
+// sie über den asynchronen Request als multipart, sobald sie fertig sind —
+// der httpd-Worker ist währenddessen frei. Die Queue begrenzt die Zahl der
+// Kopien — ist der Client langsamer als der Sensor, wartet die Aufnahme.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint8_t *jpg;            // NULL: Ende des Bursts
+    size_t   len;
+    int64_t  ts_us;
+    int      index;
+} burst_frame_t;
+
+// Gehört dem Sender-Task; der Aufnahme-Task greift bis zur Ende-Nachricht zu
+typedef struct {
+    httpd_req_t  *req;       // asynchrone Kopie des Requests
+    QueueHandle_t queue;
+    int           n;
+    int64_t       interval_us;
+    volatile bool abort;     // Client weg → keine weiteren Frames aufnehmen
+    esp_err_t     err;
+    int64_t       to_snap_us, to_stream_us, focus_us;
+} burst_t;
+
+static volatile bool s_burst_busy;
+
+static int64_t fb_timestamp_us(const camera_fb_t *fb)
+{
+    return (int64_t)fb->timestamp.tv_sec * 1000000LL + fb->timestamp.tv_usec;
+}
+
+// Raster ab der Aufnahmezeit des ersten Frames: Frame i frühestens bei
+// t0 + i * interval. Zeiten sind die des Treibers (fb->timestamp), nicht die
+// Rückkehr aus fb_get — sonst gehen Wartezeiten im Treiber in die Abstände ein.
+static void burst_task(void *arg)
+{
+    burst_t *b = arg;
+    xSemaphoreTake(s_cam_lock, portMAX_DELAY);
+    b->err = snap_mode_enter(&b->to_snap_us, &b->focus_us);
+
+    int64_t next_us = 0, prev_us = 0;
+    for (int i = 0; i < b->n && b->err == ESP_OK && !b->abort; i++) {
+        if (i && b->interval_us) sleep_until_us(next_us - BURST_TS_SLACK_US);
         camera_fb_t *fb = esp_camera_fb_get();
+        // Vor dem Termin aufgenommene Frames lagen schon im Treiber: verwerfen
+        for (int stale = 0; fb && i && b->interval_us && stale < BURST_MAX_STALE &&
+                            fb_timestamp_us(fb) < next_us - BURST_TS_SLACK_US; stale++) {
+            esp_camera_fb_return(fb);
+            fb = esp_camera_fb_get();
+        }
         if (!fb) {
-            ESP_LOGW(TAG, "stream_handler: no frame, abort");
+            b->err = ESP_FAIL;
             break;
         }
-        if (fb->len >= 2 && fb->buf[0]==0xFF && fb->buf[1]==0xD8) {
-            char header[64];
-            int h = snprintf(header, sizeof(header),
-                             "--frame\r\n"
+        burst_frame_t f = { .len = fb->len, .ts_us = fb_timestamp_us(fb), .index = i };
+        f.jpg = heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (f.jpg) memcpy(f.jpg, fb->buf, fb->len);
+        esp_camera_fb_return(fb);
+        if (!f.jpg) {
+            b->err = ESP_ERR_NO_MEM;
+            break;
+        }
+        next_us = (i ? next_us : f.ts_us) + b->interval_us;
+        if (prev_us) metrics_observe(MET_H_BURST_FRAME_US, (uint32_t)(f.ts_us - prev_us));
+        prev_us = f.ts_us;
+        metrics_add(MET_C_BURST_FRAMES, 1);
+        // s_cam_lock hält den Live-Stream an: nicht unbegrenzt auf den Client warten
+        if (xQueueSend(b->queue, &f, pdMS_TO_TICKS(BURST_QUEUE_WAIT_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "burst: client too slow, abort after %d frames", i);
+            heap_caps_free(f.jpg);
+            b->abort = true;
+        }
+    }
+
+    snap_mode_leave(&b->to_stream_us);
+    xSemaphoreGive(s_cam_lock);
+
+    // Letzte Nachricht: danach gehört b allein dem Sender
+    burst_frame_t end = { 0 };
+    xQueueSend(b->queue, &end, portMAX_DELAY);
+    vTaskDelete(NULL);
+}
+
+// Sender-Task: Frames senden, bis die Ende-Nachricht kommt; nach einem
+// Sendefehler nur noch abräumen
+static void burst_send_task(void *arg)
+{
+    burst_t *b = arg;
+    httpd_req_t *req = b->req;
+    wifi_link_acquire();
+
+    httpd_resp_set_type(req, "multipart/x-mixed-replace;boundary=" BURST_PART_BOUNDARY);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache, no-store");
+
+    esp_err_t res = ESP_OK;
+    int sent = 0, got = 0;
+    int64_t t_first = 0, t_last = 0;
+    char hdr[192];
+    burst_frame_t f;
+    while (xQueueReceive(b->queue, &f, portMAX_DELAY) == pdTRUE && f.jpg) {
+        if (!t_first) t_first = f.ts_us;
+        t_last = f.ts_us;
+        got++;
+        if (res == ESP_OK) {
+            // Bisher gehaltene Rate mitschicken (Frames pro Sekunde ×10)
+            int64_t span = f.ts_us - t_first;
+            unsigned fps10 = span > 0 ? (unsigned)(f.index * 10000000LL / span) : 0;
+            int n = snprintf(hdr, sizeof(hdr),
+                             "\r\n--" BURST_PART_BOUNDARY "\r\n"
                              "Content-Type: image/jpeg\r\n"
-                             "Content-Length: %u\r\n\r\n",
-                             fb->len);
-            esp_err_t res = httpd_resp_send_chunk(req, header, h);
-            if (res != ESP_OK) {
-                ESP_LOGW(TAG, "stream_handler: header send error %d", res);
-                esp_camera_fb_return(fb);
-                break;
+                             "Content-Length: %u\r\n"
+                             "X-Burst-Index: %d\r\n"
+                             "X-Burst-Offset-Ms: %lld\r\n"
+                             "X-Burst-Fps: %u.%u\r\n\r\n",
+                             (unsigned)f.len, f.index, (long long)(span / 1000),
+                             fps10 / 10, fps10 % 10);
+            res = httpd_resp_send_chunk(req, hdr, n);
+            if (res == ESP_OK) res = httpd_resp_send_chunk(req, (const char *)f.jpg, f.len);
+            if (res == ESP_OK) sent++;
+            else b->abort = true;
+        }
+        heap_caps_free(f.jpg);
+    }
+    if (res == ESP_OK) {
+        static const char tail[] = "\r\n--" BURST_PART_BOUNDARY "--\r\n";
+        httpd_resp_send_chunk(req, tail, sizeof(tail) - 1);
+        res = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    wifi_link_release();
+
+    int64_t span = t_last - t_first;
+    unsigned fps10 = span > 0 ? (unsigned)((got - 1) * 10000000LL / span) : 0;
+    ESP_LOGI(TAG, "burst: %d/%d frames sent, %ux%u, %u.%u fps over %lld ms "
+             "(switch %lld ms, focus %lld ms, restore %lld ms)%s",
+             sent, b->n, resolution[snap_cfg.frame_size].width,
+             resolution[snap_cfg.frame_size].height, fps10 / 10, fps10 % 10,
+             (long long)(span / 1000), (long long)(b->to_snap_us / 1000),
+             (long long)(b->focus_us / 1000), (long long)(b->to_stream_us / 1000),
+             b->err != ESP_OK ? " - capture error" : res != ESP_OK ? " - client gone" : "");
+
+    // Abgebrochene Antwort ist nicht httpd-konform beendet → Session schließen
+    http_async_done(req, res != ESP_OK);
+    vQueueDelete(b->queue);
+    free(b);
+    s_burst_busy = false;
+    vTaskDelete(NULL);
+}
+
+// HTTP-Handler: /burst?n=10&interval=100 (ms zwischen den Frames, 0 = Sensortakt).
+// Übergibt den Request an Aufnahme- und Sender-Task und kehrt sofort zurück.
+esp_err_t burst_handler(httpd_req_t *req)
+{
+    int n = 5;
+    int64_t interval_us = 0;
+    char query[48], val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "n", val, sizeof(val)) == ESP_OK) n = atoi(val);
+        if (httpd_query_key_value(query, "interval", val, sizeof(val)) == ESP_OK) {
+            int ms = atoi(val);
+            if (ms < 0) ms = 0;
+            if (ms > BURST_MAX_INTERVAL_MS) ms = BURST_MAX_INTERVAL_MS;
+            interval_us = ms * 1000LL;
+        }
+    }
+    if (n < 1) n = 1;
+    if (n > BURST_MAX_FRAMES) n = BURST_MAX_FRAMES;
+
+    if (__atomic_exchange_n(&s_burst_busy, true, __ATOMIC_ACQ_REL)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "burst in progress", HTTPD_RESP_USE_STRLEN);
+    }
+    burst_t *b = calloc(1, sizeof(*b));
+    if (b) b->queue = xQueueCreate(BURST_QUEUE_LEN, sizeof(burst_frame_t));
+    if (!b || !b->queue) {
+        free(b);
+        s_burst_busy = false;
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no memory");
+    }
+    b->n = n;
+    b->interval_us = interval_us;
+    if (httpd_req_async_handler_begin(req, &b->req) != ESP_OK) {
+        vQueueDelete(b->queue);
+        free(b);
+        s_burst_busy = false;
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "async begin fail");
+    }
+    http_async_claim(b->req);
+    // Sender zuerst: ohne ihn liefe die Aufnahme in eine volle Queue
+    if (task_create(TASK_BURST_SEND, burst_send_task, b, NULL) != pdPASS) {
+        httpd_resp_send_err(b->req, HTTPD_500_INTERNAL_SERVER_ERROR, "burst start fail");
+        http_async_done(b->req, false);
+        vQueueDelete(b->queue);
+        free(b);
+        s_burst_busy = false;
+        return ESP_OK;
+    }
+    if (task_create(TASK_BURST, burst_task, b, NULL) != pdPASS) {
+        // Sender bekommt sofort die Ende-Nachricht und räumt ab
+        ESP_LOGE(TAG, "burst task create failed");
+        b->err = ESP_ERR_NO_MEM;
+        burst_frame_t end = { 0 };
+        xQueueSend(b->queue, &end, portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Thumbnails: Stream-Frames im DCT-Bereich verkleinert (jpeg_thumb), ohne
+// Sensorwechsel und ohne Einfluss auf andere Clients — für Übersichten mit
+// vielen Kacheln bei 1/16 bzw. 1/64 der Pixel
+// ---------------------------------------------------------------------------
+// "1/4" | "1/8" (auch "1%2F4", "4") → Teiler, "1" → 0 (Original), sonst -1
+static int thumb_parse_scale(const char *val)
+{
+    if (strncmp(val, "1/", 2) == 0) val += 2;
+    else if (strncasecmp(val, "1%2F", 4) == 0) val += 4;
+    int div = atoi(val);
+    return div == 1 ? 0 : div == 4 || div == 8 ? div : -1;
+}
+
+static esp_err_t thumb_make(jpeg_thumb_t *t, const frame_t *f, int div,
+                            const uint8_t **jpg, size_t *len)
+{
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = jpeg_thumb_make(t, f->buf, f->len, div, jpg, len);
+    metrics_observe(MET_H_THUMB_US, (uint32_t)(esp_timer_get_time() - t0));
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "thumb: frame %lu not scaled: %s",
+                 (unsigned long)f->seq, esp_err_to_name(err));
+    }
+    return err;
+}
+
+// HTTP-Handler: /thumb[?scale=1/4|1/8] — neuester Stream-Frame, verkleinert
+esp_err_t thumb_handler(httpd_req_t *req)
+{
+    int div = 8;
+    char query[32], val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "scale", val, sizeof(val)) == ESP_OK) {
+        div = thumb_parse_scale(val);
+        if (div <= 0) return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad scale");
+    }
+
+    // Ohne Leser steht der Capture-Task; der Ring hält dann einen alten Frame
+    frame_reader_t *rd = frame_ring_reader_open();
+    if (!rd) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "too many readers", HTTPD_RESP_USE_STRLEN);
+    }
+    const frame_t *f = frame_ring_next(rd, pdMS_TO_TICKS(STREAM_FRAME_TIMEOUT_MS));
+    if (f && esp_timer_get_time() - f->publish_us > THUMB_MAX_AGE_MS * 1000LL) {
+        frame_ring_release(f);
+        f = frame_ring_next(rd, pdMS_TO_TICKS(STREAM_FRAME_TIMEOUT_MS));
+    }
+    frame_ring_reader_close(rd);
+    if (!f) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "no frame", HTTPD_RESP_USE_STRLEN);
+    }
+
+    jpeg_thumb_t *t = jpeg_thumb_create(THUMB_QUALITY);
+    const uint8_t *jpg = NULL;
+    size_t len = 0;
+    esp_err_t err = t ? thumb_make(t, f, div, &jpg, &len) : ESP_ERR_NO_MEM;
+    char seq[12], ts[24];
+    snprintf(seq, sizeof(seq), "%lu", (unsigned long)f->seq);
+    snprintf(ts, sizeof(ts), "%lld.%06lld", (long long)(f->timestamp_us / 1000000),
+             (long long)(f->timestamp_us % 1000000));
+    frame_ring_release(f);             // Ergebnis liegt im Thumb-Kontext
+    if (err != ESP_OK) {
+        jpeg_thumb_destroy(t);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "scale failed");
+    }
+
+    httpd_resp_set_type(req, "image/jpeg");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache, no-store");
+    httpd_resp_set_hdr(req, "X-Frame-Seq", seq);
+    httpd_resp_set_hdr(req, "X-Timestamp", ts);
+    wifi_link_acquire();
+    err = httpd_resp_send(req, (const char *)jpg, len);
+    wifi_link_release();
+    jpeg_thumb_destroy(t);
+    return err;
+}
+
+// Antwort-Header des Streams — wird direkt auf den Socket geschrieben,
+// ohne Chunked-Encoding; das Multipart-Framing machen wir selbst
+static const char STREAM_HTTP_HEADER[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace;boundary=frame\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// Zustand eines Stream-Clients (gehört dem Sender-Task)
+typedef struct {
+    httpd_req_t    *req;        // asynchrone Kopie des Requests
+    frame_reader_t *rd;
+    int64_t         period_us;  // eigene Bildrate, 0 = alle Frames
+    jpeg_thumb_t   *thumb;      // nur bei ?scale=: Verkleinerung im DCT-Bereich
+    int             scale_div;  // 4 oder 8
+} stream_client_t;
+
+// Socket-Optionen für Video-Bulk: kein Nagle (Frame-Ende sofort raus),
+// großer Sendepuffer
+void stream_tune_socket(int fd)
+{
+    int one = 1;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) != 0) {
+        ESP_LOGW(TAG, "TCP_NODELAY failed: errno %d", errno);
+    }
+    int sndbuf = STREAM_SNDBUF;
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) != 0) {
+        // lwIP ohne LWIP_SO_SNDBUF: Puffer kommt aus CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+        ESP_LOGD(TAG, "SO_SNDBUF not supported: errno %d", errno);
+    }
+}
+
+// Schreibt alle iovecs vollständig (writev darf kürzer schreiben)
+esp_err_t stream_writev_all(int fd, struct iovec *iov, int cnt)
+{
+    while (cnt > 0) {
+        ssize_t n = lwip_writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return ESP_FAIL;
+        }
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return ESP_OK;
+}
+
+// Sender-Task: läuft außerhalb der httpd-Worker, bis der Client trennt.
+// Pro Frame ein writev: [HTTP-Header beim ersten Frame] Part-Header, JPEG, CRLF.
+static void stream_task(void *arg)
+{
+    stream_client_t *c = arg;
+    httpd_req_t *req = c->req;
+    int fd = httpd_req_to_sockfd(req);
+    int64_t next_us = 0, prev_sent_us = 0;
+    bool first = true;
+
+    int slot = metrics_client_open("stream", fd);
+    wifi_link_acquire();
+
+    stream_tune_socket(fd);
+    while (1) {
+        if (c->period_us) {
+            int64_t now = esp_timer_get_time();
+            next_us = next_us ? next_us + c->period_us : now;
+            if (next_us < now) next_us = now;
+            sleep_until_us(next_us);
+        }
+        const frame_t *f = frame_ring_next(c->rd, pdMS_TO_TICKS(STREAM_FRAME_TIMEOUT_MS));
+        if (!f) {
+            ESP_LOGW(TAG, "stream_task: no frame, abort");
+            break;
+        }
+        const uint8_t *jpg = f->buf;
+        size_t len = f->len;
+        if (c->thumb && thumb_make(c->thumb, f, c->scale_div, &jpg, &len) != ESP_OK) {
+            frame_ring_release(f);
+            continue;
+        }
+        int64_t t_send = esp_timer_get_time();
+        // Zeiten auf der esp_timer-Basis: Aufnahme (Treiber), Veröffentlichung
+        // im Ring, Sendebeginn und Sendeende des vorigen Parts
+        char header[STREAM_PART_HDR_MAX];
+        int h = snprintf(header, sizeof(header),
+                         "--frame\r\n"
+                         "Content-Type: image/jpeg\r\n"
+                         "Content-Length: %u\r\n"
+                         "X-Frame-Seq: %lu\r\n"
+                         "X-Timestamp: %lld.%06lld\r\n"
+                         "X-Enqueue-Us: %lld\r\n"
+                         "X-Send-Us: %lld\r\n"
+                         "X-Prev-Sent-Us: %lld\r\n\r\n",
+                         (unsigned)len, (unsigned long)f->seq,
+                         (long long)(f->timestamp_us / 1000000),
+                         (long long)(f->timestamp_us % 1000000),
+                         (long long)f->publish_us, (long long)t_send,
+                         (long long)prev_sent_us);
+        struct iovec iov[4];
+        int n = 0;
+        if (first) {
+            iov[n].iov_base = (void *)STREAM_HTTP_HEADER;
+            iov[n].iov_len  = sizeof(STREAM_HTTP_HEADER) - 1;
+            n++;
+        }
+        iov[n].iov_base = header;          iov[n++].iov_len = h;
+        iov[n].iov_base = (void *)jpg;     iov[n++].iov_len = len;
+        iov[n].iov_base = (void *)"\r\n";  iov[n++].iov_len = 2;
+        esp_err_t res = stream_writev_all(fd, iov, n);
+        frame_ring_release(f);
+        if (res != ESP_OK) {
+            ESP_LOGW(TAG, "stream_task: send error, errno %d", errno);
+            break;
+        }
+        first = false;
+        prev_sent_us = esp_timer_get_time();
+        int64_t send_us = prev_sent_us - t_send;
+        metrics_observe(MET_H_SEND_US, (uint32_t)send_us);
+        metrics_client_frame(slot, len, frame_ring_reader_dropped(c->rd));
+        camera_report_send_time(send_us);
+        // Verkleinerte Frames sagen nichts über die Strecke für volle Frames
+        if (!c->thumb) rate_ctrl_report(len, send_us);
+    }
+    ESP_LOGI(TAG, "stream closed, %u frame(s) skipped",
+             (unsigned)frame_ring_reader_dropped(c->rd));
+    frame_ring_reader_close(c->rd);
+    metrics_client_close(slot);
+    wifi_link_release();
+    // Antwort ist nicht httpd-konform beendet → Session schließen
+    http_async_done(req, true);
+    jpeg_thumb_destroy(c->thumb);
+    free(c);
+    vTaskDelete(NULL);
+}
+
+// MJPEG-Stream-Handler (VGA-Modus): übergibt den Request an einen eigenen
+// Sender-Task und gibt den httpd-Worker sofort wieder frei
+esp_err_t stream_handler(httpd_req_t *req)
+{
+    stream_client_t *c = calloc(1, sizeof(*c));
+    if (!c) return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no memory");
+
+    // Optional eigene Bildrate pro Client: /stream?fps=5
+    // Verkleinert ohne Sensorwechsel (pro Client): /stream?scale=1/4 | 1/8
+    // Sensor-Ausschnitt (für alle Clients): /stream?roi=x,y,w,h (Prozent) | roi=off
+    char query[80], val[24];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "fps", val, sizeof(val)) == ESP_OK) {
+            int fps = atoi(val);
+            if (fps > 0) c->period_us = 1000000LL / fps;
+        }
+        if (httpd_query_key_value(query, "scale", val, sizeof(val)) == ESP_OK) {
+            c->scale_div = thumb_parse_scale(val);
+            if (c->scale_div < 0) {
+                free(c);
+                return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad scale");
             }
-            res = httpd_resp_send_chunk(req, (const char*)fb->buf, fb->len);
-            if (res != ESP_OK) {
-                ESP_LOGW(TAG, "stream_handler: image send error %d", res);
-                esp_camera_fb_return(fb);
-                break;
+            if (c->scale_div) {
+                c->thumb = jpeg_thumb_create(THUMB_QUALITY);
+                if (!c->thumb) {
+                    free(c);
+                    return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no memory");
+                }
             }
-            res = httpd_resp_send_chunk(req, "\r\n", 2);
-            if (res != ESP_OK) {
-                ESP_LOGW(TAG, "stream_handler: tail send error %d", res);
-                esp_camera_fb_return(fb);
-                break;
+        }
+        if (httpd_query_key_value(query, "roi", val, sizeof(val)) == ESP_OK) {
+            camera_roi_t r = { 0 };
+            if (strcmp(val, "off") != 0 &&
+                sscanf(val, "%d,%d,%d,%d", &r.x, &r.y, &r.w, &r.h) != 4) {
+                r.w = -1;
+            }
+            if (r.w < 0 || camera_set_roi(&r) != ESP_OK) {
+                jpeg_thumb_destroy(c->thumb);
+                free(c);
+                return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad roi");
             }
         }
-        esp_camera_fb_return(fb);
-        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+
+    c->rd = frame_ring_reader_open();
+    if (!c->rd) {
+        jpeg_thumb_destroy(c->thumb);
+        free(c);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_send(req, "too many streams", HTTPD_RESP_USE_STRLEN);
+    }
+    if (httpd_req_async_handler_begin(req, &c->req) != ESP_OK) {
+        frame_ring_reader_close(c->rd);
+        jpeg_thumb_destroy(c->thumb);
+        free(c);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "async begin fail");
+    }
+    http_async_claim(c->req);
+    if (task_create(TASK_STREAM, stream_task, c, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "stream task create failed");
+        frame_ring_reader_close(c->rd);
+        http_async_done(c->req, false);
+        jpeg_thumb_destroy(c->thumb);
+        free(c);
+        return ESP_FAIL;
     }
     return ESP_OK;
 }
+
+// ---------------------------------------------------------------------------
+// /control
+// ---------------------------------------------------------------------------
+// "640x480" oder Index in resolution[] → framesize_t, -1 wenn unbekannt
+static int ctrl_parse_size(const char *val)
+{
+    unsigned w, h;
+    if (sscanf(val, "%ux%u", &w, &h) == 2) {
+        for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+            if (resolution[i].width == w && resolution[i].height == h) return i;
+        }
+        return -1;
+    }
+    char *end;
+    long i = strtol(val, &end, 10);
+    return *val && !*end && i >= 0 && i < FRAMESIZE_INVALID ? (int)i : -1;
+}
+
+// Formular-Felder auf c anwenden; false bei unlesbarem Wert
+static bool ctrl_parse(const char *q, camera_ctrl_t *c)
+{
+    char val[16];
+    int fs;
+    if (httpd_query_key_value(q, "frame_size", val, sizeof(val)) == ESP_OK) {
+        if ((fs = ctrl_parse_size(val)) < 0) return false;
+        c->frame_size = fs;
+    }
+    if (httpd_query_key_value(q, "snap_frame_size", val, sizeof(val)) == ESP_OK) {
+        if ((fs = ctrl_parse_size(val)) < 0) return false;
+        c->snap_frame_size = fs;
+    }
+    if (httpd_query_key_value(q, "quality", val, sizeof(val)) == ESP_OK) c->quality = atoi(val);
+    if (httpd_query_key_value(q, "snap_quality", val, sizeof(val)) == ESP_OK) {
+        c->snap_quality = atoi(val);
+    }
+    if (httpd_query_key_value(q, "fps", val, sizeof(val)) == ESP_OK) c->fps = atoi(val);
+    if (httpd_query_key_value(q, "adaptive", val, sizeof(val)) == ESP_OK) c->adaptive = atoi(val) != 0;
+    if (httpd_query_key_value(q, "bitrate_kbps", val, sizeof(val)) == ESP_OK) {
+        c->bitrate_kbps = atoi(val);
+    }
+    if (httpd_query_key_value(q, "hmirror", val, sizeof(val)) == ESP_OK) c->hmirror = atoi(val) != 0;
+    if (httpd_query_key_value(q, "vflip", val, sizeof(val)) == ESP_OK) c->vflip = atoi(val) != 0;
+    if (httpd_query_key_value(q, "test_pattern", val, sizeof(val)) == ESP_OK) {
+        c->test_pattern = atoi(val) != 0;
+    }
+    return true;
+}
+
+// HTTP-Handler: GET /control → JSON; POST /control mit Formular-Body ändert
+// die übergebenen Felder, speichert sie und antwortet mit dem neuen Stand
+esp_err_t control_handler(httpd_req_t *req)
+{
+    camera_ctrl_t c;
+    camera_get_ctrl(&c);
+
+    if (req->method == HTTP_POST) {
+        char body[CTRL_BODY_MAX];
+        if (req->content_len >= sizeof(body)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "body too long");
+        }
+        int got = 0;
+        while (got < (int)req->content_len) {
+            int n = httpd_req_recv(req, body + got, req->content_len - got);
+            if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+            if (n <= 0) return ESP_FAIL;
+            got += n;
+        }
+        body[got] = '\0';
+        if (!ctrl_parse(body, &c)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad frame size");
+        }
+        if (camera_set_ctrl(&c) != ESP_OK) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "value out of range");
+        }
+        esp_err_t err = ctrl_save(&c);
+        if (err != ESP_OK) ESP_LOGW(TAG, "control: NVS save failed: %s", esp_err_to_name(err));
+    }
+
+    rate_ctrl_setting_t rc = rate_ctrl_get();
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "{\"frame_size\":\"%ux%u\",\"quality\":%d,\"fps\":%d,"
+             "\"adaptive\":%s,\"bitrate_kbps\":%d,\"hmirror\":%s,\"vflip\":%s,\"test_pattern\":%s,"
+             "\"snapshot\":{\"frame_size\":\"%ux%u\",\"quality\":%d},"
+             "\"max_frame_size\":\"%ux%u\",\"pending\":%s,"
+             "\"active\":{\"frame_size\":\"%ux%u\",\"quality\":%d}}",
+             resolution[c.frame_size].width, resolution[c.frame_size].height,
+             c.quality, c.fps, c.adaptive ? "true" : "false", c.bitrate_kbps,
+             c.hmirror ? "true" : "false", c.vflip ? "true" : "false",
+             c.test_pattern ? "true" : "false",
+             resolution[c.snap_frame_size].width, resolution[c.snap_frame_size].height,
+             c.snap_quality,
+             resolution[s_fb_max_size].width, resolution[s_fb_max_size].height,
+             s_ctrl_dirty ? "true" : "false",
+             resolution[rc.frame_size].width, resolution[rc.frame_size].height, rc.quality);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, buf);
+}
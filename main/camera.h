@@ -1,12 +1,64 @@
 #pragma once
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "sensor.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 // Initialise camera for streaming (e.g. VGA, 30% quality)
 esp_err_t camera_init(void);
 
-// HTTP-URI-Handler für 5-MP-Snapshot
+// HTTP-URI-Handler für 5-MP-Snapshot (?maxage=ms aus dem Cache, ETag/304,
+// gleichzeitige Anfragen teilen sich eine Aufnahme)
 esp_err_t snapshot_handler(httpd_req_t *req);
 
-// HTTP-URI-Handler für MJPEG-Stream
+// HTTP-URI-Handler für N Frames in Snapshot-Auflösung nach einem Moduswechsel,
+// als multipart: /burst?n=10&interval=100
+esp_err_t burst_handler(httpd_req_t *req);
+
+// HTTP-URI-Handler für MJPEG-Stream (?fps=n, ?scale=1/4|1/8, ?roi=x,y,w,h|off)
 esp_err_t stream_handler(httpd_req_t *req);
+
+// HTTP-URI-Handler für den neuesten Stream-Frame, im DCT-Bereich verkleinert
+// (?scale=1/4|1/8, Standard 1/8) — ohne Sensorwechsel
+esp_err_t thumb_handler(httpd_req_t *req);
+
+// Sensor-Ausschnitt des Streams (Digitalzoom) in Prozent des Bildfelds.
+// Gilt für alle Stream-Clients und wird zwischen zwei Frames übernommen.
+typedef struct { int x, y, w, h; } camera_roi_t;
+esp_err_t camera_set_roi(const camera_roi_t *roi);   // NULL oder w/h == 0: Vollbild
+void      camera_get_roi(camera_roi_t *roi);
+
+// Laufzeit-Einstellungen (/control). Der Capture-Task übernimmt sie als
+// Ganzes zwischen zwei Frames; gespeichert im NVS und beim Start geladen.
+typedef struct {
+    framesize_t frame_size;       // Stream (Obergrenze für den Bitraten-Regler)
+    int         quality;          // Stream-JPEG-Qualität (kleiner = besser)
+    int         fps;              // Ziel-Bildrate
+    bool        hmirror;          // TIMING_TC_REG21
+    bool        vflip;            // TIMING_TC_REG20
+    bool        test_pattern;     // Farbbalken (PRE_ISP_TEST_SETTING_1)
+    bool        adaptive;         // Bitraten-Regler an (aus: Größe/Qualität fest)
+    int         bitrate_kbps;     // Bitraten-Ziel pro Client, 0 = nur FPS-Ziel
+    framesize_t snap_frame_size;  // Snapshot-Profil
+    int         snap_quality;
+} camera_ctrl_t;
+esp_err_t camera_set_ctrl(const camera_ctrl_t *c);   // ESP_ERR_INVALID_ARG: Wert außerhalb
+void      camera_get_ctrl(camera_ctrl_t *c);
+
+// HTTP-URI-Handler für /control: GET liefert die Einstellungen als JSON,
+// POST (Formular-Body, z. B. quality=12&vflip=1) ändert und speichert sie
+esp_err_t control_handler(httpd_req_t *req);
+
+// Ziel-Bildrate des Capture-Tasks (1..30 fps)
+void camera_set_target_fps(int fps);
+int  camera_get_target_fps(void);
+
+// Sendedauer eines Frames melden (µs) — Grundlage für das Frame-Pacing
+void camera_report_send_time(int64_t us);
+
+// Socket-Hilfen der Sender-Tasks (/stream, /ws): TCP_NODELAY + Sendepuffer,
+// alle iovecs vollständig schreiben
+struct iovec;
+void      stream_tune_socket(int fd);
+esp_err_t stream_writev_all(int fd, struct iovec *iov, int cnt);
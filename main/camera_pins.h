@@ -14,6 +14,7 @@
 // SCCB (I2C)
 #define SIOD_GPIO_NUM    22  // CAM_SIOD   → GPIO22
 #define SIOC_GPIO_NUM    23  // CAM_SIOC   → GPIO23
+#define SCCB_I2C_PORT     1  // I2C_NUM_1 (ohne driver/i2c.h, siehe ov5640_seq.c)
 
 // Data bits D0–D7
 #define Y2_GPIO_NUM       2  // CAM_DATA1  → GPIO02
@@ -0,0 +1,355 @@
+// clip_store.c — Pre-Event-Puffer für JPEG-Frames in einer festen PSRAM-Arena
+//
+// Die Arena wird einmal beim Start angelegt und als Ringpuffer beschrieben;
+// ein Index im internen RAM hält Lage, Länge und Zeitstempel jedes Frames in
+// Aufnahmereihenfolge. Ein neuer Frame verdrängt die ältesten Einträge, bis
+// er ohne Überlappung hineinpasst; zusätzlich fällt alles heraus, was älter
+// als CLIP_SECONDS ist. Pro Frame gibt es kein malloc.
+//
+// Gespeist wird der Puffer direkt aus dem Capture-Task (clip_store_add).
+// Während eines Downloads oder nach einem Trigger ist er eingefroren: der
+// Capture-Task überspringt dann nur die Kopie und läuft ungebremst weiter.
+// Die Aufnahme ist opt-in (clip_store_arm): solange sie läuft, nimmt die
+// Kamera auch ohne Clients auf und geht nicht in den Leerlauf.
+#include "clip_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "http_server.h"
+#include "task_prof.h"
+#include "wifi.h"
+
+static const char *TAG = "clip";
+
+#define CLIP_ALIGN        4
+#define CLIP_MIN_ARENA    (256 * 1024)   // darunter lohnt der Puffer nicht
+#define CLIP_PART_BOUNDARY "clipframe"
+
+typedef struct {
+    uint32_t off;
+    uint32_t len;
+    int64_t  ts_us;
+    uint16_t width, height;
+} clip_entry_t;
+
+static uint8_t      *s_arena;
+static size_t        s_arena_size;
+static clip_entry_t  s_idx[CLIP_MAX_FRAMES];
+static int           s_first;        // ältester Eintrag
+static int           s_count;
+static size_t        s_bytes;        // belegte Bytes (inkl. Ausrichtung)
+static uint32_t      s_wp;           // Schreibposition in der Arena
+
+static SemaphoreHandle_t s_lock;
+static bool     s_armed;
+static bool     s_frozen;
+static int64_t  s_freeze_at_us;      // ausstehender Trigger, 0 = keiner
+static int      s_downloads;         // laufende /clip-Downloads
+static int64_t  s_last_add_us;
+static uint32_t s_stored, s_evicted, s_skipped;
+
+static inline size_t aligned_len(size_t len)
+{
+    return (len + CLIP_ALIGN - 1) & ~(size_t)(CLIP_ALIGN - 1);
+}
+
+static inline clip_entry_t *entry_at(int i)
+{
+    return &s_idx[(s_first + i) % CLIP_MAX_FRAMES];
+}
+
+static void evict_oldest(void)
+{
+    s_bytes -= aligned_len(s_idx[s_first].len);
+    s_first  = (s_first + 1) % CLIP_MAX_FRAMES;
+    s_count--;
+    s_evicted++;
+}
+
+esp_err_t clip_store_init(void)
+{
+    if (s_arena) return ESP_OK;
+
+    // Ganze Arena auf einmal; bei knappem PSRAM mit der Hälfte vorliebnehmen
+    size_t size = CLIP_ARENA_BYTES;
+    while (size >= CLIP_MIN_ARENA) {
+        s_arena = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_arena) break;
+        size /= 2;
+    }
+    if (!s_arena) {
+        ESP_LOGE(TAG, "no PSRAM for clip arena");
+        return ESP_ERR_NO_MEM;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        heap_caps_free(s_arena);
+        s_arena = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    s_arena_size = size;
+    ESP_LOGI(TAG, "clip arena %u KB, %d s pre-event at max %d fps",
+             (unsigned)(size / 1024), CLIP_SECONDS, CLIP_FPS);
+    return ESP_OK;
+}
+
+bool clip_store_recording(void)
+{
+    return s_arena && s_armed && !s_frozen;
+}
+
+void clip_store_arm(bool on)
+{
+    if (!s_arena) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (on && !s_armed && !s_frozen && !s_downloads) {
+        s_first = s_count = 0;
+        s_bytes = 0;
+        s_wp    = 0;
+        s_last_add_us = 0;
+    }
+    s_armed = on;
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "clip recording %s", on ? "armed" : "off");
+}
+
+void clip_store_add(const camera_fb_t *fb)
+{
+    if (!s_arena || !fb) return;
+    size_t need = aligned_len(fb->len);
+    if (need > s_arena_size) return;
+
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    if (s_freeze_at_us && now >= s_freeze_at_us) {
+        s_frozen       = true;
+        s_freeze_at_us = 0;
+        ESP_LOGI(TAG, "clip frozen: %d frames, %u KB", s_count, (unsigned)(s_bytes / 1024));
+    }
+    if (!s_armed || s_frozen || s_downloads) {
+        xSemaphoreGive(s_lock);
+        return;
+    }
+    if (s_last_add_us && now - s_last_add_us < 1000000LL / CLIP_FPS) {
+        s_skipped++;
+        xSemaphoreGive(s_lock);
+        return;
+    }
+    s_last_add_us = now;
+
+    // Zu alte Frames verwerfen
+    while (s_count && now - entry_at(0)->ts_us > CLIP_SECONDS * 1000000LL) {
+        evict_oldest();
+    }
+    if (s_count == CLIP_MAX_FRAMES) evict_oldest();
+
+    // Passt der Frame nicht mehr bis zum Arena-Ende, vorn weiterschreiben
+    uint32_t off = s_wp;
+    if (off + need > s_arena_size) off = 0;
+
+    // Alles verdrängen, was den Zielbereich überlappt — samt allen älteren
+    // Einträgen, damit der Index in Aufnahmereihenfolge lückenlos bleibt
+    int last = -1;
+    for (int i = 0; i < s_count; i++) {
+        const clip_entry_t *e = entry_at(i);
+        if (e->off < off + need && off < e->off + aligned_len(e->len)) last = i;
+    }
+    while (last-- >= 0) evict_oldest();
+
+    memcpy(s_arena + off, fb->buf, fb->len);
+    clip_entry_t *e = &s_idx[(s_first + s_count) % CLIP_MAX_FRAMES];
+    e->off    = off;
+    e->len    = fb->len;
+    e->ts_us  = now;
+    e->width  = fb->width;
+    e->height = fb->height;
+    s_count++;
+    s_bytes += need;
+    s_wp     = off + need;
+    s_stored++;
+
+    xSemaphoreGive(s_lock);
+}
+
+void clip_store_trigger(uint32_t post_ms)
+{
+    if (!s_arena) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (!s_frozen) {
+        if (post_ms) {
+            s_freeze_at_us = esp_timer_get_time() + (int64_t)post_ms * 1000;
+        } else {
+            s_frozen       = true;
+            s_freeze_at_us = 0;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "clip trigger (post %lu ms)", (unsigned long)post_ms);
+}
+
+void clip_store_release(void)
+{
+    if (!s_arena) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_frozen       = false;
+    s_freeze_at_us = 0;
+    s_last_add_us  = 0;
+    xSemaphoreGive(s_lock);
+}
+
+void clip_store_get_status(clip_status_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    if (!s_arena) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    st->armed           = s_armed;
+    st->frozen          = s_frozen;
+    st->trigger_pending = s_freeze_at_us != 0;
+    st->frames          = s_count;
+    st->bytes           = s_bytes;
+    st->oldest_us       = s_count ? entry_at(0)->ts_us : 0;
+    st->newest_us       = s_count ? entry_at(s_count - 1)->ts_us : 0;
+    st->stored          = s_stored;
+    st->evicted         = s_evicted;
+    st->skipped         = s_skipped;
+    xSemaphoreGive(s_lock);
+}
+
+// ---------------------------------------------------------------------------
+// HTTP
+// ---------------------------------------------------------------------------
+static esp_err_t send_status(httpd_req_t *req)
+{
+    clip_status_t st;
+    clip_store_get_status(&st);
+    char buf[320];
+    snprintf(buf, sizeof(buf),
+             "{\"armed\":%s,\"frozen\":%s,\"trigger_pending\":%s,\"frames\":%d,\"bytes\":%u,"
+             "\"span_ms\":%lld,\"arena\":%u,\"stored\":%lu,\"evicted\":%lu,\"skipped\":%lu}",
+             st.armed ? "true" : "false", st.frozen ? "true" : "false",
+             st.trigger_pending ? "true" : "false",
+             st.frames, (unsigned)st.bytes,
+             (long long)((st.newest_us - st.oldest_us) / 1000), (unsigned)s_arena_size,
+             (unsigned long)st.stored, (unsigned long)st.evicted,
+             (unsigned long)st.skipped);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, buf);
+}
+
+// Sender-Task: eingefrorenes Fenster als multipart/x-mixed-replace (MJPEG)
+// über den asynchronen Request senden. Solange s_downloads > 0 schreibt der
+// Capture-Task nicht in die Arena, die Frame-Daten werden daher ohne Lock
+// direkt aus dem PSRAM gesendet.
+static void clip_send_task(void *arg)
+{
+    httpd_req_t *req = arg;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int count = s_count;
+    int64_t t0 = count ? entry_at(0)->ts_us : 0;
+    xSemaphoreGive(s_lock);
+    wifi_link_acquire();
+
+    httpd_resp_set_type(req, "multipart/x-mixed-replace;boundary=" CLIP_PART_BOUNDARY);
+    httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=\"clip.mjpeg\"");
+    char frames[12], hdr[160];
+    snprintf(frames, sizeof(frames), "%d", count);
+    httpd_resp_set_hdr(req, "X-Clip-Frames", frames);
+
+    esp_err_t res = ESP_OK;
+    for (int i = 0; i < count && res == ESP_OK; i++) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        clip_entry_t e = *entry_at(i);
+        xSemaphoreGive(s_lock);
+
+        int n = snprintf(hdr, sizeof(hdr),
+                         "\r\n--" CLIP_PART_BOUNDARY "\r\n"
+                         "Content-Type: image/jpeg\r\n"
+                         "Content-Length: %u\r\n"
+                         "X-Clip-Offset-Ms: %lld\r\n\r\n",
+                         (unsigned)e.len, (long long)((e.ts_us - t0) / 1000));
+        res = httpd_resp_send_chunk(req, hdr, n);
+        if (res == ESP_OK) {
+            res = httpd_resp_send_chunk(req, (const char *)s_arena + e.off, e.len);
+        }
+    }
+    if (res == ESP_OK) {
+        static const char tail[] = "\r\n--" CLIP_PART_BOUNDARY "--\r\n";
+        httpd_resp_send_chunk(req, tail, sizeof(tail) - 1);
+        res = httpd_resp_send_chunk(req, NULL, 0);
+    }
+
+    wifi_link_release();
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_downloads--;
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "clip sent: %d frames (%s)", count, res == ESP_OK ? "ok" : "aborted");
+
+    // Abgebrochene Antwort ist nicht httpd-konform beendet → Session schließen
+    http_async_done(req, res != ESP_OK);
+    vTaskDelete(NULL);
+}
+
+// Download an den Sender-Task übergeben; der httpd-Worker ist sofort frei
+static esp_err_t send_clip(httpd_req_t *req)
+{
+    httpd_req_t *areq;
+    if (httpd_req_async_handler_begin(req, &areq) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "async begin fail");
+    }
+    http_async_claim(areq);
+    // Einfrieren schon hier, damit kein Frame zwischen Handler und Task hineinrutscht
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_downloads++;
+    xSemaphoreGive(s_lock);
+    if (task_create(TASK_CLIP_SEND, clip_send_task, areq, NULL) != pdPASS) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_downloads--;
+        xSemaphoreGive(s_lock);
+        httpd_resp_send_err(areq, HTTPD_500_INTERNAL_SERVER_ERROR, "clip task create fail");
+        http_async_done(areq, false);
+    }
+    return ESP_OK;
+}
+
+esp_err_t clip_handler(httpd_req_t *req)
+{
+    if (!s_arena) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "clip store unavailable");
+    }
+
+    char query[96];
+    char val[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "arm", val, sizeof(val)) == ESP_OK) {
+            clip_store_arm(atoi(val) != 0);
+            return send_status(req);
+        }
+        if (httpd_query_key_value(query, "trigger", val, sizeof(val)) == ESP_OK && atoi(val)) {
+            uint32_t post_ms = 0;
+            if (httpd_query_key_value(query, "post", val, sizeof(val)) == ESP_OK) {
+                int v = atoi(val);
+                if (v > 0) post_ms = v > CLIP_SECONDS * 1000 ? CLIP_SECONDS * 1000 : v;
+            }
+            clip_store_trigger(post_ms);
+            return send_status(req);
+        }
+        if (httpd_query_key_value(query, "release", val, sizeof(val)) == ESP_OK && atoi(val)) {
+            clip_store_release();
+            return send_status(req);
+        }
+        if (httpd_query_key_value(query, "info", val, sizeof(val)) == ESP_OK && atoi(val)) {
+            return send_status(req);
+        }
+    }
+
+    // Ohne Trigger friert der Download selbst das aktuelle Fenster ein;
+    // danach läuft die Aufnahme automatisch weiter
+    return send_clip(req);
+}
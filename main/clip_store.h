@@ -0,0 +1,50 @@
+// clip_store.h — Pre-Event-Puffer: die letzten Sekunden JPEG-Frames im PSRAM
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "esp_http_server.h"
+
+#define CLIP_ARENA_BYTES   (1536 * 1024)  // fester Byte-Rahmen im PSRAM
+#define CLIP_MAX_FRAMES    256            // Index-Einträge
+#define CLIP_SECONDS       5              // älter wird verworfen
+#define CLIP_FPS           8              // max. gespeicherte Frames pro Sekunde
+
+typedef struct {
+    bool     armed;
+    bool     frozen;
+    bool     trigger_pending;
+    int      frames;
+    size_t   bytes;
+    int64_t  oldest_us, newest_us;   // esp_timer-Zeit der Frames
+    uint32_t stored, evicted, skipped;
+} clip_status_t;
+
+// Arena einmalig anlegen (vor dem Capture-Task)
+esp_err_t clip_store_init(void);
+
+// Frame aus dem Capture-Pfad kopieren. Kein malloc; ältere Frames werden
+// verdrängt. Im eingefrorenen Zustand wird nichts gespeichert.
+void clip_store_add(const camera_fb_t *fb);
+
+// true, solange der Puffer aufnimmt — hält den Capture-Task auch ohne
+// Stream-Clients am Laufen
+bool clip_store_recording(void);
+
+// Aufnahme ein-/ausschalten (Standard aus, /clip?arm=1). Beim Einschalten
+// wird ein nicht eingefrorenes altes Fenster verworfen.
+void clip_store_arm(bool on);
+
+// Fenster einfrieren, optional erst nach post_ms weiterer Aufnahme
+void clip_store_trigger(uint32_t post_ms);
+
+// Aufnahme fortsetzen (wirkt erst, wenn kein Download mehr läuft)
+void clip_store_release(void);
+
+void clip_store_get_status(clip_status_t *st);
+
+// HTTP-URI-Handler: /clip (MJPEG-Download), ?arm=0|1, ?trigger=1[&post=ms],
+// ?release=1, ?info=1
+esp_err_t clip_handler(httpd_req_t *req);
@@ -0,0 +1,196 @@
+// frame_ring.c — referenzgezählter Frame-Ring zwischen Capture-Task und Stream-Clients
+#include "frame_ring.h"
+#include <string.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "frame_ring";
+
+// Puffer wachsen in 16-KB-Schritten, damit nicht jeder größere Frame reallokiert
+#define FRAME_BUF_ALIGN   (16 * 1024)
+
+typedef struct {
+    frame_t frame;     // muss erstes Element sein (Cast in frame_ring_release)
+    size_t  cap;
+    int     refs;
+    bool    writing;
+} frame_slot_t;
+
+struct frame_reader {
+    bool              used;
+    SemaphoreHandle_t ready;     // wird bei jedem neuen Frame gegeben
+    uint32_t          last_seq;
+    uint32_t          dropped;
+};
+
+static frame_slot_t      s_slots[FRAME_RING_SLOTS];
+static frame_reader_t    s_readers[FRAME_RING_MAX_READERS];
+static SemaphoreHandle_t s_lock;
+static int               s_newest = -1;
+static uint32_t          s_seq;
+static uint32_t          s_publish_dropped;
+
+// Bevorzugt PSRAM, sonst interner Heap
+static void *frame_buf_realloc(void *old, size_t size)
+{
+    void *p = heap_caps_realloc(old, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p) {
+        p = heap_caps_realloc(old, size, MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+esp_err_t frame_ring_init(void)
+{
+    if (s_lock) return ESP_OK;
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) return ESP_ERR_NO_MEM;
+    for (int i = 0; i < FRAME_RING_MAX_READERS; i++) {
+        s_readers[i].ready = xSemaphoreCreateBinary();
+        if (!s_readers[i].ready) return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "frame ring: %d slots, %d readers",
+             FRAME_RING_SLOTS, FRAME_RING_MAX_READERS);
+    return ESP_OK;
+}
+
+esp_err_t frame_ring_publish(const camera_fb_t *fb)
+{
+    // 1) Freien Slot reservieren: unreferenziert, nicht der neueste; ältester
+    //    allozierter zuerst, ein leerer Slot nur, wenn keiner frei ist
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int idx = -1;
+    for (int i = 0; i < FRAME_RING_SLOTS; i++) {
+        frame_slot_t *sl = &s_slots[i];
+        if (sl->refs || sl->writing || i == s_newest) continue;
+        if (idx < 0) {
+            idx = i;
+        } else if (!sl->cap != !s_slots[idx].cap) {
+            if (sl->cap) idx = i;
+        } else if (sl->frame.seq < s_slots[idx].frame.seq) {
+            idx = i;
+        }
+    }
+    if (idx < 0) {
+        s_publish_dropped++;
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    frame_slot_t *slot = &s_slots[idx];
+    slot->writing = true;
+    xSemaphoreGive(s_lock);
+
+    // 2) Kopieren ohne Lock — der Slot gehört jetzt exklusiv dem Producer
+    esp_err_t err = ESP_OK;
+    if (fb->len > slot->cap) {
+        size_t cap = (fb->len + FRAME_BUF_ALIGN - 1) & ~(size_t)(FRAME_BUF_ALIGN - 1);
+        uint8_t *buf = frame_buf_realloc(slot->frame.buf, cap);
+        if (buf) {
+            slot->frame.buf = buf;
+            slot->cap       = cap;
+        } else {
+            ESP_LOGW(TAG, "no memory for %u byte frame", (unsigned)fb->len);
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    if (err == ESP_OK) {
+        memcpy(slot->frame.buf, fb->buf, fb->len);
+    }
+
+    // 3) Veröffentlichen und alle Leser wecken
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    slot->writing = false;
+    if (err == ESP_OK) {
+        slot->frame.len          = fb->len;
+        slot->frame.width        = fb->width;
+        slot->frame.height       = fb->height;
+        slot->frame.timestamp_us = (int64_t)fb->timestamp.tv_sec * 1000000LL
+                                 + fb->timestamp.tv_usec;
+        slot->frame.seq          = ++s_seq;
+        slot->frame.publish_us   = esp_timer_get_time();
+        s_newest = idx;
+        for (int i = 0; i < FRAME_RING_MAX_READERS; i++) {
+            if (s_readers[i].used) xSemaphoreGive(s_readers[i].ready);
+        }
+    } else {
+        s_publish_dropped++;
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+int frame_ring_reader_count(void)
+{
+    int n = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < FRAME_RING_MAX_READERS; i++) {
+        if (s_readers[i].used) n++;
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+frame_reader_t *frame_ring_reader_open(void)
+{
+    frame_reader_t *rd = NULL;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < FRAME_RING_MAX_READERS; i++) {
+        if (!s_readers[i].used) {
+            rd = &s_readers[i];
+            rd->used     = true;
+            rd->last_seq = 0;
+            rd->dropped  = 0;
+            xSemaphoreTake(rd->ready, 0);   // altes Signal verwerfen
+            break;
+        }
+    }
+    xSemaphoreGive(s_lock);
+    if (!rd) ESP_LOGW(TAG, "all %d readers in use", FRAME_RING_MAX_READERS);
+    return rd;
+}
+
+void frame_ring_reader_close(frame_reader_t *rd)
+{
+    if (!rd) return;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    rd->used = false;
+    xSemaphoreGive(s_lock);
+}
+
+const frame_t *frame_ring_next(frame_reader_t *rd, TickType_t timeout)
+{
+    while (1) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (s_newest >= 0 && s_slots[s_newest].frame.seq != rd->last_seq) {
+            frame_slot_t *slot = &s_slots[s_newest];
+            slot->refs++;
+            if (rd->last_seq) {
+                rd->dropped += slot->frame.seq - rd->last_seq - 1;
+            }
+            rd->last_seq = slot->frame.seq;
+            xSemaphoreGive(s_lock);
+            return &slot->frame;
+        }
+        xSemaphoreGive(s_lock);
+        if (xSemaphoreTake(rd->ready, timeout) != pdTRUE) {
+            return NULL;
+        }
+    }
+}
+
+void frame_ring_release(const frame_t *frame)
+{
+    if (!frame) return;
+    frame_slot_t *slot = (frame_slot_t *)frame;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (slot->refs > 0) slot->refs--;
+    xSemaphoreGive(s_lock);
+}
+
+uint32_t frame_ring_reader_dropped(const frame_reader_t *rd)
+{
+    return rd ? rd->dropped : 0;
+}
@@ -0,0 +1,52 @@
+// frame_ring.h — Ringpuffer für JPEG-Frames: ein Capture-Task schreibt, viele Clients lesen
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "freertos/FreeRTOS.h"
+
+#define FRAME_RING_MAX_READERS  8   // max. gleichzeitige Leser
+// Frame-Slots im Ring (PSRAM). Jeder Leser hält höchstens einen Frame; mit
+// dem neuesten und einem freien Slot findet der Producer immer Platz, auch
+// wenn jeder Leser auf einem anderen alten Frame steht.
+#define FRAME_RING_SLOTS        (FRAME_RING_MAX_READERS + 2)
+
+// Ein veröffentlichter Frame. Gehört dem Ring; Leser halten ihn per Referenz.
+typedef struct {
+    uint8_t  *buf;
+    size_t    len;
+    uint16_t  width;
+    uint16_t  height;
+    uint32_t  seq;           // fortlaufende Frame-Nummer (ab 1)
+    int64_t   timestamp_us;  // Aufnahmezeit laut Treiber (esp_timer-Basis)
+    int64_t   publish_us;    // im Ring veröffentlicht (esp_timer)
+} frame_t;
+
+typedef struct frame_reader frame_reader_t;
+
+// Slots und Leser anlegen (einmalig vor dem Capture-Task)
+esp_err_t frame_ring_init(void);
+
+// Frame in einen freien Slot kopieren und als neuesten veröffentlichen.
+// Bereits allozierte Slots werden bevorzugt, weitere Puffer entstehen erst,
+// wenn Leser die vorhandenen festhalten. ESP_ERR_NO_MEM nur, wenn der Puffer
+// nicht wachsen kann — der Aufrufer wartet nie auf langsame Leser.
+esp_err_t frame_ring_publish(const camera_fb_t *fb);
+
+// Anzahl aktuell angemeldeter Leser
+int frame_ring_reader_count(void);
+
+// Leser an-/abmelden (NULL, wenn alle Plätze belegt sind)
+frame_reader_t *frame_ring_reader_open(void);
+void frame_ring_reader_close(frame_reader_t *rd);
+
+// Neuesten, für diesen Leser noch ungesehenen Frame holen (Referenz +1).
+// Dazwischen liegende Frames werden übersprungen. NULL bei Timeout.
+const frame_t *frame_ring_next(frame_reader_t *rd, TickType_t timeout);
+
+// Referenz aus frame_ring_next() zurückgeben
+void frame_ring_release(const frame_t *frame);
+
+// Vom Leser übersprungene Frames seit dem Öffnen
+uint32_t frame_ring_reader_dropped(const frame_reader_t *rd);
@@ -2,10 +2,27 @@
 #include "esp_http_server.h"
 #include "esp_camera.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 #include "camera.h"
+#include "motion.h"
+#include "clip_store.h"
+#include "metrics.h"
+#include "task_prof.h"
+#include "ws_stream.h"
+#include "wifi.h"
+#include "lwip/sockets.h"
 
 static const char *TAG = "http";
 
+// Server-Limits. Streams laufen in eigenen Tasks, belegen aber je einen
+// Socket; max. offene Sockets <= CONFIG_LWIP_MAX_SOCKETS - 3 (httpd intern).
+#define HTTPD_MAX_OPEN_SOCKETS  13
+#define HTTPD_MAX_URI_HANDLERS  16
+#define HTTPD_BACKLOG_CONN      8
+#define HTTPD_LRU_PURGE         true   // ältesten Socket schließen, wenn voll
+#define HTTPD_SLOW_REQUEST_MS   200    // langsamere Requests als Warnung loggen
+
 // HTML-Indexseite
 static const char index_html[] = R"rawliteral(
 <!DOCTYPE html>
@@ -18,8 +35,32 @@ static const char index_html[] = R"rawliteral(
     <h1>ESP32-CAM</h1>
     <button onclick="fetch('/snapshot').then(r=>r.blob()).then(b=>{document.getElementById('img').src=URL.createObjectURL(b)})">Snapshot</button>
     <button onclick="document.getElementById('img').src='/stream'">Live-Stream</button>
+    <button onclick="wsStream()">WebSocket</button>
+    <span id="lat"></span>
     <br><br>
     <img id="img" width="640"/>
+    <script>
+      // /ws: 24-Byte-Kopf (seq, len, capture_us, send_us) + JPEG; jede
+      // Nachricht mit ihrer seq quittieren, sonst hält das Gerät an
+      function wsStream() {
+        const ws = new WebSocket('ws://' + location.host + '/ws');
+        ws.binaryType = 'arraybuffer';
+        let t0 = 0;
+        ws.onmessage = ev => {
+          const v = new DataView(ev.data);
+          const seq = v.getUint32(0, true);
+          const age = Number(v.getBigUint64(16, true) - v.getBigUint64(8, true)) / 1000;
+          const img = document.getElementById('img');
+          URL.revokeObjectURL(img.src);
+          img.src = URL.createObjectURL(new Blob([ev.data.slice(24)], {type: 'image/jpeg'}));
+          ws.send(String(seq));
+          const now = performance.now();
+          document.getElementById('lat').textContent =
+            `#${seq} capture→send ${age.toFixed(1)} ms, ${t0 ? (1000 / (now - t0)).toFixed(1) : '-'} fps`;
+          t0 = now;
+        };
+      }
+    </script>
   </body>
 </html>
 )rawliteral";
@@ -31,9 +72,110 @@ static esp_err_t index_handler(httpd_req_t *req)
     return httpd_resp_send(req, index_html, HTTPD_RESP_USE_STRLEN);
 }
 
+// Misst die Bearbeitungszeit jedes Requests (Handler steht in user_ctx).
+// Bei /stream ist das nur die Übergabe an den Sender-Task.
+static esp_err_t timed_handler(httpd_req_t *req)
+{
+    esp_err_t (*handler)(httpd_req_t *) = req->user_ctx;
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = handler(req);
+    int64_t us = esp_timer_get_time() - t0;
+    int64_t ms = us / 1000;
+    metrics_observe(MET_H_HTTP_US, (uint32_t)us);
+    metrics_add(MET_C_HTTP_REQUESTS, 1);
+    if (ms >= HTTPD_SLOW_REQUEST_MS) {
+        ESP_LOGW(TAG, "%s took %lld ms", req->uri, (long long)ms);
+    } else {
+        ESP_LOGD(TAG, "%s took %lld ms", req->uri, (long long)ms);
+    }
+    return err;
+}
+
+// -----------------------------------------------------------------------------
+// Sockets asynchroner Sender
+//   Session-Ende (auch LRU-Purge) darf einen Socket, auf dem ein Sender-Task
+//   noch schreibt, nicht schließen: lwIP vergäbe die fd-Nummer sofort neu und
+//   der Sender schriebe in fremde Verbindungen. close_fn macht deshalb nur
+//   shutdown() (writev kehrt mit Fehler zurück), close() folgt im Sender.
+// -----------------------------------------------------------------------------
+typedef struct {
+    int  fd;                    // -1 = frei
+    bool gone;                  // Session vom Server bereits entfernt
+} async_sess_t;
+
+static async_sess_t s_async[HTTPD_MAX_OPEN_SOCKETS] = {
+    [0 ... HTTPD_MAX_OPEN_SOCKETS - 1] = { .fd = -1 }
+};
+static portMUX_TYPE s_async_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static async_sess_t *async_find(int fd)
+{
+    for (int i = 0; i < HTTPD_MAX_OPEN_SOCKETS; i++) {
+        if (s_async[i].fd == fd) return &s_async[i];
+    }
+    return NULL;
+}
+
+void http_async_claim(httpd_req_t *areq)
+{
+    int fd = httpd_req_to_sockfd(areq);
+    portENTER_CRITICAL(&s_async_mux);
+    async_sess_t *a = async_find(fd);
+    if (!a) a = async_find(-1);
+    if (a) *a = (async_sess_t){ .fd = fd };
+    portEXIT_CRITICAL(&s_async_mux);
+    if (!a) ESP_LOGE(TAG, "no async slot for fd %d", fd);
+}
+
+void http_async_done(httpd_req_t *areq, bool close_sess)
+{
+    httpd_handle_t hd = areq->handle;
+    int fd = httpd_req_to_sockfd(areq);
+    httpd_req_async_handler_complete(areq);
+    portENTER_CRITICAL(&s_async_mux);
+    async_sess_t *a = async_find(fd);
+    bool gone = a && a->gone;
+    if (a) a->fd = -1;
+    portEXIT_CRITICAL(&s_async_mux);
+    if (gone) {
+        close(fd);
+    } else if (close_sess) {
+        httpd_sess_trigger_close(hd, fd);    // close_fn findet den Sender nicht mehr
+    }
+}
+
+// true: ein Sender hält den Socket, er ist nur per shutdown() beendet
+static bool async_sess_closed(int fd)
+{
+    portENTER_CRITICAL(&s_async_mux);
+    async_sess_t *a = async_find(fd);
+    if (a) a->gone = true;
+    portEXIT_CRITICAL(&s_async_mux);
+    if (!a) return false;
+    shutdown(fd, SHUT_RDWR);
+    return true;
+}
+
+// Session-Ende (auch LRU-Purge): Sockets laufender Sender (WebSocket und
+// asynchrone Requests) schließt der Sender selbst, sobald er nicht mehr schreibt
+static void sess_close(httpd_handle_t hd, int fd)
+{
+    if (ws_stream_sess_closed(fd) || async_sess_closed(fd)) return;
+    close(fd);
+}
+
 esp_err_t start_webserver(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_open_sockets = HTTPD_MAX_OPEN_SOCKETS;
+    config.max_uri_handlers = HTTPD_MAX_URI_HANDLERS;
+    config.backlog_conn     = HTTPD_BACKLOG_CONN;
+    config.lru_purge_enable = HTTPD_LRU_PURGE;
+    config.close_fn         = sess_close;
+    const task_place_t *tp  = task_place(TASK_HTTPD);
+    config.stack_size       = tp->stack;
+    config.task_priority    = tp->prio;
+    config.core_id          = tp->core;
     httpd_handle_t server = NULL;
     esp_err_t err = httpd_start(&server, &config);
     if (err != ESP_OK) {
@@ -44,11 +186,29 @@ esp_err_t start_webserver(void)
     httpd_uri_t uris[] = {
         { .uri = "/",         .method = HTTP_GET, .handler = index_handler },
         { .uri = "/snapshot", .method = HTTP_GET, .handler = snapshot_handler },
+        { .uri = "/burst",    .method = HTTP_GET, .handler = burst_handler },
         { .uri = "/stream",   .method = HTTP_GET, .handler = stream_handler },
+        { .uri = "/thumb",    .method = HTTP_GET, .handler = thumb_handler },
+        { .uri = "/control",  .method = HTTP_GET,  .handler = control_handler },
+        { .uri = "/control",  .method = HTTP_POST, .handler = control_handler },
+        { .uri = "/wifi",     .method = HTTP_GET,  .handler = wifi_handler },
+        { .uri = "/wifi",     .method = HTTP_POST, .handler = wifi_handler },
+        { .uri = "/motion",   .method = HTTP_GET, .handler = motion_handler },
+        { .uri = "/clip",     .method = HTTP_GET, .handler = clip_handler },
+        { .uri = "/metrics",  .method = HTTP_GET, .handler = metrics_handler },
+        { .uri = "/debug/tasks", .method = HTTP_GET, .handler = task_prof_handler },
+        { .uri = "/ws",       .method = HTTP_GET, .handler = ws_handler,
+          .is_websocket = true, .handle_ws_control_frames = true },
     };
     for (int i = 0; i < sizeof(uris)/sizeof(uris[0]); i++) {
+        // WebSocket-Handler laufen pro eingehender Nachricht — nicht als Request zählen
+        if (!uris[i].is_websocket) {
+            uris[i].user_ctx = uris[i].handler;
+            uris[i].handler  = timed_handler;
+        }
         httpd_register_uri_handler(server, &uris[i]);
     }
-    ESP_LOGI(TAG, "HTTP Server started");
+    ESP_LOGI(TAG, "HTTP Server started (%d sockets, LRU purge %s)",
+             config.max_open_sockets, config.lru_purge_enable ? "on" : "off");
     return ESP_OK;
 }
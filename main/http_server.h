@@ -1,6 +1,20 @@
 // main/http_server.h
 #pragma once
+#include <stdbool.h>
 #include "esp_err.h"
+#include "esp_http_server.h"
 
 // Startet den HTTP-Server und registriert alle URIs
 esp_err_t start_webserver(void);
+
+// Asynchrone Sender (stream, snapshot, burst, clip): nach
+// httpd_req_async_handler_begin() noch im Handler anmelden. Schließt der
+// Server die Session vorher (LRU-Purge, Client weg), beendet close_fn den
+// Socket nur per shutdown() — die fd-Nummer bleibt belegt, bis der Sender
+// fertig ist.
+void http_async_claim(httpd_req_t *areq);
+
+// Ersetzt httpd_req_async_handler_complete() im Sender: Request freigeben,
+// dann Socket schließen, falls die Session schon weg ist, sonst mit
+// close_sess die Session beenden (Antwort nicht httpd-konform abgeschlossen).
+void http_async_done(httpd_req_t *areq, bool close_sess);
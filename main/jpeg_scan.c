@@ -0,0 +1,419 @@
+// jpeg_scan.c — Huffman-Dekodierung baseline JPEG bis auf Koeffizientenebene
+#include "jpeg_scan.h"
+#include <string.h>
+#include <stdbool.h>
+
+// Standard-Huffman-Tabellen (ITU T.81 Annex K.3)
+static const uint8_t k_dc_lum_bits[16] = { 0,1,5,1,1,1,1,1,1,0,0,0,0,0,0,0 };
+static const uint8_t k_dc_chr_bits[16] = { 0,3,1,1,1,1,1,1,1,1,1,0,0,0,0,0 };
+static const uint8_t k_dc_vals[12]     = { 0,1,2,3,4,5,6,7,8,9,10,11 };
+static const uint8_t k_ac_lum_bits[16] = { 0,2,1,3,3,2,4,3,5,5,4,4,0,0,1,0x7d };
+static const uint8_t k_ac_lum_vals[162] = {
+    0x01,0x02,0x03,0x00,0x04,0x11,0x05,0x12,0x21,0x31,0x41,0x06,0x13,0x51,0x61,0x07,
+    0x22,0x71,0x14,0x32,0x81,0x91,0xa1,0x08,0x23,0x42,0xb1,0xc1,0x15,0x52,0xd1,0xf0,
+    0x24,0x33,0x62,0x72,0x82,0x09,0x0a,0x16,0x17,0x18,0x19,0x1a,0x25,0x26,0x27,0x28,
+    0x29,0x2a,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,0x49,
+    0x4a,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x63,0x64,0x65,0x66,0x67,0x68,0x69,
+    0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x83,0x84,0x85,0x86,0x87,0x88,0x89,
+    0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,
+    0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xc2,0xc3,0xc4,0xc5,
+    0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xe1,0xe2,
+    0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,
+    0xf9,0xfa,
+};
+static const uint8_t k_ac_chr_bits[16] = { 0,2,1,2,4,4,3,4,7,5,4,4,0,1,2,0x77 };
+static const uint8_t k_ac_chr_vals[162] = {
+    0x00,0x01,0x02,0x03,0x11,0x04,0x05,0x21,0x31,0x06,0x12,0x41,0x51,0x07,0x61,0x71,
+    0x13,0x22,0x32,0x81,0x08,0x14,0x42,0x91,0xa1,0xb1,0xc1,0x09,0x23,0x33,0x52,0xf0,
+    0x15,0x62,0x72,0xd1,0x0a,0x16,0x24,0x34,0xe1,0x25,0xf1,0x17,0x18,0x19,0x1a,0x26,
+    0x27,0x28,0x29,0x2a,0x35,0x36,0x37,0x38,0x39,0x3a,0x43,0x44,0x45,0x46,0x47,0x48,
+    0x49,0x4a,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x63,0x64,0x65,0x66,0x67,0x68,
+    0x69,0x6a,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x82,0x83,0x84,0x85,0x86,0x87,
+    0x88,0x89,0x8a,0x92,0x93,0x94,0x95,0x96,0x97,0x98,0x99,0x9a,0xa2,0xa3,0xa4,0xa5,
+    0xa6,0xa7,0xa8,0xa9,0xaa,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xc2,0xc3,
+    0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,
+    0xe2,0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,
+    0xf9,0xfa,
+};
+
+const jpeg_std_huff_t jpeg_std_huff[4] = {
+    [JPEG_STD_DC_LUM] = { k_dc_lum_bits, k_dc_vals,     12 },
+    [JPEG_STD_DC_CHR] = { k_dc_chr_bits, k_dc_vals,     12 },
+    [JPEG_STD_AC_LUM] = { k_ac_lum_bits, k_ac_lum_vals, 162 },
+    [JPEG_STD_AC_CHR] = { k_ac_chr_bits, k_ac_chr_vals, 162 },
+};
+
+// ---------------------------------------------------------------------------
+// Huffman-Tabellen
+// ---------------------------------------------------------------------------
+static esp_err_t huff_build(jpeg_huff_t *h, const uint8_t bits[16],
+                            const uint8_t *vals, int nvals)
+{
+    int total = 0;
+    for (int i = 0; i < 16; i++) total += bits[i];
+    if (total > 256 || total > nvals) return ESP_ERR_INVALID_SIZE;
+
+    memset(h->lookup, 0, sizeof(h->lookup));
+    memcpy(h->vals, vals, total);
+
+    int32_t code = 0;
+    int k = 0;
+    for (int l = 1; l <= 16; l++) {
+        h->valoff[l] = k - code;
+        for (int i = 0; i < bits[l - 1]; i++, k++, code++) {
+            if (l <= JPEG_HUFF_LOOKAHEAD) {
+                int shift = JPEG_HUFF_LOOKAHEAD - l;
+                int base  = code << shift;
+                for (int j = 0; j < (1 << shift); j++) {
+                    h->lookup[base + j] = (uint16_t)((l << 8) | h->vals[k]);
+                }
+            }
+        }
+        h->maxcode[l] = bits[l - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    h->maxcode[17] = INT32_MAX;
+    h->present = 1;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Bit-Leser: MSB-bündiger 32-Bit-Puffer, entfernt FF00-Stuffing und speist
+// an Markern Nullen ein
+// ---------------------------------------------------------------------------
+typedef struct {
+    const uint8_t *p, *end;
+    uint32_t buf;
+    int      bits;
+    int      fake;      // eingespeiste Null-Bits hinter dem Datenende
+    bool     marker;
+} bitrd_t;
+
+static inline void br_fill(bitrd_t *b)
+{
+    while (b->bits <= 24) {
+        uint32_t c = 0;
+        if (b->marker || b->p >= b->end) {
+            b->fake += 8;
+        } else {
+            c = *b->p;
+            if (c == 0xFF) {
+                if (b->p + 1 < b->end && b->p[1] == 0x00) {
+                    b->p += 2;
+                } else {
+                    b->marker = true;   // Marker nicht verbrauchen
+                    c = 0;
+                }
+            } else {
+                b->p++;
+            }
+        }
+        b->buf  |= c << (24 - b->bits);
+        b->bits += 8;
+    }
+}
+
+static inline int br_get(bitrd_t *b, int n)
+{
+    if (!n) return 0;
+    br_fill(b);
+    int v = b->buf >> (32 - n);
+    b->buf <<= n;
+    b->bits -= n;
+    return v;
+}
+
+static inline int extend(int v, int n)
+{
+    return v < (1 << (n - 1)) ? v - (1 << n) + 1 : v;
+}
+
+static inline int huff_decode(bitrd_t *b, const jpeg_huff_t *h)
+{
+    br_fill(b);
+    uint16_t e = h->lookup[b->buf >> (32 - JPEG_HUFF_LOOKAHEAD)];
+    if (e) {
+        int l = e >> 8;
+        b->buf <<= l;
+        b->bits -= l;
+        return e & 0xFF;
+    }
+    int l = JPEG_HUFF_LOOKAHEAD + 1;
+    int32_t code = b->buf >> (32 - l);
+    while (code > h->maxcode[l]) {
+        l++;
+        if (l > 16) return -1;
+        code = b->buf >> (32 - l);
+    }
+    b->buf <<= l;
+    b->bits -= l;
+    return h->vals[code + h->valoff[l]];
+}
+
+// ---------------------------------------------------------------------------
+// Header
+// ---------------------------------------------------------------------------
+static inline uint16_t be16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static esp_err_t parse_dqt(jpeg_info_t *in, const uint8_t *p, size_t n)
+{
+    while (n > 0) {
+        int pq = p[0] >> 4, tq = p[0] & 0x0F;
+        size_t need = 1 + (pq ? 128 : 64);
+        if (tq > 3 || n < need) return ESP_ERR_INVALID_SIZE;
+        for (int i = 0; i < 64; i++) {
+            in->qt[tq][i] = pq ? be16(p + 1 + 2 * i) : p[1 + i];
+        }
+        in->qt_present |= 1 << tq;
+        p += need;
+        n -= need;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_dht(jpeg_dec_t *d, const uint8_t *p, size_t n)
+{
+    while (n >= 17) {
+        int tc = p[0] >> 4, th = p[0] & 0x0F;
+        if (tc > 1 || th > 3) return ESP_ERR_INVALID_ARG;
+        int total = 0;
+        for (int i = 0; i < 16; i++) total += p[1 + i];
+        if (n < (size_t)(17 + total)) return ESP_ERR_INVALID_SIZE;
+        esp_err_t err = huff_build(tc ? &d->ac[th] : &d->dc[th], p + 1, p + 17, total);
+        if (err != ESP_OK) return err;
+        p += 17 + total;
+        n -= 17 + total;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_sof(jpeg_info_t *in, const uint8_t *p, size_t n)
+{
+    if (n < 6 || p[0] != 8) return ESP_ERR_NOT_SUPPORTED;   // nur 8 Bit
+    in->height = be16(p + 1);
+    in->width  = be16(p + 3);
+    in->ncomp  = p[5];
+    if (!in->width || !in->height || in->ncomp == 0 || in->ncomp > JPEG_MAX_COMP ||
+        n < 6 + 3u * in->ncomp) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    in->hmax = in->vmax = 1;
+    for (int i = 0; i < in->ncomp; i++) {
+        jpeg_comp_t *c = &in->comp[i];
+        c->id = p[6 + 3 * i];
+        c->h  = p[7 + 3 * i] >> 4;
+        c->v  = p[7 + 3 * i] & 0x0F;
+        c->tq = p[8 + 3 * i] & 0x03;
+        if (!c->h || !c->v || c->h > 4 || c->v > 4) return ESP_ERR_NOT_SUPPORTED;
+        if (c->h > in->hmax) in->hmax = c->h;
+        if (c->v > in->vmax) in->vmax = c->v;
+    }
+    if (in->ncomp == 1) {
+        // Einzelkomponente: MCU = ein Block
+        in->comp[0].h = in->comp[0].v = in->hmax = in->vmax = 1;
+    }
+    in->mcux = (in->width  + 8 * in->hmax - 1) / (8 * in->hmax);
+    in->mcuy = (in->height + 8 * in->vmax - 1) / (8 * in->vmax);
+    for (int i = 0; i < in->ncomp; i++) {
+        in->comp[i].bw = in->mcux * in->comp[i].h;
+        in->comp[i].bh = in->mcuy * in->comp[i].v;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t parse_sos(jpeg_info_t *in, const uint8_t *p, size_t n)
+{
+    if (n < 1 || p[0] != in->ncomp || n < 1 + 2u * p[0] + 3) {
+        return ESP_ERR_NOT_SUPPORTED;   // nur ein Scan mit allen Komponenten
+    }
+    for (int i = 0; i < p[0]; i++) {
+        int id = p[1 + 2 * i];
+        int k;
+        for (k = 0; k < in->ncomp && in->comp[k].id != id; k++) {}
+        if (k == in->ncomp || k != i) return ESP_ERR_NOT_SUPPORTED;
+        in->comp[k].td = p[2 + 2 * i] >> 4;
+        in->comp[k].ta = p[2 + 2 * i] & 0x0F;
+        if (in->comp[k].td > 3 || in->comp[k].ta > 3) return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t jpeg_frame_size(const uint8_t *jpg, size_t len, uint16_t *w, uint16_t *h)
+{
+    if (len < 4 || jpg[0] != 0xFF || jpg[1] != 0xD8) return ESP_ERR_INVALID_ARG;
+    size_t pos = 2;
+    while (pos + 4 <= len) {
+        if (jpg[pos] != 0xFF) return ESP_ERR_INVALID_RESPONSE;
+        uint8_t m = jpg[pos + 1];
+        if (m == 0xFF) { pos++; continue; }          // Füllbytes
+        size_t seg = be16(jpg + pos + 2);
+        if (seg < 2 || pos + 2 + seg > len) return ESP_ERR_INVALID_SIZE;
+        if (m >= 0xC0 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC) {
+            if (seg < 7) return ESP_ERR_INVALID_SIZE;
+            *h = be16(jpg + pos + 5);
+            *w = be16(jpg + pos + 7);
+            return ESP_OK;
+        }
+        if (m == 0xDA) break;
+        pos += 2 + seg;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t jpeg_dec_parse(jpeg_dec_t *d, const uint8_t *jpg, size_t len)
+{
+    jpeg_info_t *in = &d->info;
+    memset(in, 0, sizeof(*in));
+    for (int i = 0; i < 4; i++) {
+        d->dc[i].present = d->ac[i].present = 0;
+    }
+    d->data = jpg;
+    in->len = len;
+
+    if (len < 4 || jpg[0] != 0xFF || jpg[1] != 0xD8) return ESP_ERR_INVALID_ARG;
+    size_t pos = 2;
+    bool have_sof = false;
+    while (pos + 4 <= len) {
+        if (jpg[pos] != 0xFF) return ESP_ERR_INVALID_RESPONSE;
+        uint8_t m = jpg[pos + 1];
+        if (m == 0xFF) { pos++; continue; }          // Füllbytes
+        size_t seg = be16(jpg + pos + 2);
+        if (seg < 2 || pos + 2 + seg > len) return ESP_ERR_INVALID_SIZE;
+        const uint8_t *p = jpg + pos + 4;
+        size_t n = seg - 2;
+        esp_err_t err = ESP_OK;
+        switch (m) {
+        case 0xC0: case 0xC1:
+            err = parse_sof(in, p, n);
+            have_sof = (err == ESP_OK);
+            break;
+        case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+        case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+            return ESP_ERR_NOT_SUPPORTED;             // progressiv/arithmetisch
+        case 0xC4:
+            err = parse_dht(d, p, n);
+            break;
+        case 0xDB:
+            err = parse_dqt(in, p, n);
+            break;
+        case 0xDD:
+            if (n < 2) return ESP_ERR_INVALID_SIZE;
+            in->restart_interval = be16(p);
+            break;
+        case 0xDA:
+            if (!have_sof) return ESP_ERR_INVALID_STATE;
+            err = parse_sos(in, p, n);
+            if (err != ESP_OK) return err;
+            in->scan_off = pos + 2 + seg;
+            // Fehlende DHT-Segmente (MJPEG-Stil): Standardtabellen laden
+            for (int i = 0; i < 2; i++) {
+                const jpeg_std_huff_t *dc = &jpeg_std_huff[JPEG_STD_DC_LUM + i];
+                const jpeg_std_huff_t *ac = &jpeg_std_huff[JPEG_STD_AC_LUM + i];
+                if (!d->dc[i].present) huff_build(&d->dc[i], dc->bits, dc->vals, dc->nvals);
+                if (!d->ac[i].present) huff_build(&d->ac[i], ac->bits, ac->vals, ac->nvals);
+            }
+            for (int i = 0; i < in->ncomp; i++) {
+                if (!(in->qt_present & (1 << in->comp[i].tq)) ||
+                    !d->dc[in->comp[i].td].present || !d->ac[in->comp[i].ta].present) {
+                    return ESP_ERR_INVALID_STATE;
+                }
+            }
+            return ESP_OK;
+        default:
+            break;                                    // APPn, COM, …
+        }
+        if (err != ESP_OK) return err;
+        pos += 2 + seg;
+    }
+    return ESP_ERR_INVALID_SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// Entropie-Daten
+// ---------------------------------------------------------------------------
+// Nach RSTn: Bit-Leser neu aufsetzen, Marker überspringen
+static esp_err_t restart(bitrd_t *b)
+{
+    const uint8_t *p = b->p;
+    while (p + 1 < b->end && !(p[0] == 0xFF && p[1] >= 0xD0 && p[1] <= 0xD7)) p++;
+    if (p + 1 >= b->end) return ESP_ERR_INVALID_SIZE;
+    b->p      = p + 2;
+    b->buf    = 0;
+    b->bits   = 0;
+    b->fake   = 0;
+    b->marker = false;
+    return ESP_OK;
+}
+
+esp_err_t jpeg_dec_scan(jpeg_dec_t *d, int ncoef, uint32_t comp_mask,
+                        jpeg_block_cb_t cb, void *ctx)
+{
+    const jpeg_info_t *in = &d->info;
+    if (ncoef < 1 || ncoef > 64 || !in->scan_off) return ESP_ERR_INVALID_ARG;
+
+    bitrd_t b = {
+        .p   = d->data + in->scan_off,
+        .end = d->data + in->len,
+    };
+    int pred[JPEG_MAX_COMP] = { 0 };
+    int16_t coef[64];
+    unsigned todo = in->restart_interval;
+
+    for (int my = 0; my < in->mcuy; my++) {
+        for (int mx = 0; mx < in->mcux; mx++) {
+            if (in->restart_interval) {
+                if (todo == 0) {
+                    if (restart(&b) != ESP_OK) return ESP_ERR_INVALID_SIZE;
+                    memset(pred, 0, sizeof(pred));
+                    todo = in->restart_interval;
+                }
+                todo--;
+            }
+            for (int c = 0; c < in->ncomp; c++) {
+                const jpeg_comp_t *cp = &in->comp[c];
+                const jpeg_huff_t *hdc = &d->dc[cp->td];
+                const jpeg_huff_t *hac = &d->ac[cp->ta];
+                const uint16_t *q = in->qt[cp->tq];
+                bool want = comp_mask & (1u << c);
+
+                for (int by = 0; by < cp->v; by++) {
+                    for (int bx = 0; bx < cp->h; bx++) {
+                        // DC: Differenz zum Vorgänger
+                        int s = huff_decode(&b, hdc);
+                        if (s < 0 || s > 11) return ESP_ERR_INVALID_CRC;
+                        pred[c] += s ? extend(br_get(&b, s), s) : 0;
+                        if (want) {
+                            memset(coef, 0, ncoef * sizeof(coef[0]));
+                            coef[0] = (int16_t)(pred[c] * q[0]);
+                        }
+                        // AC: nur die ersten ncoef behalten, Rest überlesen
+                        for (int k = 1; k < 64; ) {
+                            int rs = huff_decode(&b, hac);
+                            if (rs < 0) return ESP_ERR_INVALID_CRC;
+                            int r = rs >> 4, sz = rs & 0x0F;
+                            if (!sz) {
+                                if (r != 15) break;       // EOB
+                                k += 16;                  // ZRL
+                                continue;
+                            }
+                            k += r;
+                            if (k > 63) return ESP_ERR_INVALID_CRC;
+                            int v = extend(br_get(&b, sz), sz);
+                            if (want && k < ncoef) coef[k] = (int16_t)(v * q[k]);
+                            k++;
+                        }
+                        if (want) {
+                            cb(ctx, c, mx * cp->h + bx, my * cp->v + by, coef);
+                        }
+                    }
+                }
+            }
+            // Mehr Bits verbraucht als vorhanden → abgeschnittenes JPEG
+            if (b.fake > b.bits) return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,78 @@
+// jpeg_scan.h — Baseline-JPEG bis auf Koeffizientenebene dekodieren (ohne IDCT)
+//
+// Liefert pro 8×8-Block die ersten n dequantisierten Koeffizienten in
+// Zickzack-Reihenfolge (n = 1: nur DC = 8 × (Mittelwert − 128)).
+// AC-Koeffizienten dahinter werden nur überlesen. Reines C, keine
+// ESP-Abhängigkeiten außer esp_err_t.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#define JPEG_MAX_COMP       3
+#define JPEG_HUFF_LOOKAHEAD 9
+
+typedef struct {
+    uint8_t  id;
+    uint8_t  h, v;       // Sampling-Faktoren
+    uint8_t  tq;         // Quantisierungstabelle
+    uint8_t  td, ta;     // Huffman-Tabellen DC/AC (aus SOS)
+    uint16_t bw, bh;     // Blöcke pro Zeile/Spalte inkl. MCU-Auffüllung
+} jpeg_comp_t;
+
+typedef struct {
+    uint16_t width, height;
+    uint8_t  ncomp;
+    uint8_t  hmax, vmax;
+    uint16_t mcux, mcuy;         // MCUs pro Zeile/Spalte
+    uint16_t restart_interval;
+    jpeg_comp_t comp[JPEG_MAX_COMP];
+    uint16_t qt[4][64];          // Zickzack-Reihenfolge
+    uint8_t  qt_present;         // Bitmaske geladener Tabellen
+    size_t   scan_off;           // erstes Byte der Entropie-Daten
+    size_t   len;                // Gesamtlänge des JPEG
+} jpeg_info_t;
+
+typedef struct {
+    uint16_t lookup[1 << JPEG_HUFF_LOOKAHEAD];  // (Länge << 8) | Symbol, 0 = langer Code
+    int32_t  maxcode[18];
+    int32_t  valoff[18];
+    uint8_t  vals[256];
+    uint8_t  present;
+} jpeg_huff_t;
+
+// Standard-Huffman-Tabellen (ITU T.81 Annex K.3), auch für den Encoder
+// in jpeg_thumb.c
+typedef struct {
+    const uint8_t *bits;     // Codes pro Länge 1..16
+    const uint8_t *vals;
+    int            nvals;
+} jpeg_std_huff_t;
+
+enum { JPEG_STD_DC_LUM, JPEG_STD_DC_CHR, JPEG_STD_AC_LUM, JPEG_STD_AC_CHR };
+extern const jpeg_std_huff_t jpeg_std_huff[4];
+
+// Dekoder-Kontext (ca. 5 KB) — statisch anlegen, nicht auf dem Stack
+typedef struct {
+    jpeg_info_t   info;
+    jpeg_huff_t   dc[4];
+    jpeg_huff_t   ac[4];
+    const uint8_t *data;
+} jpeg_dec_t;
+
+// Callback pro Block: Komponente, Blockposition, coef[0..ncoef-1]
+typedef void (*jpeg_block_cb_t)(void *ctx, int comp, int bx, int by,
+                                const int16_t *coef);
+
+// Nur die Bildgröße aus dem SOF lesen (ohne Dekoder-Kontext, wenige
+// Segmente bis zum SOF). ESP_ERR_NOT_FOUND, wenn vor dem SOS kein SOF kommt.
+esp_err_t jpeg_frame_size(const uint8_t *jpg, size_t len, uint16_t *w, uint16_t *h);
+
+// Header bis einschließlich SOS lesen (SOF0/SOF1, DQT, DHT, DRI).
+// Fehlen DHT-Segmente, werden die Standardtabellen (Annex K) geladen.
+esp_err_t jpeg_dec_parse(jpeg_dec_t *d, const uint8_t *jpg, size_t len);
+
+// Entropie-Daten dekodieren und cb für jeden Block aufrufen (ncoef 1..64).
+// comp_mask wählt die Komponenten, für die cb gerufen wird.
+esp_err_t jpeg_dec_scan(jpeg_dec_t *d, int ncoef, uint32_t comp_mask,
+                        jpeg_block_cb_t cb, void *ctx);
@@ -0,0 +1,397 @@
+// jpeg_thumb.c — JPEG-Verkleinerung im DCT-Bereich plus Baseline-Encoder
+//
+// 1/8: Pixel = DC / 8 + 128, also der Mittelwert des Blocks.
+// 1/4: Mittelwert jedes 4×4-Viertels aus DC, F01, F10 und F11. Die
+// Basisfunktion cos((2x+1)π/16) hat über x = 0..3 den Mittelwert ±0,6407,
+// daraus die Gewichte THUMB_K1 = 0,6407 / (4·√2) und THUMB_K11 = 0,6407² / 4
+// (Q12). Höhere Frequenzen fallen weg; das wirkt wie ein leichter Tiefpass.
+// Die kleinen Ebenen werden ganz normal per FDCT, Quantisierung und
+// Huffman-Standardtabellen kodiert — bei 1/4 sind das 1/16 der Blöcke der
+// Quelle, die Laufzeit steckt fast ganz im Huffman-Dekodieren der Quelle.
+#include "jpeg_thumb.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "jpeg_scan.h"
+
+#define THUMB_K1      464      // F01/F10-Gewicht für ein Viertel, Q12
+#define THUMB_K11     420      // F11-Gewicht, Q12
+#define THUMB_HDR_MAX 1024     // SOI … SOS (JFIF, 2× DQT, 4× DHT, SOF0)
+
+typedef struct {
+    uint16_t code[256];
+    uint8_t  size[256];
+} huff_enc_t;
+
+struct jpeg_thumb {
+    jpeg_dec_t dec;
+    int        f;                       // Pixel pro Quellblock und Richtung
+    uint8_t   *plane[JPEG_MAX_COMP];
+    size_t     plane_cap[JPEG_MAX_COMP];
+    int        pw[JPEG_MAX_COMP], ph[JPEG_MAX_COMP];
+    uint8_t   *out;
+    size_t     out_cap;
+    uint8_t    qt_zz[2][64];            // für DQT (Zickzack)
+    uint16_t   qt[2][64];               // für die Quantisierung (natürlich)
+    huff_enc_t dc[2], ac[2];
+};
+
+// Zickzack-Index → natürliche Position
+static const uint8_t k_zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// Quantisierungstabellen (ITU T.81 Annex K.1), natürliche Reihenfolge
+static const uint8_t k_qt_lum[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99,
+};
+static const uint8_t k_qt_chr[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+// DCT-Basis c(u)/2 · cos((2x+1)uπ/16) in Q12
+static const int16_t k_dct[8][8] = {
+    { 1448,  1448,  1448,  1448,  1448,  1448,  1448,  1448 },
+    { 2009,  1703,  1138,   400,  -400, -1138, -1703, -2009 },
+    { 1892,   784,  -784, -1892, -1892,  -784,   784,  1892 },
+    { 1703,  -400, -2009, -1138,  1138,  2009,   400, -1703 },
+    { 1448, -1448, -1448,  1448,  1448, -1448, -1448,  1448 },
+    { 1138, -2009,   400,  1703, -1703,  -400,  2009, -1138 },
+    {  784, -1892,  1892,  -784,  -784,  1892, -1892,   784 },
+    {  400, -1138,  1703, -2009,  2009, -1703,  1138,  -400 },
+};
+
+// ---------------------------------------------------------------------------
+// Kontext
+// ---------------------------------------------------------------------------
+static void henc_build(huff_enc_t *h, const jpeg_std_huff_t *s)
+{
+    uint16_t code = 0;
+    int k = 0;
+    for (int l = 1; l <= 16; l++) {
+        for (int i = 0; i < s->bits[l - 1]; i++, k++) {
+            h->code[s->vals[k]] = code++;
+            h->size[s->vals[k]] = l;
+        }
+        code <<= 1;
+    }
+}
+
+// Tabellen nach IJG-Qualität skalieren (wie jpeg_set_quality)
+static void qt_build(jpeg_thumb_t *t, int quality)
+{
+    if (quality < 1) quality = 1;
+    if (quality > 100) quality = 100;
+    int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+    for (int i = 0; i < 64; i++) {
+        for (int c = 0; c < 2; c++) {
+            int v = ((c ? k_qt_chr : k_qt_lum)[k_zigzag[i]] * scale + 50) / 100;
+            if (v < 1) v = 1;
+            if (v > 255) v = 255;
+            t->qt_zz[c][i] = v;
+            t->qt[c][k_zigzag[i]] = v;
+        }
+    }
+}
+
+static void *buf_alloc(size_t n)
+{
+    void *p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : malloc(n);
+}
+
+static bool buf_grow(uint8_t **p, size_t *cap, size_t need)
+{
+    if (*cap >= need) return true;
+    free(*p);
+    *p   = buf_alloc(need);
+    *cap = *p ? need : 0;
+    return *p != NULL;
+}
+
+jpeg_thumb_t *jpeg_thumb_create(int quality)
+{
+    jpeg_thumb_t *t = buf_alloc(sizeof(*t));
+    if (!t) return NULL;
+    memset(t, 0, sizeof(*t));
+    qt_build(t, quality);
+    for (int c = 0; c < 2; c++) {
+        henc_build(&t->dc[c], &jpeg_std_huff[JPEG_STD_DC_LUM + c]);
+        henc_build(&t->ac[c], &jpeg_std_huff[JPEG_STD_AC_LUM + c]);
+    }
+    return t;
+}
+
+void jpeg_thumb_destroy(jpeg_thumb_t *t)
+{
+    if (!t) return;
+    for (int c = 0; c < JPEG_MAX_COMP; c++) free(t->plane[c]);
+    free(t->out);
+    free(t);
+}
+
+// ---------------------------------------------------------------------------
+// Verkleinern
+// ---------------------------------------------------------------------------
+static inline uint8_t clamp8(int v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static void block_cb(void *ctx, int comp, int bx, int by, const int16_t *coef)
+{
+    jpeg_thumb_t *t = ctx;
+    const int w = t->pw[comp];
+    uint8_t *p = t->plane[comp] + by * t->f * w + bx * t->f;
+    if (t->f == 1) {
+        p[0] = clamp8(128 + ((coef[0] + 4) >> 3));
+        return;
+    }
+    // Zickzack 1 = F01 (waagrecht), 2 = F10 (senkrecht), 4 = F11
+    int dc = coef[0] * 512 + 2048 + (128 << 12);
+    int h  = coef[1] * THUMB_K1, v = coef[2] * THUMB_K1, d = coef[4] * THUMB_K11;
+    p[0]     = clamp8((dc + h + v + d) >> 12);
+    p[1]     = clamp8((dc - h + v - d) >> 12);
+    p[w]     = clamp8((dc + h - v - d) >> 12);
+    p[w + 1] = clamp8((dc - h - v + d) >> 12);
+}
+
+// Rand ab (vw, vh) bis zur MCU-Grenze mit der letzten gültigen Spalte/Zeile füllen
+static void plane_pad(uint8_t *p, int w, int vw, int vh, int nw, int nh)
+{
+    for (int y = 0; y < vh; y++) {
+        memset(p + y * w + vw, p[y * w + vw - 1], nw - vw);
+    }
+    for (int y = vh; y < nh; y++) {
+        memcpy(p + y * w, p + (vh - 1) * w, nw);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Encoder
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint8_t *p, *end;
+    uint32_t acc;
+    int      n;
+    bool     overflow;
+} bitwr_t;
+
+static inline void wr_byte(bitwr_t *w, uint8_t b)
+{
+    if (w->p < w->end) *w->p++ = b;
+    else w->overflow = true;
+}
+
+static void wr_bytes(bitwr_t *w, const uint8_t *b, size_t n)
+{
+    while (n--) wr_byte(w, *b++);
+}
+
+static void wr_marker(bitwr_t *w, uint8_t m, size_t len)
+{
+    const uint8_t h[4] = { 0xFF, m, (uint8_t)((len + 2) >> 8), (uint8_t)(len + 2) };
+    wr_bytes(w, h, sizeof(h));
+}
+
+// len ≤ 16 Bit; nach einem 0xFF folgt das Stuffing-Byte 0x00
+static inline void wr_bits(bitwr_t *w, uint32_t code, int len)
+{
+    w->acc = (w->acc << len) | (code & ((1u << len) - 1));
+    w->n  += len;
+    while (w->n >= 8) {
+        uint8_t b = (uint8_t)(w->acc >> (w->n - 8));
+        wr_byte(w, b);
+        if (b == 0xFF) wr_byte(w, 0x00);
+        w->n -= 8;
+    }
+}
+
+static inline int nbits(int v)
+{
+    if (v < 0) v = -v;
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+// Größenklasse über Huffman, dann die Bits (negativ: Einerkomplement)
+static inline void wr_coef(bitwr_t *w, const huff_enc_t *h, int sym_hi, int v)
+{
+    int s = nbits(v);
+    int sym = sym_hi | s;
+    wr_bits(w, h->code[sym], h->size[sym]);
+    if (s) wr_bits(w, v < 0 ? v - 1 : v, s);
+}
+
+static void encode_block(bitwr_t *w, const int16_t *zz, int *pred,
+                         const huff_enc_t *dc, const huff_enc_t *ac)
+{
+    wr_coef(w, dc, 0, zz[0] - *pred);
+    *pred = zz[0];
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+        if (!zz[k]) {
+            run++;
+            continue;
+        }
+        for (; run > 15; run -= 16) wr_bits(w, ac->code[0xF0], ac->size[0xF0]);   // ZRL
+        wr_coef(w, ac, run << 4, zz[k]);
+        run = 0;
+    }
+    if (run) wr_bits(w, ac->code[0x00], ac->size[0x00]);                      // EOB
+}
+
+// Ganzzahlige FDCT (Zeilen, dann Spalten) und Quantisierung → Zickzack
+static void fdct_quant(const uint8_t *src, int stride, const uint16_t *qt, int16_t *zz)
+{
+    int32_t tmp[64], f[64];
+    for (int y = 0; y < 8; y++) {
+        const uint8_t *r = src + y * stride;
+        for (int u = 0; u < 8; u++) {
+            int32_t s = 0;
+            for (int x = 0; x < 8; x++) s += k_dct[u][x] * (r[x] - 128);
+            tmp[y * 8 + u] = (s + (1 << 9)) >> 10;          // Q2
+        }
+    }
+    for (int u = 0; u < 8; u++) {
+        for (int v = 0; v < 8; v++) {
+            int32_t s = 0;
+            for (int y = 0; y < 8; y++) s += k_dct[v][y] * tmp[y * 8 + u];
+            f[v * 8 + u] = (s + (1 << 13)) >> 14;
+        }
+    }
+    for (int i = 0; i < 64; i++) {
+        int n = k_zigzag[i], q = qt[n], c = f[n];
+        zz[i] = (int16_t)(c >= 0 ? (c + q / 2) / q : -((q / 2 - c) / q));
+    }
+}
+
+static void write_header(jpeg_thumb_t *t, bitwr_t *w, int width, int height)
+{
+    const jpeg_info_t *in = &t->dec.info;
+    const int nt = in->ncomp > 1 ? 2 : 1;
+    static const uint8_t jfif[] = {
+        0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+        0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00,
+    };
+    wr_bytes(w, jfif, sizeof(jfif));
+
+    for (int c = 0; c < nt; c++) {
+        wr_marker(w, 0xDB, 65);
+        wr_byte(w, c);
+        wr_bytes(w, t->qt_zz[c], 64);
+    }
+
+    wr_marker(w, 0xC0, 6 + 3 * in->ncomp);
+    const uint8_t sof[6] = { 8, (uint8_t)(height >> 8), (uint8_t)height,
+                             (uint8_t)(width >> 8), (uint8_t)width, in->ncomp };
+    wr_bytes(w, sof, sizeof(sof));
+    for (int c = 0; c < in->ncomp; c++) {
+        const uint8_t sc[3] = { (uint8_t)(c + 1),
+                                (uint8_t)(in->comp[c].h << 4 | in->comp[c].v), c ? 1 : 0 };
+        wr_bytes(w, sc, sizeof(sc));
+    }
+
+    for (int i = 0; i < 2 * nt; i++) {
+        int cls = i / nt, id = i % nt;      // DC-Tabellen zuerst
+        const jpeg_std_huff_t *h = &jpeg_std_huff[(cls ? JPEG_STD_AC_LUM : JPEG_STD_DC_LUM) + id];
+        wr_marker(w, 0xC4, 17 + h->nvals);
+        wr_byte(w, cls << 4 | id);
+        wr_bytes(w, h->bits, 16);
+        wr_bytes(w, h->vals, h->nvals);
+    }
+
+    wr_marker(w, 0xDA, 4 + 2 * in->ncomp);
+    wr_byte(w, in->ncomp);
+    for (int c = 0; c < in->ncomp; c++) {
+        const uint8_t sc[2] = { (uint8_t)(c + 1), c ? 0x11 : 0x00 };
+        wr_bytes(w, sc, sizeof(sc));
+    }
+    const uint8_t tail[3] = { 0, 63, 0 };   // Ss, Se, Ah/Al (baseline)
+    wr_bytes(w, tail, sizeof(tail));
+}
+
+esp_err_t jpeg_thumb_make(jpeg_thumb_t *t, const uint8_t *jpg, size_t len, int div,
+                          const uint8_t **out, size_t *out_len)
+{
+    if (div != 4 && div != 8) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = jpeg_dec_parse(&t->dec, jpg, len);
+    if (err != ESP_OK) return err;
+    const jpeg_info_t *in = &t->dec.info;
+    t->f = 8 / div;
+
+    // Zielgröße und MCU-Raster des kleinen Bilds (gleiche Sampling-Faktoren)
+    const int width  = (in->width  * t->f + 7) / 8;
+    const int height = (in->height * t->f + 7) / 8;
+    const int mcux   = (width  + 8 * in->hmax - 1) / (8 * in->hmax);
+    const int mcuy   = (height + 8 * in->vmax - 1) / (8 * in->vmax);
+    size_t pixels = 0;
+    for (int c = 0; c < in->ncomp; c++) {
+        const jpeg_comp_t *cp = &in->comp[c];
+        int nw = mcux * cp->h * 8, nh = mcuy * cp->v * 8;
+        t->pw[c] = cp->bw * t->f > nw ? cp->bw * t->f : nw;
+        t->ph[c] = cp->bh * t->f > nh ? cp->bh * t->f : nh;
+        size_t n = (size_t)t->pw[c] * t->ph[c];
+        if (!buf_grow(&t->plane[c], &t->plane_cap[c], n)) return ESP_ERR_NO_MEM;
+        pixels += n;
+    }
+    if (!buf_grow(&t->out, &t->out_cap, THUMB_HDR_MAX + pixels + pixels / 2)) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    err = jpeg_dec_scan(&t->dec, t->f == 1 ? 1 : 5, (1u << in->ncomp) - 1, block_cb, t);
+    if (err != ESP_OK) return err;
+
+    for (int c = 0; c < in->ncomp; c++) {
+        const jpeg_comp_t *cp = &in->comp[c];
+        int vw = (width  * cp->h + in->hmax - 1) / in->hmax;
+        int vh = (height * cp->v + in->vmax - 1) / in->vmax;
+        plane_pad(t->plane[c], t->pw[c], vw, vh, mcux * cp->h * 8, mcuy * cp->v * 8);
+    }
+
+    bitwr_t w = { .p = t->out, .end = t->out + t->out_cap };
+    write_header(t, &w, width, height);
+    int pred[JPEG_MAX_COMP] = { 0 };
+    int16_t zz[64];
+    for (int my = 0; my < mcuy; my++) {
+        for (int mx = 0; mx < mcux; mx++) {
+            for (int c = 0; c < in->ncomp; c++) {
+                const jpeg_comp_t *cp = &in->comp[c];
+                const int tc = c ? 1 : 0;
+                for (int by = 0; by < cp->v; by++) {
+                    for (int bx = 0; bx < cp->h; bx++) {
+                        int x = (mx * cp->h + bx) * 8, y = (my * cp->v + by) * 8;
+                        fdct_quant(t->plane[c] + y * t->pw[c] + x, t->pw[c], t->qt[tc], zz);
+                        encode_block(&w, zz, &pred[c], &t->dc[tc], &t->ac[tc]);
+                    }
+                }
+            }
+        }
+        if (w.overflow) return ESP_ERR_INVALID_SIZE;
+    }
+    if (w.n) wr_bits(&w, 0xFF, 8 - w.n);    // mit Einsen auffüllen
+    wr_byte(&w, 0xFF);
+    wr_byte(&w, 0xD9);
+    if (w.overflow) return ESP_ERR_INVALID_SIZE;
+
+    *out = t->out;
+    *out_len = w.p - t->out;
+    return ESP_OK;
+}
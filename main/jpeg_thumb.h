@@ -0,0 +1,23 @@
+// jpeg_thumb.h — Verkleinerte JPEGs (1/4, 1/8) direkt aus den DCT-Koeffizienten
+//
+// Kein volles Dekodieren und Skalieren: jpeg_scan liefert pro 8×8-Block nur
+// DC (1/8: ein Pixel pro Block) bzw. DC und die drei tiefsten AC-Werte
+// (1/4: 2×2 Pixel pro Block). Das kleine Bild wird mit einem einfachen
+// Baseline-Encoder (Standardtabellen, Unterabtastung wie die Quelle) neu
+// kodiert.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct jpeg_thumb jpeg_thumb_t;
+
+// Kontext mit Dekoder, Bildebenen und Ausgabepuffer (ca. 9 KB, Puffer
+// wachsen mit der Bildgröße, bevorzugt im PSRAM). quality 1..100 wie IJG.
+jpeg_thumb_t *jpeg_thumb_create(int quality);
+void          jpeg_thumb_destroy(jpeg_thumb_t *t);
+
+// JPEG um den Faktor div (4 oder 8) verkleinern. *out zeigt in den Kontext
+// und bleibt bis zum nächsten Aufruf gültig.
+esp_err_t jpeg_thumb_make(jpeg_thumb_t *t, const uint8_t *jpg, size_t len, int div,
+                          const uint8_t **out, size_t *out_len);
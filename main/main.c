@@ -10,11 +10,14 @@
 #include "wifi.h"                  // wifi_init_sta(), wifi_get_ip_info(), wifi_start_scan()
 #include "http_server.h"           // start_webserver()
 #include "camera.h"                // camera_init(), snapshot_handler(), stream_handler()
+#include "motion.h"                // motion_init()
+#include "rtsp_server.h"           // rtsp_server_start()
+#include "task_prof.h"             // task_create(), task_prof_start()
 
 static const char *TAG = "app";
 
 //---------------------------------------------------------------------------
-// IP-Logger: alle 10 s IP-Status oder Scan starten
+// IP-Logger: alle 10 s IP-Status oder Scan starten (Roaming macht wifi.c)
 //--------------------------------------------------------------------------- 
 static void ip_logger_task(void *arg)
 {
@@ -38,8 +41,11 @@ void app_main(void)
     wifi_init_sta();
     ESP_LOGI(TAG, "After wifi_init_sta()");
 
-    // 2) IP-Logger starten
-    xTaskCreate(ip_logger_task, "ip_logger", 4096, NULL, 5, NULL);
+    // 2) IP-Logger und Task-Profiler starten (Platzierung: task_prof.c)
+    task_create(TASK_IP_LOGGER, ip_logger_task, NULL, NULL);
+    if (task_prof_start() != ESP_OK) {
+        ESP_LOGW(TAG, "task_prof_start failed");
+    }
 
     // 3) Kamera initialisieren (für Stream: VGA @30 q)
     if (camera_init() != ESP_OK) {
@@ -48,13 +54,24 @@ void app_main(void)
     }
     ESP_LOGI(TAG, "After camera_init()");
 
-    // 4) HTTP-Server starten (/ , /snapshot , /stream)
+    // 3b) Bewegungserkennung auf den Stream-Frames
+    if (motion_init() != ESP_OK) {
+        ESP_LOGW(TAG, "motion_init failed");
+    }
+
+    // 4) HTTP-Server starten (/ , /snapshot , /burst , /stream , /ws , /motion , /clip ,
+    //    /metrics , /debug/tasks)
     if (start_webserver() != ESP_OK) {
         ESP_LOGE(TAG, "start_webserver failed");
         return;
     }
     ESP_LOGI(TAG, "After start_webserver()");
 
+    // 4b) RTSP-Server (rtsp://<ip>/, RTP/JPEG über UDP oder TCP)
+    if (rtsp_server_start() != ESP_OK) {
+        ESP_LOGW(TAG, "rtsp_server_start failed");
+    }
+
     // 5) Idle-Loop
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(1000));
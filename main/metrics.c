@@ -0,0 +1,306 @@
+// metrics.c — atomare Zähler/Histogramme und Prometheus-Ausgabe (siehe metrics.h)
+#include "metrics.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "lwip/sockets.h"
+#include "task_prof.h"
+#include "wifi.h"
+
+#define METRICS_MAX_BUCKETS  10
+#define METRICS_OUT_BUF      1024
+
+typedef struct {
+    const char *name;
+    const char *help;
+    bool        seconds;                  // Werte in µs, Ausgabe in Sekunden
+    uint32_t    bounds[METRICS_MAX_BUCKETS];
+} hist_def_t;
+
+static const hist_def_t k_hist[MET_H_COUNT] = {
+    [MET_H_FB_GET_US] = { "cam_fb_get_wait_seconds", "Time blocked in esp_camera_fb_get", true,
+        { 1000, 2000, 5000, 10000, 20000, 33000, 50000, 100000, 200000, 500000 } },
+    [MET_H_JPEG_BYTES] = { "cam_jpeg_size_bytes", "JPEG size of captured stream frames", false,
+        { 8192, 16384, 24576, 32768, 49152, 65536, 98304, 131072, 262144, 524288 } },
+    [MET_H_SEND_US] = { "cam_stream_send_seconds", "Time to write one frame to a stream socket", true,
+        { 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000 } },
+    [MET_H_MODE_SWITCH_US] = { "cam_mode_switch_seconds", "Sensor mode switch duration", true,
+        { 10000, 20000, 50000, 100000, 150000, 200000, 300000, 500000, 1000000, 2000000 } },
+    [MET_H_HTTP_US] = { "http_handler_seconds", "URI handler run time", true,
+        { 1000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000, 5000000 } },
+    [MET_H_AF_LOCK_US] = { "cam_af_lock_seconds", "Autofocus lock time before a snapshot", true,
+        { 1000, 50000, 100000, 200000, 300000, 500000, 750000, 1000000, 1500000, 2000000 } },
+    [MET_H_BURST_FRAME_US] = { "cam_burst_frame_interval_seconds", "Time between consecutive burst frames", true,
+        { 33000, 50000, 66000, 100000, 133000, 200000, 300000, 500000, 1000000, 2000000 } },
+    [MET_H_WS_ACK_AGE_US] = { "cam_ws_frame_age_at_ack_seconds", "Capture to client acknowledgement on /ws", true,
+        { 20000, 50000, 75000, 100000, 150000, 200000, 300000, 500000, 1000000, 2000000 } },
+    [MET_H_SENSOR_SEQ_US] = { "cam_sensor_seq_seconds", "Time to write one sensor register sequence", true,
+        { 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 500000 } },
+    [MET_H_THUMB_US] = { "cam_thumb_seconds", "Time to downscale one frame in the DCT domain", true,
+        { 1000, 2000, 5000, 10000, 15000, 20000, 30000, 50000, 100000, 200000 } },
+};
+
+static const struct { const char *name, *help; } k_counter[MET_C_COUNT] = {
+    [MET_C_FRAMES_CAPTURED] = { "cam_frames_captured_total", "Frames published to the frame ring" },
+    [MET_C_FRAMES_DROPPED]  = { "cam_frames_dropped_total", "Frames the ring could not store (no memory for the slot buffer)" },
+    [MET_C_FB_GET_FAIL]     = { "cam_fb_get_failures_total", "esp_camera_fb_get returned no frame" },
+    [MET_C_STREAM_FRAMES]   = { "cam_stream_frames_delivered_total", "Frames written to stream clients" },
+    [MET_C_STREAM_SKIPPED]  = { "cam_stream_frames_skipped_total", "Frames skipped by slow stream clients" },
+    [MET_C_STREAM_BYTES]    = { "cam_stream_bytes_sent_total", "JPEG bytes written to stream clients" },
+    [MET_C_SNAPSHOTS]       = { "cam_snapshots_captured_total", "Snapshot captures (sensor mode switches)" },
+    [MET_C_SNAPSHOT_HITS]   = { "cam_snapshot_cache_hits_total", "Snapshot requests served from cache" },
+    [MET_C_SNAPSHOT_BYTES]  = { "cam_snapshot_bytes_sent_total", "JPEG bytes sent for snapshots" },
+    [MET_C_BURST_FRAMES]    = { "cam_burst_frames_total", "Frames captured in snapshot mode by /burst" },
+    [MET_C_HTTP_REQUESTS]   = { "http_requests_total", "Handled HTTP requests" },
+};
+
+typedef struct {
+    uint32_t counts[METRICS_MAX_BUCKETS + 1];   // letzter = +Inf
+    uint64_t sum;
+} hist_t;
+
+typedef struct {
+    uint32_t in_use;
+    uint32_t delivered;
+    uint32_t skipped;
+    uint64_t bytes;
+    char     kind[8];
+    char     peer[16];
+} client_t;
+
+static hist_t   s_hist[MET_H_COUNT];
+static uint64_t s_counter[MET_C_COUNT];
+static client_t s_client[METRICS_MAX_CLIENTS];
+
+// ---------------------------------------------------------------------------
+// Erfassen
+// ---------------------------------------------------------------------------
+void metrics_observe(metrics_hist_t h, uint32_t value)
+{
+    const uint32_t *b = k_hist[h].bounds;
+    int i = 0;
+    while (i < METRICS_MAX_BUCKETS && value > b[i]) i++;
+    __atomic_fetch_add(&s_hist[h].counts[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s_hist[h].sum, value, __ATOMIC_RELAXED);
+}
+
+void metrics_add(metrics_counter_t c, uint32_t n)
+{
+    __atomic_fetch_add(&s_counter[c], n, __ATOMIC_RELAXED);
+}
+
+int metrics_client_open(const char *kind, int peer_fd)
+{
+    for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+        uint32_t expected = 0;
+        if (!__atomic_compare_exchange_n(&s_client[i].in_use, &expected, 1, false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        client_t *c = &s_client[i];
+        c->delivered = c->skipped = 0;
+        c->bytes     = 0;
+        snprintf(c->kind, sizeof(c->kind), "%s", kind);
+        c->peer[0] = '\0';
+        struct sockaddr_storage addr;
+        socklen_t alen = sizeof(addr);
+        if (peer_fd >= 0 && getpeername(peer_fd, (struct sockaddr *)&addr, &alen) == 0) {
+            if (addr.ss_family == AF_INET) {
+                inet_ntop(AF_INET, &((struct sockaddr_in *)&addr)->sin_addr,
+                          c->peer, sizeof(c->peer));
+            }
+#if LWIP_IPV6
+            else if (addr.ss_family == AF_INET6) {
+                // httpd lauscht auf IPv6: IPv4-Adresse steht in den letzten 4 Bytes
+                inet_ntop(AF_INET, &((struct sockaddr_in6 *)&addr)->sin6_addr.s6_addr[12],
+                          c->peer, sizeof(c->peer));
+            }
+#endif
+        }
+        __atomic_store_n(&c->in_use, 2, __ATOMIC_RELEASE);   // 2 = gültig
+        return i;
+    }
+    return -1;
+}
+
+void metrics_client_frame(int slot, uint32_t bytes, uint32_t skipped_total)
+{
+    if (slot >= 0) {
+        client_t *c = &s_client[slot];
+        uint32_t new_skips = skipped_total - c->skipped;
+        __atomic_store_n(&c->delivered, c->delivered + 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->skipped, skipped_total, __ATOMIC_RELAXED);
+        __atomic_store_n(&c->bytes, c->bytes + bytes, __ATOMIC_RELAXED);
+        if (new_skips) metrics_add(MET_C_STREAM_SKIPPED, new_skips);
+    }
+    metrics_add(MET_C_STREAM_FRAMES, 1);
+    metrics_add(MET_C_STREAM_BYTES, bytes);
+}
+
+void metrics_client_close(int slot)
+{
+    if (slot >= 0) __atomic_store_n(&s_client[slot].in_use, 0, __ATOMIC_RELEASE);
+}
+
+// ---------------------------------------------------------------------------
+// Ausgabe
+// ---------------------------------------------------------------------------
+typedef struct {
+    httpd_req_t *req;
+    char   buf[METRICS_OUT_BUF];
+    size_t len;
+    esp_err_t err;
+} out_t;
+
+static void out_flush(out_t *o)
+{
+    if (o->len && o->err == ESP_OK) {
+        o->err = httpd_resp_send_chunk(o->req, o->buf, o->len);
+    }
+    o->len = 0;
+}
+
+static void out_printf(out_t *o, const char *fmt, ...)
+{
+    va_list ap;
+    for (int tries = 0; tries < 2; tries++) {
+        va_start(ap, fmt);
+        int n = vsnprintf(o->buf + o->len, sizeof(o->buf) - o->len, fmt, ap);
+        va_end(ap);
+        if (n >= 0 && o->len + n < sizeof(o->buf)) {
+            o->len += n;
+            return;
+        }
+        out_flush(o);   // passt nicht mehr → senden und nochmal
+    }
+}
+
+// µs als Sekunden mit 6 Nachkommastellen (ohne Gleitkomma-printf)
+static void fmt_value(char *dst, size_t n, uint64_t v, bool seconds)
+{
+    if (seconds) {
+        snprintf(dst, n, "%llu.%06llu", (unsigned long long)(v / 1000000),
+                 (unsigned long long)(v % 1000000));
+    } else {
+        snprintf(dst, n, "%llu", (unsigned long long)v);
+    }
+}
+
+static void out_hist(out_t *o, metrics_hist_t h)
+{
+    const hist_def_t *d = &k_hist[h];
+    char le[24];
+    uint64_t cum = 0;
+    out_printf(o, "# HELP %s %s\n# TYPE %s histogram\n", d->name, d->help, d->name);
+    for (int i = 0; i < METRICS_MAX_BUCKETS; i++) {
+        cum += __atomic_load_n(&s_hist[h].counts[i], __ATOMIC_RELAXED);
+        fmt_value(le, sizeof(le), d->bounds[i], d->seconds);
+        out_printf(o, "%s_bucket{le=\"%s\"} %llu\n", d->name, le, (unsigned long long)cum);
+    }
+    cum += __atomic_load_n(&s_hist[h].counts[METRICS_MAX_BUCKETS], __ATOMIC_RELAXED);
+    out_printf(o, "%s_bucket{le=\"+Inf\"} %llu\n", d->name, (unsigned long long)cum);
+    fmt_value(le, sizeof(le), __atomic_load_n(&s_hist[h].sum, __ATOMIC_RELAXED), d->seconds);
+    out_printf(o, "%s_sum %s\n%s_count %llu\n", d->name, le, d->name, (unsigned long long)cum);
+}
+
+esp_err_t metrics_handler(httpd_req_t *req)
+{
+    // ~1 KB Puffer: nicht auf den httpd-Stack (httpd-Worker ist einthreadig)
+    static out_t o;
+    o.req = req;
+    o.len = 0;
+    o.err = ESP_OK;
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    for (int c = 0; c < MET_C_COUNT; c++) {
+        out_printf(&o, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+                   k_counter[c].name, k_counter[c].help, k_counter[c].name, k_counter[c].name,
+                   (unsigned long long)__atomic_load_n(&s_counter[c], __ATOMIC_RELAXED));
+    }
+    for (int h = 0; h < MET_H_COUNT; h++) out_hist(&o, h);
+
+    // Aktive Stream-Clients
+    static const struct { const char *name, *help; } k_client_metric[3] = {
+        { "cam_client_frames_delivered", "Frames delivered to an open stream client" },
+        { "cam_client_frames_skipped",   "Frames an open stream client fell behind on" },
+        { "cam_client_bytes_sent",       "JPEG bytes sent to an open stream client" },
+    };
+    for (int m = 0; m < 3; m++) {
+        out_printf(&o, "# HELP %s %s\n# TYPE %s gauge\n",
+                   k_client_metric[m].name, k_client_metric[m].help, k_client_metric[m].name);
+        for (int i = 0; i < METRICS_MAX_CLIENTS; i++) {
+            const client_t *c = &s_client[i];
+            if (__atomic_load_n(&c->in_use, __ATOMIC_ACQUIRE) != 2) continue;
+            uint64_t v = m == 0 ? __atomic_load_n(&c->delivered, __ATOMIC_RELAXED)
+                       : m == 1 ? __atomic_load_n(&c->skipped, __ATOMIC_RELAXED)
+                       : __atomic_load_n(&c->bytes, __ATOMIC_RELAXED);
+            out_printf(&o, "%s{slot=\"%d\",kind=\"%s\",peer=\"%s\"} %llu\n",
+                       k_client_metric[m].name, i, c->kind, c->peer, (unsigned long long)v);
+        }
+    }
+
+    // Wi-Fi-Link-Profil (zum Abgleich mit den Sendezeiten)
+    wifi_link_status_t ls;
+    wifi_link_get_status(&ls);
+    out_printf(&o, "# HELP wifi_link_profile Link profile (0 = ECO power save, 1 = PERF)\n"
+                   "# TYPE wifi_link_profile gauge\nwifi_link_profile %d\n"
+                   "# HELP wifi_link_users Active streams/snapshots holding the PERF profile\n"
+                   "# TYPE wifi_link_users gauge\nwifi_link_users %d\n"
+                   "# HELP wifi_link_transitions_total Link profile changes\n"
+                   "# TYPE wifi_link_transitions_total counter\nwifi_link_transitions_total %lu\n"
+                   "# HELP wifi_link_profile_age_seconds Time since the last profile change\n"
+                   "# TYPE wifi_link_profile_age_seconds gauge\nwifi_link_profile_age_seconds %lld\n"
+                   "# HELP wifi_rssi_dbm RSSI of the associated AP\n"
+                   "# TYPE wifi_rssi_dbm gauge\nwifi_rssi_dbm %d\n"
+                   "# HELP wifi_bandwidth_mhz Channel width of the association (0 = not connected)\n"
+                   "# TYPE wifi_bandwidth_mhz gauge\nwifi_bandwidth_mhz %u\n",
+               (int)ls.profile, ls.users, (unsigned long)ls.transitions,
+               (long long)((esp_timer_get_time() - ls.since_us) / 1000000), ls.rssi,
+               ls.bw_mhz);
+    out_printf(&o, "# HELP wifi_rssi_avg_dbm Smoothed RSSI used for roaming decisions\n"
+                   "# TYPE wifi_rssi_avg_dbm gauge\nwifi_rssi_avg_dbm %d\n"
+                   "# HELP wifi_tcp_retransmit_percent TCP retransmits in the last window\n"
+                   "# TYPE wifi_tcp_retransmit_percent gauge\nwifi_tcp_retransmit_percent %u\n"
+                   "# HELP wifi_link_degraded Link below roaming thresholds\n"
+                   "# TYPE wifi_link_degraded gauge\nwifi_link_degraded %d\n"
+                   "# HELP wifi_roam_scans_total Opportunistic roaming scan rounds\n"
+                   "# TYPE wifi_roam_scans_total counter\nwifi_roam_scans_total %lu\n"
+                   "# HELP wifi_roams_total Successful roams to another AP\n"
+                   "# TYPE wifi_roams_total counter\nwifi_roams_total %lu\n",
+               ls.rssi_avg, (unsigned)ls.retx_pct, ls.degraded ? 1 : 0,
+               (unsigned long)ls.roam_scans, (unsigned long)ls.roams);
+
+    // Rechenzeit (für CPU pro Frame in tools/bench.py)
+    uint64_t busy_us, task_us[TASK_ID_COUNT];
+    char cpu[24];
+    task_prof_cpu(&busy_us, task_us);
+    fmt_value(cpu, sizeof(cpu), busy_us, true);
+    out_printf(&o, "# HELP process_cpu_seconds_total CPU time of all cores outside the idle tasks\n"
+                   "# TYPE process_cpu_seconds_total counter\nprocess_cpu_seconds_total %s\n"
+                   "# HELP task_cpu_seconds_total CPU time by task type\n"
+                   "# TYPE task_cpu_seconds_total counter\n", cpu);
+    for (int t = 0; t < TASK_ID_COUNT; t++) {
+        fmt_value(cpu, sizeof(cpu), task_us[t], true);
+        out_printf(&o, "task_cpu_seconds_total{task=\"%s\"} %s\n", task_place(t)->name, cpu);
+    }
+
+    // Heap und Laufzeit
+    out_printf(&o, "# HELP heap_free_bytes Free heap by region\n# TYPE heap_free_bytes gauge\n"
+                   "heap_free_bytes{region=\"internal\"} %u\nheap_free_bytes{region=\"psram\"} %u\n",
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    out_printf(&o, "# HELP heap_min_free_bytes Low-water mark of free heap\n"
+                   "# TYPE heap_min_free_bytes gauge\n"
+                   "heap_min_free_bytes{region=\"internal\"} %u\nheap_min_free_bytes{region=\"psram\"} %u\n",
+               (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+               (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    out_printf(&o, "# HELP uptime_seconds Time since boot\n# TYPE uptime_seconds gauge\n"
+                   "uptime_seconds %lld\n", (long long)(esp_timer_get_time() / 1000000));
+
+    out_flush(&o);
+    if (o.err != ESP_OK) return o.err;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
@@ -0,0 +1,54 @@
+// metrics.h — Zähler und Histogramme für /metrics (Prometheus-Textformat)
+//
+// Erfassen läuft über atomare Adds ohne Mutex und ist damit auch in der
+// Stream-Schleife vernachlässigbar; nur der /metrics-Handler liest alle Werte
+// zusammen. Lock-frei sind nur die 32-Bit-Werte (Bucket-Zähler): 64-Bit-
+// Atomics (Zähler, Histogramm-Summen, Bytes pro Client) hat Xtensa nicht,
+// libatomic setzt sie mit einer kurzen kritischen Sektion um.
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#define METRICS_MAX_CLIENTS  8      // gleichzeitig erfasste Stream-Clients
+
+typedef enum {
+    MET_H_FB_GET_US,        // Wartezeit in esp_camera_fb_get
+    MET_H_JPEG_BYTES,       // JPEG-Größe der Stream-Frames
+    MET_H_SEND_US,          // Sendedauer pro Frame (ein writev)
+    MET_H_MODE_SWITCH_US,   // Sensor-Moduswechsel
+    MET_H_HTTP_US,          // Laufzeit der URI-Handler
+    MET_H_AF_LOCK_US,       // Fokuszeit vor Snapshots (0 = Dauer-AF stand schon)
+    MET_H_BURST_FRAME_US,   // Abstand aufeinanderfolgender Burst-Frames
+    MET_H_WS_ACK_AGE_US,    // /ws: Aufnahme bis Quittung des Clients
+    MET_H_SENSOR_SEQ_US,    // Schreiben einer OV5640-Registersequenz
+    MET_H_THUMB_US,         // Verkleinerung eines Frames im DCT-Bereich
+    MET_H_COUNT
+} metrics_hist_t;
+
+typedef enum {
+    MET_C_FRAMES_CAPTURED,
+    MET_C_FRAMES_DROPPED,   // Ring konnte den Frame nicht ablegen (Speicher)
+    MET_C_FB_GET_FAIL,
+    MET_C_STREAM_FRAMES,    // an Clients ausgelieferte Frames
+    MET_C_STREAM_SKIPPED,   // bei Clients übersprungene Frames
+    MET_C_STREAM_BYTES,
+    MET_C_SNAPSHOTS,        // Aufnahmen im Snapshot-Modus
+    MET_C_SNAPSHOT_HITS,    // aus dem Cache beantwortet
+    MET_C_SNAPSHOT_BYTES,
+    MET_C_BURST_FRAMES,     // im Burst aufgenommene Frames
+    MET_C_HTTP_REQUESTS,
+    MET_C_COUNT
+} metrics_counter_t;
+
+void metrics_observe(metrics_hist_t h, uint32_t value);
+void metrics_add(metrics_counter_t c, uint32_t n);
+
+// Stream-Clients: Slot belegen (peer_fd für die Adresse), pro Frame melden,
+// beim Schließen freigeben. Ein Slot wird nur von seinem Sender-Task geschrieben.
+int  metrics_client_open(const char *kind, int peer_fd);
+void metrics_client_frame(int slot, uint32_t bytes, uint32_t skipped_total);
+void metrics_client_close(int slot);
+
+// HTTP-URI-Handler: /metrics
+esp_err_t metrics_handler(httpd_req_t *req);
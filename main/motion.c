@@ -0,0 +1,432 @@
+// motion.c — Bewegungserkennung aus den DC-Koeffizienten der Stream-JPEGs
+//
+// Pro Frame werden nur die Huffman-Daten dekodiert (keine IDCT); die
+// Luma-DC-Werte ergeben ein Helligkeitsbild mit 1/8 Auflösung, das zu
+// Zellen von 16×16 px (bei großen Frames mehr) zusammengefasst wird. Jede
+// Zelle wird mit einem laufenden Hintergrund verglichen; globale
+// Helligkeitssprünge (AEC) werden vorher herausgerechnet. Der Task liest als
+// normaler Client aus dem Frame-Ring und überspringt Frames, wenn er nicht
+// hinterherkommt — der Stream wird davon nie gebremst.
+#include "motion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "frame_ring.h"
+#include "jpeg_scan.h"
+#include "task_prof.h"
+
+static const char *TAG = "motion";
+
+#define MOTION_FRAME_TIMEOUT_MS 1000
+#define MOTION_IDLE_MS          500
+#define MOTION_ROI_MAX          8
+#define MOTION_MAX_CELLS        (MOTION_GRID_MAX_W * MOTION_GRID_MAX_H)
+#define MOTION_ENABLED_DEFAULT  false  // opt-in: der Leser hält den Capture-Task wach
+#define MOTION_LUMA_SHIFT       4      // Zellwerte in Luma × 16
+
+typedef struct { int x, y, w, h; } roi_rect_t;
+
+// Arbeitsdaten — nur der Motion-Task greift zu
+static jpeg_dec_t s_dec;
+static int32_t    s_cur[MOTION_MAX_CELLS];   // DC-Summe, dann Luma × 16
+static int16_t    s_bg[MOTION_MAX_CELLS];    // Hintergrund, Luma × 16
+static uint8_t    s_mask[MOTION_MAX_CELLS];  // 1 = Zelle in ROI
+static uint8_t    s_work_map[MOTION_MAX_CELLS];
+static int        s_gw, s_gh;
+static int        s_cell = MOTION_CELL_BLOCKS;  // Zellkante in Blöcken
+static uint32_t   s_bad_size;                   // zuletzt abgelehnte Größe (w << 16 | h)
+static bool       s_bg_valid;
+static int        s_quiet;
+
+// Gemeinsamer Zustand (unter s_lock)
+static SemaphoreHandle_t s_lock;
+static motion_params_t   s_params = {
+    .sensitivity = 12,
+    .min_cells   = 4,
+    .hold_frames = 15,
+    .bg_shift    = 3,
+};
+static motion_status_t s_status = { .enabled = MOTION_ENABLED_DEFAULT };
+static uint8_t    s_map[MOTION_MAX_CELLS];
+static roi_rect_t s_roi[MOTION_ROI_MAX];
+static int        s_roi_n;
+static bool       s_roi_dirty = true;
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+// Luma-DC eines Blocks in seine Zelle aufsummieren
+static void dc_block_cb(void *ctx, int comp, int bx, int by, const int16_t *coef)
+{
+    int cx = bx / s_cell, cy = by / s_cell;
+    if (cx < s_gw && cy < s_gh) {
+        s_cur[cy * s_gw + cx] += coef[0];
+    }
+}
+
+// DC-Summe → mittlere Helligkeit × 16 (DC = 8 × (Mittelwert − 128))
+static void cells_to_luma(int n)
+{
+    const int div = s_cell * s_cell * 8;
+    for (int i = 0; i < n; i++) {
+        s_cur[i] = s_cur[i] * (1 << MOTION_LUMA_SHIFT) / div + (128 << MOTION_LUMA_SHIFT);
+    }
+}
+
+// Differenzkarte gegen den Hintergrund; liefert Anzahl geänderter Zellen
+static int diff_map(int n, int threshold)
+{
+    // Globale Helligkeitsänderung über die ROI herausrechnen
+    int32_t sum = 0;
+    int cnt = 0;
+    for (int i = 0; i < n; i++) {
+        if (s_mask[i]) {
+            sum += s_cur[i] - s_bg[i];
+            cnt++;
+        }
+    }
+    int off = cnt ? sum / cnt : 0;
+
+    int changed = 0;
+    for (int i = 0; i < n; i++) {
+        int d = s_cur[i] - s_bg[i] - off;
+        uint8_t hit = s_mask[i] && (d > threshold || d < -threshold);
+        s_work_map[i] = hit;
+        changed += hit;
+    }
+    return changed;
+}
+
+// Hintergrund nachführen; geänderte Zellen lernen 8× langsamer (kein Einbrennen)
+static void update_background(int n, int shift)
+{
+    for (int i = 0; i < n; i++) {
+        int sh = s_work_map[i] ? shift + 3 : shift;
+        s_bg[i] += (s_cur[i] - s_bg[i]) / (1 << sh);
+    }
+}
+
+// ROI-Rechtecke (Prozent) auf das aktuelle Zellraster abbilden
+static void rebuild_mask(const roi_rect_t *roi, int n_roi)
+{
+    for (int cy = 0; cy < s_gh; cy++) {
+        for (int cx = 0; cx < s_gw; cx++) {
+            uint8_t on = n_roi == 0;
+            int px = (2 * cx + 1) * 100 / (2 * s_gw);   // Zellmitte in %
+            int py = (2 * cy + 1) * 100 / (2 * s_gh);
+            for (int r = 0; r < n_roi && !on; r++) {
+                on = px >= roi[r].x && px < roi[r].x + roi[r].w &&
+                     py >= roi[r].y && py < roi[r].y + roi[r].h;
+            }
+            s_mask[cy * s_gw + cx] = on;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Auswertung eines Frames
+// ---------------------------------------------------------------------------
+static void process_frame(const frame_t *f)
+{
+    int64_t t0 = esp_timer_get_time();
+    if (jpeg_dec_parse(&s_dec, f->buf, f->len) != ESP_OK) return;
+
+    // Kleinste Zelle, mit der das Raster in die festen Puffer passt
+    int bw = s_dec.info.width / 8, bh = s_dec.info.height / 8;
+    int cell = MOTION_CELL_BLOCKS;
+    while (bw / cell > MOTION_GRID_MAX_W || bh / cell > MOTION_GRID_MAX_H) cell++;
+    int gw = bw / cell, gh = bh / cell;
+    if (gw < 1 || gh < 1) {
+        // Nur einmal pro Größe melden, nicht bei jedem Frame
+        uint32_t size = (uint32_t)s_dec.info.width << 16 | s_dec.info.height;
+        if (size != s_bad_size) {
+            ESP_LOGW(TAG, "frame %ux%u too small for motion grid",
+                     s_dec.info.width, s_dec.info.height);
+            s_bad_size = size;
+        }
+        return;
+    }
+    s_bad_size = 0;
+
+    motion_params_t p;
+    roi_rect_t roi[MOTION_ROI_MAX];
+    int n_roi = 0;
+    bool roi_dirty;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    p = s_params;
+    roi_dirty = s_roi_dirty;
+    if (roi_dirty) {
+        n_roi = s_roi_n;
+        memcpy(roi, s_roi, sizeof(roi));
+        s_roi_dirty = false;
+    }
+    xSemaphoreGive(s_lock);
+
+    // Neue Auflösung (Moduswechsel, Bitratenregler): Hintergrund neu lernen
+    if (gw != s_gw || gh != s_gh || cell != s_cell) {
+        s_gw = gw;
+        s_gh = gh;
+        s_cell = cell;
+        s_bg_valid = false;
+        if (!roi_dirty) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            n_roi = s_roi_n;
+            memcpy(roi, s_roi, sizeof(roi));
+            xSemaphoreGive(s_lock);
+            roi_dirty = true;
+        }
+    }
+    if (roi_dirty) rebuild_mask(roi, n_roi);
+
+    int n = gw * gh;
+    memset(s_cur, 0, n * sizeof(s_cur[0]));
+    if (jpeg_dec_scan(&s_dec, 1, 1u << 0, dc_block_cb, NULL) != ESP_OK) return;
+    cells_to_luma(n);
+
+    int changed = 0;
+    if (!s_bg_valid) {
+        for (int i = 0; i < n; i++) s_bg[i] = (int16_t)s_cur[i];
+        memset(s_work_map, 0, n);
+        s_bg_valid = true;
+    } else {
+        changed = diff_map(n, p.sensitivity << MOTION_LUMA_SHIFT);
+        update_background(n, p.bg_shift);
+    }
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    // Ergebnis veröffentlichen
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    motion_status_t *st = &s_status;
+    st->grid_w  = gw;
+    st->grid_h  = gh;
+    st->cell_px = cell * 8;
+    st->changed = changed;
+    st->frames++;
+    st->proc_us = st->proc_us ? st->proc_us + ((int32_t)(us - st->proc_us) >> 3) : us;
+    if (changed >= p.min_cells) {
+        s_quiet = 0;
+        st->last_motion_us = esp_timer_get_time();
+        if (!st->motion) {
+            st->motion = true;
+            st->events++;
+            ESP_LOGI(TAG, "motion start (%d cells)", changed);
+        }
+    } else if (st->motion && ++s_quiet >= p.hold_frames) {
+        st->motion = false;
+        ESP_LOGI(TAG, "motion end");
+    }
+    memcpy(s_map, s_work_map, n);
+    xSemaphoreGive(s_lock);
+}
+
+static void motion_task(void *arg)
+{
+    frame_reader_t *rd = NULL;
+    while (1) {
+        if (!s_status.enabled) {
+            if (rd) {
+                frame_ring_reader_close(rd);
+                rd = NULL;
+            }
+            vTaskDelay(pdMS_TO_TICKS(MOTION_IDLE_MS));
+            continue;
+        }
+        if (!rd) {
+            rd = frame_ring_reader_open();
+            s_bg_valid = false;
+            if (!rd) {
+                vTaskDelay(pdMS_TO_TICKS(MOTION_IDLE_MS));
+                continue;
+            }
+        }
+        const frame_t *f = frame_ring_next(rd, pdMS_TO_TICKS(MOTION_FRAME_TIMEOUT_MS));
+        if (!f) continue;
+        process_frame(f);
+        frame_ring_release(f);
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_status.skipped = frame_ring_reader_dropped(rd);
+        xSemaphoreGive(s_lock);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// API
+// ---------------------------------------------------------------------------
+esp_err_t motion_init(void)
+{
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) return ESP_ERR_NO_MEM;
+    if (task_create(TASK_MOTION, motion_task, NULL, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "motion detection %s", s_status.enabled ? "enabled" : "disabled");
+    return ESP_OK;
+}
+
+void motion_enable(bool on)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_status.enabled = on;
+    if (!on) s_status.motion = false;
+    xSemaphoreGive(s_lock);
+}
+
+void motion_get_params(motion_params_t *p)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *p = s_params;
+    xSemaphoreGive(s_lock);
+}
+
+void motion_set_params(const motion_params_t *p)
+{
+    motion_params_t v = *p;
+    if (v.sensitivity < 1)   v.sensitivity = 1;
+    if (v.sensitivity > 255) v.sensitivity = 255;
+    if (v.min_cells < 1)     v.min_cells = 1;
+    if (v.hold_frames < 0)   v.hold_frames = 0;
+    if (v.bg_shift < 0)      v.bg_shift = 0;
+    if (v.bg_shift > 8)      v.bg_shift = 8;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_params = v;
+    xSemaphoreGive(s_lock);
+}
+
+void motion_roi_clear(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_roi_n = 0;
+    s_roi_dirty = true;
+    xSemaphoreGive(s_lock);
+}
+
+esp_err_t motion_roi_add(int x, int y, int w, int h)
+{
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > 100 || y + h > 100) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_roi_n < MOTION_ROI_MAX) {
+        s_roi[s_roi_n++] = (roi_rect_t){ x, y, w, h };
+        s_roi_dirty = true;
+    } else {
+        err = ESP_ERR_NO_MEM;
+    }
+    xSemaphoreGive(s_lock);
+    return err;
+}
+
+void motion_get_status(motion_status_t *st)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *st = s_status;
+    xSemaphoreGive(s_lock);
+}
+
+int motion_get_map(uint8_t *map, int max_cells, int *grid_w, int *grid_h)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int n = s_status.grid_w * s_status.grid_h;
+    if (n > max_cells) n = 0;
+    memcpy(map, s_map, n);
+    *grid_w = n ? s_status.grid_w : 0;
+    *grid_h = n ? s_status.grid_h : 0;
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// HTTP: /motion?sensitivity=12&min_cells=4&hold=15&bg_shift=3
+//              &roi=x,y,w,h[;x,y,w,h]|all&enable=0|1&map=1
+// ---------------------------------------------------------------------------
+static esp_err_t apply_query(const char *q)
+{
+    char val[96];
+    motion_params_t p;
+    motion_get_params(&p);
+    if (httpd_query_key_value(q, "sensitivity", val, sizeof(val)) == ESP_OK) p.sensitivity = atoi(val);
+    if (httpd_query_key_value(q, "min_cells",   val, sizeof(val)) == ESP_OK) p.min_cells   = atoi(val);
+    if (httpd_query_key_value(q, "hold",        val, sizeof(val)) == ESP_OK) p.hold_frames = atoi(val);
+    if (httpd_query_key_value(q, "bg_shift",    val, sizeof(val)) == ESP_OK) p.bg_shift    = atoi(val);
+    motion_set_params(&p);
+
+    if (httpd_query_key_value(q, "enable", val, sizeof(val)) == ESP_OK) {
+        motion_enable(atoi(val) != 0);
+    }
+    if (httpd_query_key_value(q, "roi", val, sizeof(val)) == ESP_OK) {
+        motion_roi_clear();
+        if (strcmp(val, "all") != 0) {
+            char *save = NULL;
+            for (char *r = strtok_r(val, ";", &save); r; r = strtok_r(NULL, ";", &save)) {
+                int x, y, w, h;
+                if (sscanf(r, "%d,%d,%d,%d", &x, &y, &w, &h) != 4 ||
+                    motion_roi_add(x, y, w, h) != ESP_OK) {
+                    return ESP_ERR_INVALID_ARG;
+                }
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t motion_handler(httpd_req_t *req)
+{
+    char query[160];
+    bool with_map = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (apply_query(query) != ESP_OK) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "bad roi");
+        }
+        char val[4];
+        with_map = httpd_query_key_value(query, "map", val, sizeof(val)) == ESP_OK &&
+                   atoi(val) != 0;
+    }
+
+    motion_status_t st;
+    motion_params_t p;
+    motion_get_status(&st);
+    motion_get_params(&p);
+    int64_t ago_ms = st.last_motion_us ? (esp_timer_get_time() - st.last_motion_us) / 1000 : -1;
+
+    char buf[384];
+    snprintf(buf, sizeof(buf),
+             "{\"enabled\":%s,\"motion\":%s,\"changed\":%d,\"grid\":[%d,%d],\"cell_px\":%d,"
+             "\"events\":%lu,\"last_motion_ms_ago\":%lld,\"frames\":%lu,\"skipped\":%lu,"
+             "\"proc_us\":%lu,\"params\":{\"sensitivity\":%d,\"min_cells\":%d,"
+             "\"hold\":%d,\"bg_shift\":%d}",
+             st.enabled ? "true" : "false", st.motion ? "true" : "false",
+             st.changed, st.grid_w, st.grid_h, st.cell_px,
+             (unsigned long)st.events, (long long)ago_ms,
+             (unsigned long)st.frames, (unsigned long)st.skipped,
+             (unsigned long)st.proc_us,
+             p.sensitivity, p.min_cells, p.hold_frames, p.bg_shift);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, buf);
+
+    if (with_map) {
+        // Karte zeilenweise als "0"/"1"-Strings (httpd-Worker ist einthreadig)
+        static uint8_t map[MOTION_MAX_CELLS];
+        int gw, gh;
+        motion_get_map(map, MOTION_MAX_CELLS, &gw, &gh);
+        httpd_resp_sendstr_chunk(req, ",\"map\":[");
+        char row[MOTION_GRID_MAX_W + 4];
+        for (int y = 0; y < gh; y++) {
+            int k = 0;
+            if (y) row[k++] = ',';
+            row[k++] = '"';
+            for (int x = 0; x < gw; x++) row[k++] = map[y * gw + x] ? '1' : '0';
+            row[k++] = '"';
+            row[k] = '\0';
+            httpd_resp_sendstr_chunk(req, row);
+        }
+        httpd_resp_sendstr_chunk(req, "]");
+    }
+    httpd_resp_sendstr_chunk(req, "}");
+    return httpd_resp_sendstr_chunk(req, NULL);
+}
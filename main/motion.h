@@ -0,0 +1,55 @@
+// motion.h — Bewegungserkennung auf den Stream-Frames (Luma-DC-Koeffizienten)
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// Zelle = MOTION_CELL_BLOCKS × MOTION_CELL_BLOCKS Luma-Blöcke (16×16 px).
+// Ab XGA werden die Zellen größer (3×3, 4×4 Blöcke …), damit das Raster in
+// MOTION_GRID_MAX_W × MOTION_GRID_MAX_H passt.
+#define MOTION_CELL_BLOCKS  2
+#define MOTION_GRID_MAX_W   50      // SVGA (800 px Breite) mit 16-px-Zellen
+#define MOTION_GRID_MAX_H   38      // SVGA (600 px Höhe) mit 16-px-Zellen
+
+typedef struct {
+    int sensitivity;   // Schwelle |Δ Helligkeit| pro Zelle (Luma 1..255)
+    int min_cells;     // geänderte Zellen, ab denen Bewegung gemeldet wird
+    int hold_frames;   // Bewegung bleibt so viele ruhige Frames aktiv
+    int bg_shift;      // Hintergrund lernt mit 1/2^bg_shift pro Frame
+} motion_params_t;
+
+typedef struct {
+    bool     enabled;
+    bool     motion;
+    int      changed;          // geänderte Zellen im letzten Frame
+    int      grid_w, grid_h;
+    int      cell_px;          // Zellkante in Pixeln
+    uint32_t frames;           // ausgewertete Frames
+    uint32_t skipped;          // übersprungene Frames (Erkennung zu langsam)
+    uint32_t events;           // Übergänge ruhig → Bewegung
+    int64_t  last_motion_us;   // esp_timer-Zeit der letzten Bewegung
+    uint32_t proc_us;          // Rechenzeit pro Frame (EWMA)
+} motion_status_t;
+
+// Erkennungs-Task starten (liest den Frame-Ring)
+esp_err_t motion_init(void);
+
+// Standard aus (/motion?enable=1): eingeschaltet belegt die Erkennung einen
+// Ring-Leser und hält damit die Kamera auch ohne Clients in Betrieb
+void motion_enable(bool on);
+void motion_get_params(motion_params_t *p);
+void motion_set_params(const motion_params_t *p);
+
+// ROI in Prozent des Bildes; mehrere Rechtecke werden vereinigt.
+// motion_roi_clear() schaltet wieder das ganze Bild aktiv.
+void motion_roi_clear(void);
+esp_err_t motion_roi_add(int x, int y, int w, int h);
+
+void motion_get_status(motion_status_t *st);
+
+// Geänderte Zellen des letzten Frames (1 Byte pro Zelle, zeilenweise)
+int motion_get_map(uint8_t *map, int max_cells, int *grid_w, int *grid_h);
+
+// HTTP-URI-Handler: Status/Map als JSON, Parameter per Query
+esp_err_t motion_handler(httpd_req_t *req);
@@ -0,0 +1,151 @@
+// ov5640_ae.c — Belichtungsübergabe Stream → Snapshot für den OV5640
+//
+// Nach einem Moduswechsel braucht die AEC/AGC-Regelung mehrere Frames, bis
+// sie wieder passt; der erste 5-MP-Frame wäre falsch belichtet. Stattdessen
+// wird die im Stream eingeschwungene Belichtung übernommen: Belichtungszeit
+// in Sekunden = Zeilen × HTS / Systemtakt, Helligkeit = Zeit × Verstärkung.
+// Beides bleibt beim Wechsel gleich, nur die Zeilenzahl wird auf HTS und
+// Takt des Snapshot-Modus umgerechnet (wie OmniVisions Capture-Ablauf und
+// der Linux-Treiber). Passt die Zeit nicht in den Frame (VTS), übernimmt die
+// Verstärkung den Rest, statt den Frame zu verlängern.
+#include "ov5640_ae.h"
+#include "esp_log.h"
+#include "ov5640_regs.h"
+#include "ov5640_seq.h"
+
+static const char *TAG = "ov5640_ae";
+
+#define AE_GROUP          0x02     // Group-Hold-Puffer für Belichtung + Verstärkung
+#define AE_VTS_MARGIN     4        // Zeilen, die die Belichtung unter VTS bleiben muss
+#define AE_GAIN16_MIN     16       // 1x
+#define AE_GAIN16_MAX     0x3FF    // 10 Bit, knapp 64x
+
+static const ov5640_reg_t k_ae_manual_regs[] = {
+    { AEC_PK_MANUAL, AEC_PK_MANUAL_AGC_MANUALEN | AEC_PK_MANUAL_AEC_MANUALEN, 0x03, 0 },
+};
+static const ov5640_seq_t k_ae_manual = OV5640_SEQ("ae_manual", k_ae_manual_regs);
+
+// Systemtakt aus den PLL-Registern (wie ov5640_get_sysclk in Linux)
+static esp_err_t read_sysclk_khz(sensor_t *s, uint32_t *khz)
+{
+    static const uint8_t sclk_rdiv[4] = { 1, 2, 4, 8 };
+    uint8_t pll[4], root;
+    esp_err_t err = ov5640_seq_read(s, SC_PLL_CTRL0, pll, sizeof(pll));
+    if (err == ESP_OK) err = ov5640_seq_read(s, SYSTEM_ROOT_DIVIDER, &root, 1);
+    if (err != ESP_OK) return err;
+
+    uint32_t bit_div2x = (pll[0] & 0x0F) == 8 || (pll[0] & 0x0F) == 10 ? (pll[0] & 0x0F) / 2 : 1;
+    uint32_t sysdiv    = pll[1] >> 4 ? pll[1] >> 4 : 16;
+    uint32_t mult      = pll[2];
+    uint32_t prediv    = pll[3] & 0x0F ? pll[3] & 0x0F : 1;
+    uint32_t pll_rdiv  = ((pll[3] >> 4) & 0x01) + 1;
+    uint32_t vco       = (uint32_t)(s->xclk_freq_hz / 1000) * mult / prediv;
+    *khz = vco / sysdiv / pll_rdiv * 2 / bit_div2x / sclk_rdiv[root & 0x03];
+    return *khz ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
+
+// HTS, VTS und Binning des aktuellen Modus
+static esp_err_t read_timing(sensor_t *s, uint16_t *hts, uint16_t *vts, bool *binning)
+{
+    uint8_t t[4], tc20;
+    esp_err_t err = ov5640_seq_read(s, X_TOTAL_SIZE_H, t, sizeof(t));
+    if (err == ESP_OK) err = ov5640_seq_read(s, TIMING_TC_REG20, &tc20, 1);
+    if (err != ESP_OK) return err;
+    *hts = (t[0] & 0x0F) << 8 | t[1];
+    *vts = t[2] << 8 | t[3];
+    *binning = tc20 & 0x01;
+    return *hts ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
+
+esp_err_t ov5640_ae_hold(sensor_t *s, ov5640_ae_t *ae)
+{
+    ae->held = false;
+    if (s->id.PID != OV5640_PID) return ESP_ERR_NOT_SUPPORTED;
+
+    // 0x3500–0x350B in einem Zug: Belichtung, Manuell-Bits, Verstärkung
+    uint8_t r[12];
+    uint16_t vts;
+    bool binning;
+    esp_err_t err = ov5640_seq_read(s, AEC_PK_EXPOSURE_HI, r, sizeof(r));
+    if (err != ESP_OK) return err;
+    if (r[AEC_PK_MANUAL - AEC_PK_EXPOSURE_HI] & 0x03) {
+        return ESP_ERR_NOT_SUPPORTED;        // Belichtung vom Benutzer fest eingestellt
+    }
+    err = read_timing(s, &ae->hts, &vts, &binning);
+    if (err == ESP_OK) err = read_sysclk_khz(s, &ae->sysclk_khz);
+    if (err != ESP_OK) return err;
+
+    ae->exp_raw[0]  = r[0];
+    ae->exp_raw[1]  = r[1];
+    ae->exp_raw[2]  = r[2];
+    ae->gain_raw[0] = r[AEC_PK_REAL_GAIN_HI - AEC_PK_EXPOSURE_HI];
+    ae->gain_raw[1] = r[AEC_PK_REAL_GAIN_LO - AEC_PK_EXPOSURE_HI];
+    ae->shutter = ((r[0] & 0x0F) << 16 | r[1] << 8 | r[2]) >> 4;
+    if (binning) ae->shutter *= 2;           // gebinnte Zeile = zwei Sensorzeilen
+    ae->gain16  = (ae->gain_raw[0] & 0x03) << 8 | ae->gain_raw[1];
+
+    err = ov5640_seq_apply(s, &k_ae_manual, 0, NULL);
+    if (err != ESP_OK) return err;
+    ae->held = true;
+    return ESP_OK;
+}
+
+esp_err_t ov5640_ae_transfer(sensor_t *s, const ov5640_ae_t *ae)
+{
+    uint16_t hts, vts;
+    bool binning;
+    uint32_t sysclk;
+    esp_err_t err = read_timing(s, &hts, &vts, &binning);
+    if (err == ESP_OK) err = read_sysclk_khz(s, &sysclk);
+    if (err != ESP_OK) return err;
+
+    // Helligkeit als Verstärkung × 16 × Zeilen im neuen Timing
+    uint64_t total = (uint64_t)ae->gain16 * ae->shutter * sysclk * ae->hts /
+                     ((uint64_t)ae->sysclk_khz * hts);
+    if (binning) total /= 2;
+    uint32_t max_lines = vts > AE_VTS_MARGIN + 1 ? vts - AE_VTS_MARGIN : 1;
+    uint32_t shutter = total / AE_GAIN16_MIN;
+    if (shutter > max_lines) shutter = max_lines;
+    if (shutter < 1) shutter = 1;
+    uint32_t gain16 = total / shutter;
+    if (gain16 < AE_GAIN16_MIN) gain16 = AE_GAIN16_MIN;
+    if (gain16 > AE_GAIN16_MAX) gain16 = AE_GAIN16_MAX;   // zu dunkel: lieber unterbelichtet
+
+    const uint32_t e = shutter << 4;
+    const ov5640_reg_t regs[] = {
+        { SYSTEM_GROUP_ACCESS, AE_GROUP, OV5640_STROBE, 0 },
+        { AEC_PK_EXPOSURE_HI,  (e >> 16) & 0x0F, 0xFF, 0 },
+        { AEC_PK_EXPOSURE_MD,  (e >> 8) & 0xFF,  0xFF, 0 },
+        { AEC_PK_EXPOSURE_LO,  e & 0xFF,         0xFF, 0 },
+        { AEC_PK_REAL_GAIN_HI, gain16 >> 8,      0xFF, 0 },
+        { AEC_PK_REAL_GAIN_LO, gain16 & 0xFF,    0xFF, 0 },
+        { SYSTEM_GROUP_ACCESS, 0x10 | AE_GROUP, OV5640_STROBE, 0 },   // Hold-Ende
+        { SYSTEM_GROUP_ACCESS, 0xA0 | AE_GROUP, OV5640_STROBE, 0 },   // Launch am Frame-Beginn
+    };
+    const ov5640_seq_t seq = { "ae_transfer", regs, sizeof(regs) / sizeof(regs[0]) };
+    err = ov5640_seq_apply(s, &seq, 0, NULL);
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "exposure %lu -> %lu lines, gain %u/16 -> %lu/16 "
+                 "(hts %u -> %u, sysclk %lu -> %lu kHz)",
+                 (unsigned long)ae->shutter, (unsigned long)shutter, ae->gain16,
+                 (unsigned long)gain16, ae->hts, hts,
+                 (unsigned long)ae->sysclk_khz, (unsigned long)sysclk);
+    }
+    return err;
+}
+
+esp_err_t ov5640_ae_release(sensor_t *s, ov5640_ae_t *ae)
+{
+    if (!ae->held) return ESP_OK;
+    ae->held = false;
+    const ov5640_reg_t regs[] = {
+        { AEC_PK_EXPOSURE_HI,  ae->exp_raw[0],  0xFF, 0 },
+        { AEC_PK_EXPOSURE_MD,  ae->exp_raw[1],  0xFF, 0 },
+        { AEC_PK_EXPOSURE_LO,  ae->exp_raw[2],  0xFF, 0 },
+        { AEC_PK_REAL_GAIN_HI, ae->gain_raw[0], 0xFF, 0 },
+        { AEC_PK_REAL_GAIN_LO, ae->gain_raw[1], 0xFF, 0 },
+        { AEC_PK_MANUAL,       0x00,            0x03, 0 },   // AEC/AGC wieder automatisch
+    };
+    const ov5640_seq_t seq = { "ae_release", regs, sizeof(regs) / sizeof(regs[0]) };
+    return ov5640_seq_apply(s, &seq, 0, NULL);
+}
@@ -0,0 +1,30 @@
+// ov5640_ae.h — Belichtung und Verstärkung vom Stream an den Snapshot übergeben
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor.h"
+
+// Eingefrorener Zustand des Stream-Modus
+typedef struct {
+    bool     held;        // AEC/AGC stehen auf manuell, Rückgabe ausstehend
+    uint8_t  exp_raw[3];  // 0x3500–0x3502 unverändert (für die Rückgabe)
+    uint8_t  gain_raw[2]; // 0x350A–0x350B
+    uint32_t shutter;     // Belichtung in Zeilen ohne Binning
+    uint16_t gain16;      // Verstärkung × 16
+    uint16_t hts;         // Zeilenlänge in Takten
+    uint32_t sysclk_khz;
+} ov5640_ae_t;
+
+// Konvergierte Werte des laufenden Modus lesen und AEC/AGC auf manuell
+// stellen. ESP_ERR_NOT_SUPPORTED ohne OV5640 oder bei manueller Belichtung.
+// Alle Aufrufe: Aufrufer hält die Kamera-Sperre.
+esp_err_t ov5640_ae_hold(sensor_t *s, ov5640_ae_t *ae);
+
+// Nach dem Moduswechsel: gleiche Belichtungszeit und Helligkeit für das neue
+// Timing (HTS, VTS, Systemtakt) umrechnen und vor dem ersten Frame laden
+esp_err_t ov5640_ae_transfer(sensor_t *s, const ov5640_ae_t *ae);
+
+// Zurück im Stream-Modus: eingefrorene Werte zurückschreiben und AEC/AGC
+// wieder einschalten, damit die Regelung dort weitermacht
+esp_err_t ov5640_ae_release(sensor_t *s, ov5640_ae_t *ae);
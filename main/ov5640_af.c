@@ -0,0 +1,167 @@
+// ov5640_af.c — Autofokus-MCU des OV5640: Firmware-Download und Befehle
+//
+// Den Fokus regelt ein 8051 im Sensor. Seine Firmware (OmniVision, ~4 KB)
+// wird beim Start per SCCB-Burst ab AF_FW_BASE geladen; danach nimmt die MCU
+// Befehle über AF_CMD_MAIN an und quittiert sie, indem sie AF_CMD_ACK löscht.
+// AF_FW_STATUS meldet, ob gerade fokussiert wird oder die Linse steht.
+//
+// Die Firmware liegt nicht im Repository: sie wird aus main/ov5640_af_fw.h
+// übernommen (Array ov5640_af_fw[]), wenn die Datei existiert. Ohne sie
+// bleibt der Autofokus aus, Snapshots nehmen dann ohne Fokuslauf auf.
+#include "ov5640_af.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ov5640_regs.h"
+#include "ov5640_seq.h"
+
+#if __has_include("ov5640_af_fw.h")
+#include "ov5640_af_fw.h"
+#define AF_HAVE_FW 1
+#else
+#define AF_HAVE_FW 0
+#endif
+
+static const char *TAG = "ov5640_af";
+
+#define AF_CMD_SINGLE      0x03
+#define AF_CMD_CONTINUOUS  0x04
+#define AF_CMD_PAUSE       0x06    // Linse auf aktueller Position halten
+
+#define AF_STA_FOCUSING    0x00
+#define AF_STA_FOCUSED     0x10
+#define AF_STA_IDLE        0x70    // Firmware läuft, Fokus gelöst
+#define AF_STA_NOT_RUNNING 0x7F
+
+#define AF_FW_READY_MS     1000    // Start der MCU nach dem Download
+#define AF_ACK_TIMEOUT_MS  100
+#define AF_POLL_MS         10
+
+static bool s_ready;
+
+#if AF_HAVE_FW
+// Vor dem Download: MCU im Reset halten
+static const ov5640_reg_t k_af_halt_regs[] = {
+    { SYSTEM_RESET00, 0x20, 0xFF, 0 },
+};
+// Nach dem Download: Befehls- und Statusregister (0x3022–0x3029, ein Burst)
+// vorbelegen, dann die MCU freigeben
+static const ov5640_reg_t k_af_start_regs[] = {
+    { AF_CMD_MAIN,      0x00, 0xFF, 0 },
+    { AF_CMD_ACK,       0x00, 0xFF, 0 },
+    { AF_CMD_PARA0,     0x00, 0xFF, 0 },
+    { AF_CMD_PARA0 + 1, 0x00, 0xFF, 0 },
+    { AF_CMD_PARA0 + 2, 0x00, 0xFF, 0 },
+    { AF_CMD_PARA0 + 3, 0x00, 0xFF, 0 },
+    { AF_CMD_PARA4,     0x00, 0xFF, 0 },
+    { AF_FW_STATUS,     AF_STA_NOT_RUNNING, 0xFF, 0 },
+    { SYSTEM_RESET00,   0x00, 0xFF, 0 },
+};
+static const ov5640_seq_t k_af_halt  = OV5640_SEQ("af_halt", k_af_halt_regs);
+static const ov5640_seq_t k_af_start = OV5640_SEQ("af_start", k_af_start_regs);
+#endif
+
+static void af_poll_delay(void)
+{
+    TickType_t t = pdMS_TO_TICKS(AF_POLL_MS);
+    vTaskDelay(t ? t : 1);
+}
+
+// Befehl an die MCU; wartet, bis sie ihn quittiert
+static esp_err_t af_cmd(sensor_t *s, uint8_t cmd)
+{
+    if (!s_ready) return ESP_ERR_INVALID_STATE;
+    if (s->set_reg(s, AF_CMD_ACK, 0xFF, 0x01) != 0 ||
+        s->set_reg(s, AF_CMD_MAIN, 0xFF, cmd) != 0) {
+        return ESP_FAIL;
+    }
+    int64_t end = esp_timer_get_time() + AF_ACK_TIMEOUT_MS * 1000LL;
+    do {
+        if (s->get_reg(s, AF_CMD_ACK, 0xFF) == 0) return ESP_OK;
+        af_poll_delay();
+    } while (esp_timer_get_time() < end);
+    ESP_LOGW(TAG, "command 0x%02x not acknowledged", cmd);
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t ov5640_af_init(sensor_t *s)
+{
+    s_ready = false;
+    if (s->id.PID != OV5640_PID) return ESP_ERR_NOT_SUPPORTED;
+#if !AF_HAVE_FW
+    ESP_LOGW(TAG, "no AF firmware (main/ov5640_af_fw.h), autofocus disabled");
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    // MCU anhalten, Programm per Burst laden und prüfen, Befehlsregister
+    // leeren, MCU starten
+    ov5640_seq_stat_t dl;
+    esp_err_t err = ov5640_seq_apply(s, &k_af_halt, 0, NULL);
+    if (err == ESP_OK) {
+        err = ov5640_seq_write_block(s, AF_FW_BASE, ov5640_af_fw, sizeof(ov5640_af_fw),
+                                     OV5640_SEQ_VERIFY, &dl);
+    }
+    if (err == ESP_OK) err = ov5640_seq_apply(s, &k_af_start, OV5640_SEQ_VERIFY, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "firmware download failed: 0x%x", err);
+        return ESP_FAIL;
+    }
+    int64_t t_dl = esp_timer_get_time();
+
+    int st = -1;
+    while (esp_timer_get_time() - t_dl < AF_FW_READY_MS * 1000LL) {
+        st = s->get_reg(s, AF_FW_STATUS, 0xFF);
+        if (st == AF_STA_IDLE) break;
+        af_poll_delay();
+    }
+    if (st != AF_STA_IDLE) {
+        ESP_LOGE(TAG, "AF MCU not ready, status 0x%02x", st);
+        return ESP_ERR_TIMEOUT;
+    }
+    s_ready = true;
+    ESP_LOGI(TAG, "AF firmware %u bytes loaded and verified in %lld ms (%u transfers), "
+             "MCU ready after %lld ms",
+             (unsigned)sizeof(ov5640_af_fw), (long long)(dl.us / 1000), dl.xfers,
+             (long long)((esp_timer_get_time() - t_dl) / 1000));
+    return ESP_OK;
+#endif
+}
+
+bool ov5640_af_ready(void)
+{
+    return s_ready;
+}
+
+esp_err_t ov5640_af_continuous(sensor_t *s)
+{
+    return af_cmd(s, AF_CMD_CONTINUOUS);
+}
+
+esp_err_t ov5640_af_pause(sensor_t *s)
+{
+    return af_cmd(s, AF_CMD_PAUSE);
+}
+
+bool ov5640_af_focused(sensor_t *s)
+{
+    return s_ready && s->get_reg(s, AF_FW_STATUS, 0xFF) == AF_STA_FOCUSED;
+}
+
+esp_err_t ov5640_af_single(sensor_t *s, int timeout_ms, int64_t *lock_us)
+{
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = af_cmd(s, AF_CMD_SINGLE);
+    if (err == ESP_OK) {
+        err = ESP_ERR_TIMEOUT;
+        while (esp_timer_get_time() - t0 < timeout_ms * 1000LL) {
+            if (s->get_reg(s, AF_FW_STATUS, 0xFF) == AF_STA_FOCUSED) {
+                err = ESP_OK;
+                break;
+            }
+            af_poll_delay();
+        }
+    }
+    if (lock_us) *lock_us = esp_timer_get_time() - t0;
+    if (err != ESP_OK) ESP_LOGW(TAG, "single AF: no lock (0x%x)", err);
+    return err;
+}
@@ -0,0 +1,27 @@
+// ov5640_af.h — Autofokus des OV5640 (Firmware auf der Sensor-MCU)
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor.h"
+
+// Firmware laden und auf die MCU warten. ESP_ERR_NOT_SUPPORTED, wenn der
+// Sensor kein OV5640 ist oder main/ov5640_af_fw.h fehlt. Alle Aufrufe greifen
+// auf den Sensor zu: Aufrufer hält die Kamera-Sperre.
+esp_err_t ov5640_af_init(sensor_t *s);
+
+// Firmware läuft und nimmt Befehle an
+bool ov5640_af_ready(void);
+
+// Dauer-Autofokus (folgt dem Bild, während gestreamt wird)
+esp_err_t ov5640_af_continuous(sensor_t *s);
+
+// Linse auf der aktuellen Position festhalten
+esp_err_t ov5640_af_pause(sensor_t *s);
+
+// Fokus steht (Dauer- oder Einzel-AF hat scharf gestellt)
+bool ov5640_af_focused(sensor_t *s);
+
+// Einzelfokus auslösen und bis zu timeout_ms auf Schärfe warten.
+// *lock_us erhält die Dauer bis zum Fokus (auch bei Timeout).
+esp_err_t ov5640_af_single(sensor_t *s, int timeout_ms, int64_t *lock_us);
@@ -5,6 +5,8 @@
 #define __OV5640_REG_REGS_H__
 
 /* system control registers */
+#define SYSTEM_RESET00  0x3000  // Bit[5]: Reset MCU
+                                // Bit[0]: Reset BIST
 #define SYSTEM_CTROL0   0x3008  // Bit[7]: Software reset 
                                 // Bit[6]: Software power down 
                                 // Bit[5]: Reserved 
@@ -18,6 +20,14 @@
                                 //          10: 3x
                                 //          11: 4x
 
+#define SC_PLL_CTRL0     0x3034 // Bit[3:0]: MIPI bit mode (0x8: 8-bit, 0xA: 10-bit)
+#define SC_PLL_CTRL1     0x3035 // Bit[7:4]: System clock divider (0: 16)
+                                // Bit[3:0]: Scale divider for MIPI
+#define SC_PLL_CTRL2     0x3036 // Bit[7:0]: PLL multiplier
+#define SC_PLL_CTRL3     0x3037 // Bit[4]: PLL root divider (0: 1, 1: 2)
+                                // Bit[3:0]: PLL pre-divider
+#define SYSTEM_ROOT_DIVIDER 0x3108 // Bit[1:0]: SCLK root divider (1, 2, 4, 8)
+
 #define SC_PLLS_CTRL0    0x303a // Bit[7]: PLLS bypass
 #define SC_PLLS_CTRL1    0x303b // Bit[4:0]: PLLS multiplier
 #define SC_PLLS_CTRL2    0x303c // Bit[6:4]: PLLS charge pump control
@@ -34,7 +44,24 @@
                                 //          10: 2
                                 //          11: 2.5
 
+#define SYSTEM_GROUP_ACCESS 0x3212 // Bit[7]: Group launch enable
+                                   // Bit[5]: Group launch
+                                   // Bit[4]: Group hold end
+                                   // Bit[3:0]: Group ID (0~3)
+
+/* AF (firmware on the embedded MCU) */
+#define AF_CMD_MAIN     0x3022  // AF command, executed when AF_CMD_ACK is cleared by the MCU
+#define AF_CMD_ACK      0x3023  // Host: 0x01 before a command, MCU: 0x00 when accepted
+#define AF_CMD_PARA0    0x3024  // Command parameters 0~4 (0x3024~0x3028)
+#define AF_CMD_PARA4    0x3028
+#define AF_FW_STATUS    0x3029  // 0x7F: not running, 0x7E: initializing, 0x70: idle/released
+                                // 0x00: focusing, 0x10: focused
+#define AF_FW_BASE      0x8000  // MCU program memory (firmware download)
+
 /* AEC/AGC control functions */
+#define AEC_PK_EXPOSURE_HI 0x3500 // Bit[3:0]: Exposure[19:16]
+#define AEC_PK_EXPOSURE_MD 0x3501 // Bit[7:0]: Exposure[15:8]
+#define AEC_PK_EXPOSURE_LO 0x3502 // Bit[7:0]: Exposure[7:0], low 4 bits are fraction of a line
 #define AEC_PK_MANUAL   0x3503  // AEC Manual Mode Control
                                 // Bit[7:6]: Reserved
                                 // Bit[5]: Gain delay option
@@ -49,6 +76,8 @@
                                 //         0: Auto enable
                                 //         1: Manual enable
 
+#define AEC_PK_REAL_GAIN_HI 0x350A // Bit[1:0]: Gain[9:8]
+#define AEC_PK_REAL_GAIN_LO 0x350B // Bit[7:0]: Gain[7:0]
 //gain = {0x350A[1:0], 0x350B[7:0]} / 16
 
 
@@ -0,0 +1,63 @@
+// ov5640_seq.h — Registersequenzen für den OV5640 (Tabellen, SCCB-Bursts)
+//
+// Eine Sequenz ist eine Tabelle aus (Adresse, Wert, Maske, Pause). Aufeinander
+// folgende Adressen ohne Maske und ohne Pause gehen als ein SCCB-Burst
+// (Auto-Increment des Sensors) statt als Einzelzugriffe hinaus. Alle Aufrufe
+// greifen auf den Sensor zu: Aufrufer hält die Kamera-Sperre.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sensor.h"
+
+#define OV5640_SEQ_BURST_MAX  128     // Datenbytes pro SCCB-Transaktion
+
+// Maske 0xFF: Register ganz schreiben. Andere Masken: nur diese Bits
+// (Lesen-Ändern-Schreiben). OV5640_STROBE: ganz schreiben, nie zurücklesen
+// (Befehls- und Auslöseregister wie Group-Launch oder Reset).
+#define OV5640_STROBE         0x00
+
+typedef struct {
+    uint16_t addr;
+    uint8_t  val;
+    uint8_t  mask;
+    uint16_t delay_ms;   // Pause nach dem Schreiben
+} ov5640_reg_t;
+
+typedef struct {
+    const char         *name;
+    const ov5640_reg_t *regs;
+    size_t              count;
+} ov5640_seq_t;
+
+#define OV5640_SEQ(name_, tbl_) { (name_), (tbl_), sizeof(tbl_) / sizeof((tbl_)[0]) }
+
+// Flags für ov5640_seq_apply
+#define OV5640_SEQ_VERIFY     0x01    // geschriebene Werte zurücklesen und vergleichen
+
+typedef struct {
+    int64_t  us;          // Dauer inklusive Pausen
+    uint16_t regs;        // Tabelleneinträge
+    uint16_t xfers;       // SCCB-Transaktionen (Schreiben und Lesen)
+    uint16_t mismatches;  // Abweichungen beim Zurücklesen
+} ov5640_seq_stat_t;
+
+// Bursts über den I2C-Port des Kameratreibers (camera_config_t.sccb_i2c_port).
+// Ohne Aufruf, mit dem neuen I2C-Treiber in esp32-camera oder wenn ein Burst
+// scheitert, schreibt das Modul einzeln über set_reg/get_reg des Treibers.
+void ov5640_seq_init(int i2c_port);
+
+// Sequenz schreiben. Unter Group-Hold wirken die Register erst beim Launch;
+// Zurücklesen liefert dort noch die alten Werte, also ohne OV5640_SEQ_VERIFY.
+// ESP_ERR_INVALID_RESPONSE bei Abweichungen, stat (optional) erhält Zeit
+// und Zählwerte.
+esp_err_t ov5640_seq_apply(sensor_t *s, const ov5640_seq_t *seq, unsigned flags,
+                           ov5640_seq_stat_t *stat);
+
+// Zusammenhängenden Block ab addr schreiben (z. B. Programmspeicher der
+// AF-MCU); mit OV5640_SEQ_VERIFY wird der Block zurückgelesen.
+esp_err_t ov5640_seq_write_block(sensor_t *s, uint16_t addr, const uint8_t *data,
+                                 size_t len, unsigned flags, ov5640_seq_stat_t *stat);
+
+// len Register ab addr lesen (ein Burst oder Einzelzugriffe)
+esp_err_t ov5640_seq_read(sensor_t *s, uint16_t addr, uint8_t *data, size_t len);
@@ -0,0 +1,177 @@
+// rate_ctrl.c — adaptive JPEG-Qualität mit Hysterese
+//
+// Regelgröße ist die Auslastung u = Sendedauer / Frame-Periode (bzw. Bitrate /
+// Bitraten-Ziel). u > RC_U_HIGH → Qualität schlechter, u < RC_U_LOW →
+// Qualität besser. Verschlechtern geht schnell, Verbessern nur nach mehreren
+// ruhigen Fenstern; nach jeder Änderung gilt eine Sperrzeit und die
+// Messwerte werden neu aufgebaut. Ist die Qualität am Anschlag, wird die
+// Auflösung eine Stufe verändert.
+#include "rate_ctrl.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "rate_ctrl";
+
+#define RC_EVAL_US        500000LL   // Auswertung alle 500 ms
+#define RC_HOLD_US        2000000LL  // Sperrzeit nach einer Änderung
+#define RC_U_HIGH         85         // % Auslastung → schlechter
+#define RC_U_LOW          45         // % Auslastung → besser
+#define RC_DOWN_WINDOWS   2          // Fenster in Folge bis zum Verschlechtern
+#define RC_UP_WINDOWS     6          // Fenster in Folge bis zum Verbessern
+#define RC_Q_STEP_DOWN    5
+#define RC_Q_STEP_UP      2
+#define RC_Q_WORST        50
+#define RC_MIN_SAMPLES    3
+#define RC_EWMA_SHIFT     3          // EWMA-Gewicht 1/8
+
+// Auflösungsstufen unterhalb der konfigurierten Größe, aufsteigend; die
+// oberste Stufe ist immer die konfigurierte Größe selbst (rate_ctrl_init)
+static const framesize_t s_ladder_base[] = {
+    FRAMESIZE_QVGA, FRAMESIZE_HVGA, FRAMESIZE_VGA, FRAMESIZE_SVGA,
+};
+#define LADDER_MAX (sizeof(s_ladder_base) / sizeof(s_ladder_base[0]) + 1)
+
+static framesize_t s_ladder[LADDER_MAX];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool     s_enabled = true;
+static int      s_target_kbps;
+static int      s_q_best;            // Startqualität = beste erlaubte
+static int      s_step_max;          // Startauflösung = höchste erlaubte Stufe
+static rate_ctrl_setting_t s_cur;
+static int      s_step;
+
+// Messwerte (unter s_mux)
+static int64_t  s_send_ewma;         // µs pro Frame
+static int64_t  s_bytes_ewma;        // Bytes pro Frame
+static uint32_t s_samples;
+
+static int64_t  s_next_eval_us;
+static int64_t  s_hold_until_us;
+static int      s_over, s_under;
+
+void rate_ctrl_init(int quality, framesize_t frame_size)
+{
+    int n = 0;
+    for (size_t i = 0; i < LADDER_MAX - 1 && s_ladder_base[i] < frame_size; i++) {
+        s_ladder[n++] = s_ladder_base[i];
+    }
+    s_ladder[n] = frame_size;
+    s_q_best     = quality;
+    s_step_max   = n;
+    s_step       = s_step_max;
+    s_cur.quality    = quality;
+    s_cur.frame_size = frame_size;
+}
+
+void rate_ctrl_enable(bool on)
+{
+    s_enabled = on;
+}
+
+void rate_ctrl_set_target_kbps(int kbps)
+{
+    s_target_kbps = kbps > 0 ? kbps : 0;
+}
+
+void rate_ctrl_report(size_t bytes, int64_t send_us)
+{
+    portENTER_CRITICAL(&s_mux);
+    if (s_samples == 0) {
+        s_send_ewma  = send_us;
+        s_bytes_ewma = bytes;
+    } else {
+        s_send_ewma  += (send_us - s_send_ewma) >> RC_EWMA_SHIFT;
+        s_bytes_ewma += ((int64_t)bytes - s_bytes_ewma) >> RC_EWMA_SHIFT;
+    }
+    s_samples++;
+    portEXIT_CRITICAL(&s_mux);
+}
+
+rate_ctrl_setting_t rate_ctrl_get(void)
+{
+    return s_cur;
+}
+
+// Schlechteste Qualität: RC_Q_WORST, bei schlechterer Startqualität diese —
+// der Regler wählt nie eine bessere Qualität als konfiguriert
+static int q_worst(void)
+{
+    return s_q_best > RC_Q_WORST ? s_q_best : RC_Q_WORST;
+}
+
+// Einstellung um eine Stufe verschlechtern (dir > 0) oder verbessern (dir < 0)
+static bool rate_ctrl_step(int dir, rate_ctrl_setting_t *next)
+{
+    *next = s_cur;
+    if (dir > 0) {
+        if (s_cur.quality < q_worst()) {
+            next->quality = s_cur.quality + RC_Q_STEP_DOWN;
+            if (next->quality > q_worst()) next->quality = q_worst();
+        } else if (s_step > 0) {
+            s_step--;
+            next->frame_size = s_ladder[s_step];
+            next->quality    = s_q_best;   // kleineres Bild, wieder bessere Qualität
+        } else {
+            return false;
+        }
+    } else {
+        if (s_cur.quality > s_q_best) {
+            next->quality = s_cur.quality - RC_Q_STEP_UP;
+            if (next->quality < s_q_best) next->quality = s_q_best;
+        } else if (s_step < s_step_max) {
+            s_step++;
+            next->frame_size = s_ladder[s_step];
+            next->quality    = q_worst();   // größeres Bild vorsichtig starten
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool rate_ctrl_poll(int64_t period_us, rate_ctrl_setting_t *out)
+{
+    int64_t now = esp_timer_get_time();
+    if (!s_enabled || now < s_next_eval_us || now < s_hold_until_us) return false;
+    s_next_eval_us = now + RC_EVAL_US;
+
+    portENTER_CRITICAL(&s_mux);
+    int64_t  send_us = s_send_ewma;
+    int64_t  bytes   = s_bytes_ewma;
+    uint32_t samples = s_samples;
+    portEXIT_CRITICAL(&s_mux);
+    if (samples < RC_MIN_SAMPLES || period_us <= 0) return false;
+
+    // Auslastung in %: Link (Sendedauer) und optional Bitraten-Ziel
+    int u = (int)(send_us * 100 / period_us);
+    if (s_target_kbps) {
+        int64_t kbps = bytes * 8 * 1000 / period_us;   // Bytes/Periode → kbit/s
+        int ub = (int)(kbps * 100 / s_target_kbps);
+        if (ub > u) u = ub;
+    }
+
+    if (u > RC_U_HIGH)      { s_over++;  s_under = 0; }
+    else if (u < RC_U_LOW)  { s_under++; s_over  = 0; }
+    else                    { s_over = s_under = 0; }
+
+    int dir = 0;
+    if (s_over >= RC_DOWN_WINDOWS)      dir = 1;
+    else if (s_under >= RC_UP_WINDOWS)  dir = -1;
+    if (!dir) return false;
+
+    s_over = s_under = 0;
+    rate_ctrl_setting_t next;
+    if (!rate_ctrl_step(dir, &next)) return false;
+
+    ESP_LOGI(TAG, "load %d%% (send %lld ms, %lld B/frame) → q%d, framesize %d",
+             u, (long long)(send_us / 1000), (long long)bytes,
+             next.quality, next.frame_size);
+    s_cur = next;
+    s_hold_until_us = now + RC_HOLD_US;
+    portENTER_CRITICAL(&s_mux);
+    s_samples = 0;
+    portEXIT_CRITICAL(&s_mux);
+    *out = next;
+    return true;
+}
@@ -0,0 +1,31 @@
+// rate_ctrl.h — Regelkreis für JPEG-Qualität/Auflösung des Streams
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor.h"
+
+// Einstellung, die der Capture-Task am Sensor anwendet
+typedef struct {
+    int         quality;      // JPEG-Qualität (kleiner = besser)
+    framesize_t frame_size;
+} rate_ctrl_setting_t;
+
+// Startwerte = obere Grenze (Qualität und Auflösung werden nie besser)
+void rate_ctrl_init(int quality, framesize_t frame_size);
+
+// Regelung an/aus (aus: Startwerte bleiben stehen)
+void rate_ctrl_enable(bool on);
+
+// Zusätzliches Bitraten-Ziel in kbit/s pro Client (0 = nur FPS-Ziel)
+void rate_ctrl_set_target_kbps(int kbps);
+
+// Messwert eines gesendeten Frames (Bytes, Sendedauer in µs)
+void rate_ctrl_report(size_t bytes, int64_t send_us);
+
+// Vom Capture-Task zwischen zwei Frames aufrufen. period_us ist die aktuelle
+// Frame-Periode. true, wenn *out eine neue Einstellung enthält.
+bool rate_ctrl_poll(int64_t period_us, rate_ctrl_setting_t *out);
+
+// Aktuelle Einstellung
+rate_ctrl_setting_t rate_ctrl_get(void);
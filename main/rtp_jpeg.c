@@ -0,0 +1,106 @@
+// rtp_jpeg.c — RTP-Nutzlast für JPEG (RFC 2435)
+//
+// Pro Paket: RTP-Kopf, JPEG-Kopf (Fragment-Offset, Typ, Q = 255, Größe / 8),
+// bei DRI ein Restart-Kopf, im ersten Paket die Quantisierungstabellen
+// (dynamisch, Q >= 128). Nutzdaten sind die Entropie-Daten zwischen SOS und
+// EOI. Huffman-Tabellen überträgt RFC 2435 nicht: der Empfänger setzt die
+// Standardtabellen (Annex K) ein, die auch der OV5640 verwendet.
+#include "rtp_jpeg.h"
+#include <stdbool.h>
+
+static void put_be16(uint8_t *p, uint16_t v)
+{
+    p[0] = v >> 8;
+    p[1] = v;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Quantisierungstabellen-Kopf (Luma, Chroma) in Zickzack-Reihenfolge
+static size_t put_qtables(uint8_t *p, const jpeg_info_t *in)
+{
+    const uint16_t *qt[2] = { in->qt[in->comp[0].tq], in->qt[in->comp[1].tq] };
+    uint8_t precision = 0;
+    size_t n = 4;
+    for (int t = 0; t < 2; t++) {
+        bool wide = false;
+        for (int i = 0; i < 64; i++) wide |= qt[t][i] > 0xFF;
+        if (wide) precision |= 1 << t;
+        for (int i = 0; i < 64; i++) {
+            if (wide) p[n++] = qt[t][i] >> 8;
+            p[n++] = qt[t][i];
+        }
+    }
+    p[0] = 0;                          // MBZ
+    p[1] = precision;
+    put_be16(p + 2, n - 4);
+    return n;
+}
+
+esp_err_t rtp_jpeg_send_frame(rtp_jpeg_stream_t *st, jpeg_dec_t *d,
+                              const uint8_t *jpg, size_t len, uint32_t ts,
+                              size_t max_packet, rtp_jpeg_send_cb_t cb, void *ctx)
+{
+    if (max_packet <= RTP_JPEG_HDR_MAX) return ESP_ERR_INVALID_ARG;
+    esp_err_t err = jpeg_dec_parse(d, jpg, len);
+    if (err != ESP_OK) return err;
+    const jpeg_info_t *in = &d->info;
+
+    // Typ 0: 4:2:2 (Y 2×1), Typ 1: 4:2:0 (Y 2×2); Chroma jeweils 1×1
+    if (in->ncomp != 3 || in->comp[0].h != 2 || in->comp[0].v > 2 ||
+        in->comp[1].h != 1 || in->comp[1].v != 1 ||
+        in->comp[2].h != 1 || in->comp[2].v != 1 ||
+        in->width > 2040 || in->height > 2040) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    uint8_t type = in->comp[0].v == 2 ? 1 : 0;
+    if (in->restart_interval) type += 64;
+
+    // Entropie-Daten ohne EOI (der Treiber kann hinter EOI auffüllen)
+    size_t end = len;
+    while (end > in->scan_off + 1 && !(jpg[end - 2] == 0xFF && jpg[end - 1] == 0xD9)) end--;
+    if (end <= in->scan_off + 1) return ESP_ERR_INVALID_SIZE;
+    end -= 2;
+    const uint8_t *scan = jpg + in->scan_off;
+    size_t scan_len = end - in->scan_off;
+
+    uint8_t hdr[RTP_JPEG_HDR_MAX];
+    size_t off = 0;
+    while (off < scan_len) {
+        size_t n = 12;
+        hdr[0] = 0x80;                                // V = 2
+        hdr[1] = RTP_JPEG_PT;
+        put_be16(hdr + 2, st->seq);
+        put_be32(hdr + 4, ts);
+        put_be32(hdr + 8, st->ssrc);
+
+        put_be32(hdr + n, off);                       // Type-specific = 0, Offset 24 Bit
+        hdr[n + 4] = type;
+        hdr[n + 5] = 255;                             // Q: Tabellen im Paket
+        hdr[n + 6] = in->width / 8;
+        hdr[n + 7] = in->height / 8;
+        n += 8;
+        if (type >= 64) {
+            put_be16(hdr + n, in->restart_interval);
+            put_be16(hdr + n + 2, 0xFFFF);            // F = L = 1, Count 0x3FFF
+            n += 4;
+        }
+        if (off == 0) n += put_qtables(hdr + n, in);
+
+        size_t chunk = max_packet - n;
+        if (chunk > scan_len - off) chunk = scan_len - off;
+        if (off + chunk == scan_len) hdr[1] |= 0x80;  // Marker: letztes Paket des Frames
+
+        err = cb(ctx, hdr, n, scan + off, chunk);
+        st->seq++;
+        if (err != ESP_OK) return err;
+        off += chunk;
+    }
+    return ESP_OK;
+}
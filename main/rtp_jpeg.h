@@ -0,0 +1,32 @@
+// rtp_jpeg.h — JPEG-Frames nach RFC 2435 in RTP-Pakete zerlegen
+//
+// Liest Quantisierungstabellen, Sampling und Scan-Beginn mit jpeg_scan und
+// erzeugt pro Paket nur den Kopf; die Nutzdaten zeigen direkt ins JPEG.
+// Reines C wie jpeg_scan, der Versand (UDP oder RTSP-interleaved) liegt beim
+// Aufrufer.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "jpeg_scan.h"
+
+#define RTP_JPEG_PT       26
+#define RTP_JPEG_CLOCK    90000
+// RTP (12) + JPEG (8) + Restart (4) + Q-Tabellen (4 + 2 × 128, 16 Bit)
+#define RTP_JPEG_HDR_MAX  (12 + 8 + 4 + 4 + 2 * 128)
+
+typedef struct {
+    uint32_t ssrc;
+    uint16_t seq;            // Sequenznummer des nächsten Pakets
+} rtp_jpeg_stream_t;
+
+// Ein Paket: Kopf + Nutzdaten (zusammen <= max_packet aus rtp_jpeg_send_frame)
+typedef esp_err_t (*rtp_jpeg_send_cb_t)(void *ctx, const uint8_t *hdr, size_t hlen,
+                                        const uint8_t *payload, size_t plen);
+
+// Frame in Pakete zerlegen und cb für jedes aufrufen. ts ist der RTP-Zeitstempel
+// (90 kHz), d ein Arbeitskontext für den JPEG-Parser. ESP_ERR_NOT_SUPPORTED für
+// Frames, die RFC 2435 nicht abbildet (kein YUV 4:2:2/4:2:0, > 2040 Pixel).
+esp_err_t rtp_jpeg_send_frame(rtp_jpeg_stream_t *st, jpeg_dec_t *d,
+                              const uint8_t *jpg, size_t len, uint32_t ts,
+                              size_t max_packet, rtp_jpeg_send_cb_t cb, void *ctx);
@@ -0,0 +1,513 @@
+// rtsp_server.c — RTSP-Server für VMS/ffmpeg
+//
+// Ein Listener-Task nimmt Verbindungen an, pro Client läuft ein Session-Task.
+// Er beantwortet OPTIONS/DESCRIBE/SETUP/PLAY/PAUSE/GET_PARAMETER/TEARDOWN und
+// liest nach PLAY aus demselben Frame-Ring wie /stream und /ws — eine
+// Aufnahme speist alle Protokolle. Die RTP-Pakete (RFC 2435, rtp_jpeg) gehen
+// per UDP an die client_port des Clients oder interleaved über die
+// RTSP-Verbindung ($-Framing), wenn der Client RTP/AVP/TCP verlangt.
+// RTCP wird nicht gesendet. Eingehende RTCP-Pakete (UDP auf server_port+1
+// bzw. interleaved) halten die Session am Leben, ein BYE beendet sie.
+//
+// Test vom Host:
+//     ffprobe -rtsp_transport udp rtsp://<ip>/stream
+//     ffplay  -rtsp_transport tcp rtsp://<ip>/stream
+#include "rtsp_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "camera.h"
+#include "frame_ring.h"
+#include "metrics.h"
+#include "rate_ctrl.h"
+#include "rtp_jpeg.h"
+#include "task_prof.h"
+#include "wifi.h"
+
+static const char *TAG = "rtsp";
+
+#define RTSP_RX_BUF          1024     // eine Anfrage inkl. Header
+#define RTSP_TX_BUF          1024     // eine Antwort inkl. SDP
+#define RTSP_UDP_PACKET      1400     // RTP-Paket ohne IP/UDP (unter der MTU)
+#define RTSP_TCP_PACKET      8192     // interleaved: weniger, größere Pakete
+#define RTSP_UDP_RETRIES     5        // ENOMEM im lwIP/WLAN-Puffer: kurz warten
+#ifndef RTSP_TIMEOUT_S
+#define RTSP_TIMEOUT_S       60       // ohne Anfrage/RTCP → Session beenden
+#endif
+#define RTSP_UDP_PORT_BASE   50000    // RTP/RTCP-Portpaar (gerade/ungerade) ab hier
+#define RTSP_UDP_PORT_PAIRS  2048
+#define RTSP_UDP_PORT_TRIES  8
+#define RTCP_PT_BYE          203
+#define RTSP_IDLE_POLL_MS    1000     // Steuerkanal-Wartezeit ohne PLAY
+#define RTSP_FRAME_WAIT_MS   100      // Frame-Wartezeit bei PLAY
+
+typedef struct {
+    int               fd;            // RTSP-Verbindung
+    struct sockaddr_in peer;
+    uint32_t          id;            // Session-ID (0 = kein SETUP)
+    bool              tcp;           // RTP interleaved über fd
+    uint8_t           channel;
+    int               udp_fd;        // RTP, -1 = kein UDP
+    int               rtcp_fd;       // RTCP auf server_port + 1
+    uint16_t          client_port, server_port;
+    bool              playing, closing, warned;
+    frame_reader_t   *rd;
+    int               slot;          // metrics_client_*
+    int64_t           last_rx_us;
+    size_t            rx_len, skip;  // skip: noch zu verwerfende Bytes ($-Pakete, Bodies)
+    char              rx[RTSP_RX_BUF + 1];
+    char              tx[RTSP_TX_BUF];
+    uint8_t           pkt[RTSP_UDP_PACKET];
+    rtp_jpeg_stream_t rtp;
+    jpeg_dec_t        dec;
+} rtsp_session_t;
+
+static volatile int s_sessions;
+
+// ---------------------------------------------------------------------------
+// Versand
+// ---------------------------------------------------------------------------
+static esp_err_t send_all(int fd, const void *buf, size_t len)
+{
+    struct iovec iov = { .iov_base = (void *)buf, .iov_len = len };
+    return stream_writev_all(fd, &iov, 1);
+}
+
+// Ein RTP-Paket: UDP mit Wiederholung bei vollen Puffern (ESP_ERR_NO_MEM
+// verwirft nur den Rest des Frames), TCP mit $-Kopf (Fehler beendet die Session)
+static esp_err_t send_packet(void *ctx, const uint8_t *hdr, size_t hlen,
+                             const uint8_t *payload, size_t plen)
+{
+    rtsp_session_t *s = ctx;
+    if (s->tcp) {
+        size_t n = hlen + plen;
+        uint8_t pre[4] = { '$', s->channel, n >> 8, n };
+        struct iovec iov[3] = {
+            { .iov_base = pre,             .iov_len = sizeof(pre) },
+            { .iov_base = (void *)hdr,     .iov_len = hlen },
+            { .iov_base = (void *)payload, .iov_len = plen },
+        };
+        return stream_writev_all(s->fd, iov, 3) == ESP_OK ? ESP_OK : ESP_FAIL;
+    }
+
+    memcpy(s->pkt, hdr, hlen);
+    memcpy(s->pkt + hlen, payload, plen);
+    struct sockaddr_in to = s->peer;
+    to.sin_port = htons(s->client_port);
+    for (int i = 0; i < RTSP_UDP_RETRIES; i++) {
+        if (sendto(s->udp_fd, s->pkt, hlen + plen, 0, (struct sockaddr *)&to, sizeof(to)) >= 0) {
+            return ESP_OK;
+        }
+        if (errno != ENOMEM && errno != EAGAIN) break;
+        vTaskDelay(1);
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t send_frame(rtsp_session_t *s, const frame_t *f)
+{
+    int64_t t0 = esp_timer_get_time();
+    uint32_t ts = (uint32_t)((uint64_t)f->timestamp_us * (RTP_JPEG_CLOCK / 1000) / 1000);
+    esp_err_t err = rtp_jpeg_send_frame(&s->rtp, &s->dec, f->buf, f->len, ts,
+                                        s->tcp ? RTSP_TCP_PACKET : RTSP_UDP_PACKET,
+                                        send_packet, s);
+    if (err == ESP_FAIL) return err;
+    if (err != ESP_OK) {
+        // Nicht abbildbares Format bzw. volle UDP-Puffer: Frame fehlt beim Client
+        if (err != ESP_ERR_NO_MEM && !s->warned) {
+            ESP_LOGW(TAG, "frame %ux%u not sendable as RFC 2435: 0x%x", f->width, f->height, err);
+            s->warned = true;
+        }
+        return ESP_OK;
+    }
+    int64_t us = esp_timer_get_time() - t0;
+    metrics_observe(MET_H_SEND_US, (uint32_t)us);
+    metrics_client_frame(s->slot, f->len, frame_ring_reader_dropped(s->rd));
+    camera_report_send_time(us);
+    rate_ctrl_report(f->len, us);
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// RTSP-Anfragen
+// ---------------------------------------------------------------------------
+// Header-Wert (bis Zeilenende) ohne führende Leerzeichen
+static bool hdr_get(const char *msg, const char *name, char *out, size_t n)
+{
+    size_t nl = strlen(name);
+    for (const char *p = strstr(msg, "\r\n"); p; p = strstr(p + 2, "\r\n")) {
+        const char *l = p + 2;
+        if (strncasecmp(l, name, nl) != 0 || l[nl] != ':') continue;
+        l += nl + 1;
+        while (*l == ' ') l++;
+        size_t len = strcspn(l, "\r\n");
+        if (len >= n) len = n - 1;
+        memcpy(out, l, len);
+        out[len] = '\0';
+        return true;
+    }
+    return false;
+}
+
+static esp_err_t reply(rtsp_session_t *s, const char *status, int cseq,
+                       const char *headers, const char *body)
+{
+    int n = snprintf(s->tx, sizeof(s->tx), "RTSP/1.0 %s\r\nCSeq: %d\r\nServer: Look-ESP\r\n",
+                     status, cseq);
+    if (s->id && n < sizeof(s->tx)) {
+        n += snprintf(s->tx + n, sizeof(s->tx) - n, "Session: %08lX;timeout=%d\r\n",
+                      (unsigned long)s->id, RTSP_TIMEOUT_S);
+    }
+    if (headers && n < sizeof(s->tx)) {
+        n += snprintf(s->tx + n, sizeof(s->tx) - n, "%s", headers);
+    }
+    if (n < sizeof(s->tx)) {
+        n += snprintf(s->tx + n, sizeof(s->tx) - n, "Content-Length: %u\r\n\r\n%s",
+                      body ? (unsigned)strlen(body) : 0, body ? body : "");
+    }
+    if (n >= sizeof(s->tx)) return ESP_ERR_INVALID_SIZE;
+    return send_all(s->fd, s->tx, n);
+}
+
+static void stop_play(rtsp_session_t *s)
+{
+    if (!s->playing) return;
+    s->playing = false;
+    frame_ring_reader_close(s->rd);
+    s->rd = NULL;
+    metrics_client_close(s->slot);
+    wifi_link_release();
+}
+
+static esp_err_t do_describe(rtsp_session_t *s, int cseq, const char *url)
+{
+    char ip[16] = "0.0.0.0", sdp[256], hdr[192];
+    struct sockaddr_in local;
+    socklen_t alen = sizeof(local);
+    if (getsockname(s->fd, (struct sockaddr *)&local, &alen) == 0) {
+        inet_ntop(AF_INET, &local.sin_addr, ip, sizeof(ip));
+    }
+    snprintf(sdp, sizeof(sdp),
+             "v=0\r\n"
+             "o=- %lu 1 IN IP4 %s\r\n"
+             "s=Look-ESP\r\n"
+             "c=IN IP4 0.0.0.0\r\n"
+             "t=0 0\r\n"
+             "a=control:*\r\n"
+             "m=video 0 RTP/AVP %d\r\n"
+             "a=rtpmap:%d JPEG/%d\r\n"
+             "a=control:track1\r\n",
+             (unsigned long)esp_random(), ip, RTP_JPEG_PT, RTP_JPEG_PT, RTP_JPEG_CLOCK);
+    size_t ul = strlen(url);
+    snprintf(hdr, sizeof(hdr), "Content-Base: %s%s\r\nContent-Type: application/sdp\r\n",
+             url, ul && url[ul - 1] == '/' ? "" : "/");
+    return reply(s, "200 OK", cseq, hdr, sdp);
+}
+
+// RTP auf einem geraden Port, RTCP auf dem nächsten (RFC 3550) — beide
+// gebunden, damit die Receiver Reports des Clients ankommen
+static int udp_bind(uint16_t port)
+{
+    struct sockaddr_in a = {
+        .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd >= 0 && bind(fd, (struct sockaddr *)&a, sizeof(a)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static esp_err_t udp_open(rtsp_session_t *s)
+{
+    for (int i = 0; i < RTSP_UDP_PORT_TRIES; i++) {
+        uint16_t port = RTSP_UDP_PORT_BASE + 2 * (esp_random() % RTSP_UDP_PORT_PAIRS);
+        int rtp = udp_bind(port);
+        if (rtp < 0) continue;
+        int rtcp = udp_bind(port + 1);
+        if (rtcp < 0) {
+            close(rtp);
+            continue;
+        }
+        s->udp_fd = rtp;
+        s->rtcp_fd = rtcp;
+        s->server_port = port;
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+static esp_err_t do_setup(rtsp_session_t *s, int cseq, const char *msg)
+{
+    char tr[128], hdr[160];
+    if (!hdr_get(msg, "Transport", tr, sizeof(tr))) {
+        return reply(s, "461 Unsupported Transport", cseq, NULL, NULL);
+    }
+    if (strstr(tr, "RTP/AVP/TCP")) {
+        const char *p = strstr(tr, "interleaved=");
+        s->tcp = true;
+        s->channel = p ? atoi(p + 12) : 0;
+        snprintf(hdr, sizeof(hdr),
+                 "Transport: RTP/AVP/TCP;unicast;interleaved=%u-%u;ssrc=%08lX\r\n",
+                 s->channel, s->channel + 1, (unsigned long)s->rtp.ssrc);
+    } else {
+        const char *p = strstr(tr, "client_port=");
+        if (!p) return reply(s, "461 Unsupported Transport", cseq, NULL, NULL);
+        s->tcp = false;
+        s->client_port = atoi(p + 12);
+        if (s->udp_fd < 0 && udp_open(s) != ESP_OK) {
+            ESP_LOGE(TAG, "udp socket failed: errno %d", errno);
+            return reply(s, "500 Internal Server Error", cseq, NULL, NULL);
+        }
+        snprintf(hdr, sizeof(hdr),
+                 "Transport: RTP/AVP;unicast;client_port=%u-%u;server_port=%u-%u;ssrc=%08lX\r\n",
+                 s->client_port, s->client_port + 1, s->server_port, s->server_port + 1,
+                 (unsigned long)s->rtp.ssrc);
+    }
+    if (!s->id) s->id = esp_random() | 1;
+    ESP_LOGI(TAG, "session %08lX: RTP over %s", (unsigned long)s->id,
+             s->tcp ? "TCP (interleaved)" : "UDP");
+    return reply(s, "200 OK", cseq, hdr, NULL);
+}
+
+static esp_err_t do_play(rtsp_session_t *s, int cseq, const char *url)
+{
+    if (!s->playing) {
+        s->rd = frame_ring_reader_open();
+        if (!s->rd) return reply(s, "453 Not Enough Bandwidth", cseq, NULL, NULL);
+        s->slot = metrics_client_open("rtsp", s->fd);
+        wifi_link_acquire();
+        s->playing = true;
+    }
+    char hdr[192];
+    snprintf(hdr, sizeof(hdr), "Range: npt=0.000-\r\nRTP-Info: url=%s;seq=%u\r\n",
+             url, s->rtp.seq);
+    return reply(s, "200 OK", cseq, hdr, NULL);
+}
+
+static esp_err_t handle_request(rtsp_session_t *s, const char *msg)
+{
+    char method[16], url[128], val[32];
+    int cseq = hdr_get(msg, "CSeq", val, sizeof(val)) ? atoi(val) : 0;
+    if (sscanf(msg, "%15s %127s RTSP/1.0", method, url) != 2) {
+        return reply(s, "400 Bad Request", cseq, NULL, NULL);
+    }
+
+    // Nach SETUP muss die Session-ID passen
+    if (s->id && strcmp(method, "OPTIONS") != 0 && strcmp(method, "DESCRIBE") != 0 &&
+        hdr_get(msg, "Session", val, sizeof(val)) &&
+        strtoul(val, NULL, 16) != s->id) {
+        return reply(s, "454 Session Not Found", cseq, NULL, NULL);
+    }
+
+    if (strcmp(method, "OPTIONS") == 0) {
+        return reply(s, "200 OK", cseq,
+                     "Public: OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, TEARDOWN, GET_PARAMETER\r\n",
+                     NULL);
+    }
+    if (strcmp(method, "DESCRIBE") == 0) return do_describe(s, cseq, url);
+    if (strcmp(method, "SETUP") == 0)    return do_setup(s, cseq, msg);
+    if (strcmp(method, "GET_PARAMETER") == 0) return reply(s, "200 OK", cseq, NULL, NULL);
+    if (!s->id) return reply(s, "455 Method Not Valid in This State", cseq, NULL, NULL);
+    if (strcmp(method, "PLAY") == 0) return do_play(s, cseq, url);
+    if (strcmp(method, "PAUSE") == 0) {
+        stop_play(s);
+        return reply(s, "200 OK", cseq, NULL, NULL);
+    }
+    if (strcmp(method, "TEARDOWN") == 0) {
+        stop_play(s);
+        s->closing = true;
+        return reply(s, "200 OK", cseq, NULL, NULL);
+    }
+    return reply(s, "501 Not Implemented", cseq, NULL, NULL);
+}
+
+// Empfangene Bytes abarbeiten: $-Pakete (RTCP interleaved) und Bodies
+// verwerfen, vollständige Anfragen beantworten
+static esp_err_t process_input(rtsp_session_t *s)
+{
+    while (s->rx_len) {
+        size_t used;
+        if (s->skip) {
+            used = s->skip < s->rx_len ? s->skip : s->rx_len;
+            s->skip -= used;
+        } else if (s->rx[0] == '$') {
+            if (s->rx_len < 4) break;
+            s->skip = 4 + ((uint8_t)s->rx[2] << 8 | (uint8_t)s->rx[3]);
+            continue;
+        } else {
+            s->rx[s->rx_len] = '\0';
+            char *end = strstr(s->rx, "\r\n\r\n");
+            if (!end) {
+                if (s->rx_len >= RTSP_RX_BUF) return ESP_ERR_INVALID_SIZE;
+                break;
+            }
+            end[2] = '\0';                         // letzte Headerzeile bleibt mit \r\n
+            used = end + 4 - s->rx;
+            char val[12];
+            if (hdr_get(s->rx, "Content-Length", val, sizeof(val))) s->skip = atoi(val);
+            esp_err_t err = handle_request(s, s->rx);
+            if (err != ESP_OK) return err;
+        }
+        memmove(s->rx, s->rx + used, s->rx_len - used);
+        s->rx_len -= used;
+    }
+    return ESP_OK;
+}
+
+// Datagramme auf den UDP-Ports lesen: alles vom Client gilt als
+// Lebenszeichen (Receiver Reports, NAT-Keepalives); RTCP-BYE beendet
+static void udp_input(rtsp_session_t *s, int fd)
+{
+    uint8_t buf[256];
+    struct sockaddr_in from;
+    socklen_t alen = sizeof(from);
+    int n = recvfrom(fd, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr *)&from, &alen);
+    if (n <= 0 || from.sin_addr.s_addr != s->peer.sin_addr.s_addr) return;
+    s->last_rx_us = esp_timer_get_time();
+    if (fd != s->rtcp_fd) return;
+    // Zusammengesetztes RTCP-Paket: Kopf je 4 Byte, Länge in 32-Bit-Worten − 1
+    for (int off = 0; off + 4 <= n; off += 4 * ((buf[off + 2] << 8 | buf[off + 3]) + 1)) {
+        if ((buf[off] >> 6) != 2) break;
+        if (buf[off + 1] == RTCP_PT_BYE) {
+            ESP_LOGI(TAG, "session %08lX: RTCP BYE", (unsigned long)s->id);
+            s->closing = true;
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tasks
+// ---------------------------------------------------------------------------
+static void session_task(void *arg)
+{
+    rtsp_session_t *s = arg;
+    char peer[16];
+    inet_ntop(AF_INET, &s->peer.sin_addr, peer, sizeof(peer));
+    ESP_LOGI(TAG, "client %s connected", peer);
+    stream_tune_socket(s->fd);
+    s->last_rx_us = esp_timer_get_time();
+
+    while (!s->closing) {
+        // Steuerkanal: ohne PLAY blockierend, sonst nur nachsehen
+        int wait_ms = s->playing ? 0 : RTSP_IDLE_POLL_MS;
+        struct timeval tv = { .tv_sec = wait_ms / 1000, .tv_usec = (wait_ms % 1000) * 1000 };
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(s->fd, &rfds);
+        int maxfd = s->fd;
+        if (s->udp_fd >= 0) {
+            FD_SET(s->udp_fd, &rfds);
+            FD_SET(s->rtcp_fd, &rfds);
+            if (s->udp_fd > maxfd)  maxfd = s->udp_fd;
+            if (s->rtcp_fd > maxfd) maxfd = s->rtcp_fd;
+        }
+        int r = select(maxfd + 1, &rfds, NULL, NULL, &tv);
+        if (r < 0) break;
+        if (s->udp_fd >= 0 && r > 0) {
+            if (FD_ISSET(s->udp_fd, &rfds))  udp_input(s, s->udp_fd);
+            if (FD_ISSET(s->rtcp_fd, &rfds)) udp_input(s, s->rtcp_fd);
+        }
+        if (r > 0 && FD_ISSET(s->fd, &rfds)) {
+            int n = recv(s->fd, s->rx + s->rx_len, RTSP_RX_BUF - s->rx_len, 0);
+            if (n <= 0) break;
+            s->rx_len += n;
+            s->last_rx_us = esp_timer_get_time();
+            if (process_input(s) != ESP_OK) break;
+        }
+        if (esp_timer_get_time() - s->last_rx_us > RTSP_TIMEOUT_S * 1000000LL) {
+            ESP_LOGW(TAG, "client %s timed out", peer);
+            break;
+        }
+        if (s->playing) {
+            const frame_t *f = frame_ring_next(s->rd, pdMS_TO_TICKS(RTSP_FRAME_WAIT_MS));
+            if (f) {
+                esp_err_t err = send_frame(s, f);
+                frame_ring_release(f);
+                if (err != ESP_OK) {
+                    ESP_LOGW(TAG, "client %s: send error, errno %d", peer, errno);
+                    break;
+                }
+            }
+        }
+    }
+
+    ESP_LOGI(TAG, "client %s closed", peer);
+    stop_play(s);
+    if (s->udp_fd >= 0) close(s->udp_fd);
+    if (s->rtcp_fd >= 0) close(s->rtcp_fd);
+    close(s->fd);
+    free(s);
+    __atomic_sub_fetch(&s_sessions, 1, __ATOMIC_RELAXED);
+    vTaskDelete(NULL);
+}
+
+static void listen_task(void *arg)
+{
+    int lfd = (int)(intptr_t)arg;
+    while (1) {
+        struct sockaddr_in peer;
+        socklen_t alen = sizeof(peer);
+        int fd = accept(lfd, (struct sockaddr *)&peer, &alen);
+        if (fd < 0) {
+            ESP_LOGW(TAG, "accept failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        rtsp_session_t *s = NULL;
+        if (__atomic_add_fetch(&s_sessions, 1, __ATOMIC_RELAXED) <= RTSP_MAX_SESSIONS) {
+            s = calloc(1, sizeof(*s));
+        }
+        if (s) {
+            s->fd       = fd;
+            s->peer     = peer;
+            s->udp_fd   = -1;
+            s->rtcp_fd  = -1;
+            s->slot     = -1;
+            s->rtp.ssrc = esp_random();
+            s->rtp.seq  = esp_random();
+            if (task_create(TASK_RTSP_SESSION, session_task, s, NULL) == pdPASS) {
+                continue;
+            }
+            free(s);
+        }
+        static const char busy[] = "RTSP/1.0 503 Service Unavailable\r\n\r\n";
+        send(fd, busy, sizeof(busy) - 1, MSG_DONTWAIT);
+        close(fd);
+        __atomic_sub_fetch(&s_sessions, 1, __ATOMIC_RELAXED);
+        ESP_LOGW(TAG, "session rejected (%d active)", s_sessions);
+    }
+}
+
+esp_err_t rtsp_server_start(void)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (lfd < 0) return ESP_FAIL;
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(RTSP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(lfd, (struct sockaddr *)&a, sizeof(a)) != 0 || listen(lfd, RTSP_MAX_SESSIONS) != 0) {
+        ESP_LOGE(TAG, "bind/listen on %d failed: errno %d", RTSP_PORT, errno);
+        close(lfd);
+        return ESP_FAIL;
+    }
+    if (task_create(TASK_RTSP, listen_task, (void *)(intptr_t)lfd, NULL) != pdPASS) {
+        close(lfd);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "RTSP server on port %d", RTSP_PORT);
+    return ESP_OK;
+}
@@ -0,0 +1,11 @@
+// rtsp_server.h — RTSP/RTP-Server für den MJPEG-Stream (RFC 2326, RFC 2435)
+#pragma once
+#include "esp_err.h"
+
+#ifndef RTSP_PORT
+#define RTSP_PORT           554     // Host-Build: -DRTSP_PORT=8554
+#endif
+#define RTSP_MAX_SESSIONS   2
+
+// Listener-Task starten; rtsp://<ip>/ liefert den Stream (jeder Pfad)
+esp_err_t rtsp_server_start(void);
@@ -0,0 +1,307 @@
+// task_prof.c — Platzierungstabelle der Tasks und Profiler für /debug/tasks
+//
+// Alle eigenen Tasks entstehen über task_create() mit Stack, Priorität und
+// Kern aus k_tasks[]. Ein Abtast-Task liest jede Sekunde die FreeRTOS-
+// Laufzeitzähler (uxTaskGetSystemState) in einen Ring; /debug/tasks bildet
+// daraus CPU-Anteile über ein gleitendes Fenster, dazu Stack-Reserve,
+// Priorität und Kern jeder Task sowie die Last pro Kern (aus den Idle-Tasks).
+// Braucht CONFIG_FREERTOS_USE_TRACE_FACILITY und
+// CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (sdkconfig.defaults).
+#include "task_prof.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "task_prof";
+
+#define PROF_SAMPLE_MS     1000
+#define PROF_WINDOW        10      // Abtastwerte im Ring = max. Fenster in s
+#define PROF_MAX_TASKS     40
+
+#if TASK_PLACEMENT == TASK_PLACEMENT_SPLIT && portNUM_PROCESSORS > 1
+#define CORE_NET           0
+#define CORE_CAM           1
+#define PLACEMENT_NAME     "split"
+#elif TASK_PLACEMENT == TASK_PLACEMENT_SWAPPED && portNUM_PROCESSORS > 1
+#define CORE_NET           1
+#define CORE_CAM           0
+#define PLACEMENT_NAME     "swapped"
+#else
+#define CORE_NET           tskNO_AFFINITY
+#define CORE_CAM           tskNO_AFFINITY
+#define PLACEMENT_NAME     "free"
+#endif
+
+static const task_place_t k_tasks[TASK_ID_COUNT] = {
+    //                      Name           Stack  Prio  Kern
+    [TASK_CAPTURE]      = { "cam_capture", 4096,  5,    CORE_CAM },
+    [TASK_SNAPSHOT]     = { "snapshot",    4096,  4,    CORE_CAM },
+    [TASK_BURST]        = { "burst",       4096,  4,    CORE_CAM },
+    [TASK_MOTION]       = { "motion",      4096,  3,    CORE_CAM },   // unter Capture und Sendern
+    [TASK_HTTPD]        = { "httpd",       4096,  5,    CORE_NET },
+    [TASK_STREAM]       = { "stream",      4096,  5,    CORE_NET },
+    [TASK_BURST_SEND]   = { "burst_send",  4096,  5,    CORE_NET },
+    [TASK_CLIP_SEND]    = { "clip_send",   4096,  5,    CORE_NET },
+    [TASK_WS]           = { "ws_stream",   4096,  5,    CORE_NET },
+    [TASK_RTSP]         = { "rtsp",        3072,  5,    CORE_NET },
+    [TASK_RTSP_SESSION] = { "rtsp_sess",   4096,  5,    CORE_NET },
+    [TASK_WIFI_ROAM]    = { "wifi_roam",   3072,  2,    tskNO_AFFINITY },
+    [TASK_IP_LOGGER]    = { "ip_logger",   3072,  1,    tskNO_AFFINITY },
+    [TASK_PROF]         = { "task_prof",   3072,  1,    tskNO_AFFINITY },
+};
+
+typedef struct {
+    UBaseType_t                 num;     // xTaskNumber (eindeutig, auch nach Löschen)
+    configRUN_TIME_COUNTER_TYPE rt;
+} prof_ent_t;
+
+typedef struct {
+    configRUN_TIME_COUNTER_TYPE total;
+    int64_t                     ts_us;
+    uint16_t                    count;
+    prof_ent_t                  e[PROF_MAX_TASKS];
+} prof_sample_t;
+
+static prof_sample_t    *s_ring;        // PROF_WINDOW + 1 Abtastwerte
+static int               s_head;        // nächster Schreibplatz
+static int               s_filled;
+static SemaphoreHandle_t s_lock;
+
+// Seit dem Start aufsummierte Rechenzeit (µs) aus den Abtast-Differenzen:
+// die 32-Bit-Laufzeitzähler laufen nach gut 71 min über, Tasks verschwinden
+// beim Löschen samt Zähler
+static uint64_t          s_busy_us;                   // alle Kerne ohne Idle
+static uint64_t          s_task_us[TASK_ID_COUNT];    // nach Tabelleneintrag
+
+const task_place_t *task_place(task_id_t id)
+{
+    return &k_tasks[id];
+}
+
+BaseType_t task_create(task_id_t id, TaskFunction_t fn, void *arg, TaskHandle_t *out)
+{
+    const task_place_t *p = &k_tasks[id];
+    return xTaskCreatePinnedToCore(fn, p->name, p->stack, arg, p->prio, out, p->core);
+}
+
+// Laufzeitzähler aller Tasks (st: PROF_MAX_TASKS Einträge)
+static UBaseType_t read_state(TaskStatus_t *st, configRUN_TIME_COUNTER_TYPE *total)
+{
+    return uxTaskGetSystemState(st, PROF_MAX_TASKS, total);
+}
+
+static int task_id_by_name(const char *name)
+{
+    for (int i = 0; i < TASK_ID_COUNT; i++) {
+        if (strcmp(k_tasks[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Laufzeit einer Task im Basiswert (0: Task ist jünger als das Fenster)
+static configRUN_TIME_COUNTER_TYPE base_runtime(const prof_sample_t *b, UBaseType_t num)
+{
+    for (int i = 0; b && i < b->count; i++) {
+        if (b->e[i].num == num) return b->e[i].rt;
+    }
+    return 0;
+}
+
+// Differenz zur vorigen Abtastung in die Summen übernehmen (unter s_lock).
+// Was eine Task zwischen letzter Abtastung und Löschen rechnet, fehlt.
+static void cpu_accumulate(const prof_sample_t *prev, const TaskStatus_t *st,
+                           UBaseType_t n, configRUN_TIME_COUNTER_TYPE total)
+{
+    configRUN_TIME_COUNTER_TYPE span = total - prev->total;
+    uint64_t idle = 0;
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        TaskHandle_t h = xTaskGetIdleTaskHandleForCore(c);
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (st[i].xHandle != h) continue;
+            configRUN_TIME_COUNTER_TYPE d = st[i].ulRunTimeCounter
+                                          - base_runtime(prev, st[i].xTaskNumber);
+            idle += d < span ? d : span;
+        }
+    }
+    uint64_t cap = (uint64_t)span * portNUM_PROCESSORS;
+    s_busy_us += idle < cap ? cap - idle : 0;
+    for (UBaseType_t i = 0; i < n; i++) {
+        int id = task_id_by_name(st[i].pcTaskName);
+        if (id < 0) continue;
+        s_task_us[id] += (configRUN_TIME_COUNTER_TYPE)(st[i].ulRunTimeCounter
+                         - base_runtime(prev, st[i].xTaskNumber));
+    }
+}
+
+static void sample_store(const TaskStatus_t *st, UBaseType_t n,
+                         configRUN_TIME_COUNTER_TYPE total)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_filled) {
+        cpu_accumulate(&s_ring[(s_head + PROF_WINDOW) % (PROF_WINDOW + 1)], st, n, total);
+    }
+    prof_sample_t *sm = &s_ring[s_head];
+    sm->total = total;
+    sm->ts_us = esp_timer_get_time();
+    sm->count = n;
+    for (UBaseType_t i = 0; i < n; i++) {
+        sm->e[i].num = st[i].xTaskNumber;
+        sm->e[i].rt  = st[i].ulRunTimeCounter;
+    }
+    s_head = (s_head + 1) % (PROF_WINDOW + 1);
+    if (s_filled < PROF_WINDOW + 1) s_filled++;
+    xSemaphoreGive(s_lock);
+}
+
+static void prof_task(void *arg)
+{
+    TaskStatus_t *st = malloc(PROF_MAX_TASKS * sizeof(*st));
+    TickType_t last = xTaskGetTickCount();
+    while (st) {
+        configRUN_TIME_COUNTER_TYPE total;
+        UBaseType_t n = read_state(st, &total);
+        if (n) sample_store(st, n, total);
+        xTaskDelayUntil(&last, pdMS_TO_TICKS(PROF_SAMPLE_MS));
+    }
+    ESP_LOGE(TAG, "no memory for task status");
+    vTaskDelete(NULL);
+}
+
+esp_err_t task_prof_start(void)
+{
+    s_ring = heap_caps_calloc(PROF_WINDOW + 1, sizeof(*s_ring),
+                              MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_ring) s_ring = calloc(PROF_WINDOW + 1, sizeof(*s_ring));
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_ring || !s_lock) return ESP_ERR_NO_MEM;
+    if (task_create(TASK_PROF, prof_task, NULL, NULL) != pdPASS) return ESP_ERR_NO_MEM;
+    ESP_LOGI(TAG, "task placement: %s", PLACEMENT_NAME);
+    return ESP_OK;
+}
+
+void task_prof_cpu(uint64_t *busy_us, uint64_t task_us[TASK_ID_COUNT])
+{
+    if (!s_lock) {
+        *busy_us = 0;
+        memset(task_us, 0, TASK_ID_COUNT * sizeof(*task_us));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *busy_us = s_busy_us;
+    memcpy(task_us, s_task_us, sizeof(s_task_us));
+    xSemaphoreGive(s_lock);
+}
+
+// ---------------------------------------------------------------------------
+// HTTP
+// ---------------------------------------------------------------------------
+static const char *state_name(eTaskState s)
+{
+    switch (s) {
+    case eRunning:   return "running";
+    case eReady:     return "ready";
+    case eBlocked:   return "blocked";
+    case eSuspended: return "suspended";
+    case eDeleted:   return "deleted";
+    default:         return "invalid";
+    }
+}
+
+static uint32_t configured_stack(const char *name)
+{
+    int id = task_id_by_name(name);
+    return id >= 0 ? k_tasks[id].stack : 0;
+}
+
+esp_err_t task_prof_handler(httpd_req_t *req)
+{
+    // Fenster in Sekunden: /debug/tasks?window=5 (Standard: ganzer Ring)
+    int window = PROF_WINDOW;
+    char query[32], val[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "window", val, sizeof(val)) == ESP_OK) {
+        window = atoi(val);
+        if (window < 1) window = 1;
+        if (window > PROF_WINDOW) window = PROF_WINDOW;
+    }
+
+    TaskStatus_t *st = malloc(PROF_MAX_TASKS * sizeof(*st));
+    prof_sample_t *base = malloc(sizeof(*base));
+    if (!st || !base || !s_ring) {
+        free(st);
+        free(base);
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "no memory");
+    }
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t n = read_state(st, &total);
+
+    // Basiswert: Abtastung vor window Sekunden, sonst die älteste vorhandene
+    bool have_base = false;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_filled) {
+        int back = window < s_filled ? window : s_filled;
+        *base = s_ring[(s_head - back + PROF_WINDOW + 1) % (PROF_WINDOW + 1)];
+        have_base = true;
+    }
+    xSemaphoreGive(s_lock);
+    const prof_sample_t *b = have_base ? base : NULL;
+    configRUN_TIME_COUNTER_TYPE span = total - (b ? b->total : 0);
+    if (!span) span = 1;
+
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "{\"placement\":\"%s\",\"cores\":%d,\"window_ms\":%lld,\"uptime_s\":%lld,\"load\":[",
+             PLACEMENT_NAME, portNUM_PROCESSORS,
+             (long long)(b ? (esp_timer_get_time() - b->ts_us) / 1000 : 0),
+             (long long)(esp_timer_get_time() / 1000000));
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr_chunk(req, buf);
+
+    // Last pro Kern = 100 % - Anteil der Idle-Task dieses Kerns
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(c);
+        configRUN_TIME_COUNTER_TYPE d = 0;
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (st[i].xHandle == idle) {
+                d = st[i].ulRunTimeCounter - base_runtime(b, st[i].xTaskNumber);
+            }
+        }
+        unsigned load = d >= span ? 0 : (unsigned)(1000 - (uint64_t)d * 1000 / span);
+        snprintf(buf, sizeof(buf), "%s%u.%u", c ? "," : "", load / 10, load % 10);
+        httpd_resp_sendstr_chunk(req, buf);
+    }
+    httpd_resp_sendstr_chunk(req, "],\"tasks\":[");
+
+    // CPU in Promille eines Kerns, absteigend sortiert
+    uint16_t permille[PROF_MAX_TASKS];
+    for (UBaseType_t i = 0; i < n; i++) {
+        configRUN_TIME_COUNTER_TYPE d = st[i].ulRunTimeCounter - base_runtime(b, st[i].xTaskNumber);
+        permille[i] = d >= span ? 1000 : (uint16_t)((uint64_t)d * 1000 / span);
+    }
+    for (UBaseType_t i = 1; i < n; i++) {
+        for (UBaseType_t j = i; j > 0 && permille[j] > permille[j - 1]; j--) {
+            TaskStatus_t t = st[j]; st[j] = st[j - 1]; st[j - 1] = t;
+            uint16_t p = permille[j]; permille[j] = permille[j - 1]; permille[j - 1] = p;
+        }
+    }
+    for (UBaseType_t i = 0; i < n; i++) {
+        BaseType_t core = st[i].xCoreID;
+        snprintf(buf, sizeof(buf),
+                 "%s{\"name\":\"%s\",\"cpu\":%u.%u,\"prio\":%u,\"core\":%d,"
+                 "\"stack\":%lu,\"stack_free\":%lu,\"state\":\"%s\"}",
+                 i ? "," : "", st[i].pcTaskName, permille[i] / 10, permille[i] % 10,
+                 (unsigned)st[i].uxCurrentPriority,
+                 core == tskNO_AFFINITY ? -1 : (int)core,
+                 (unsigned long)configured_stack(st[i].pcTaskName),
+                 (unsigned long)st[i].usStackHighWaterMark,
+                 state_name(st[i].eCurrentState));
+        httpd_resp_sendstr_chunk(req, buf);
+    }
+    free(st);
+    free(base);
+    httpd_resp_sendstr_chunk(req, "]}");
+    return httpd_resp_sendstr_chunk(req, NULL);
+}
@@ -0,0 +1,59 @@
+// task_prof.h — Task-Platzierung (Stack, Priorität, Kern) und /debug/tasks
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Platzierungsprofile für die eigenen Tasks. Zum Vergleichen umstellen,
+// mit tools/bench.py messen, /debug/tasks zeigt das aktive Profil.
+#define TASK_PLACEMENT_FREE    0   // alles ohne Affinität (Scheduler entscheidet)
+#define TASK_PLACEMENT_SPLIT   1   // Netz auf Kern 0 (bei WLAN/lwIP), Kamera/JPEG auf Kern 1
+#define TASK_PLACEMENT_SWAPPED 2   // umgekehrt: Kamera/JPEG auf Kern 0, Netz auf Kern 1
+
+#ifndef TASK_PLACEMENT
+#define TASK_PLACEMENT TASK_PLACEMENT_SPLIT
+#endif
+
+typedef enum {
+    TASK_CAPTURE,        // esp_camera_fb_get → Frame-Ring
+    TASK_SNAPSHOT,
+    TASK_BURST,          // Burst-Aufnahme (Snapshot-Modus)
+    TASK_MOTION,         // JPEG-DC-Analyse
+    TASK_HTTPD,
+    TASK_STREAM,         // Sender pro /stream-Client
+    TASK_BURST_SEND,     // Sender für /burst
+    TASK_CLIP_SEND,      // Sender für /clip-Downloads
+    TASK_WS,             // Sender pro /ws-Client
+    TASK_RTSP,           // RTSP-Listener
+    TASK_RTSP_SESSION,
+    TASK_WIFI_ROAM,
+    TASK_IP_LOGGER,
+    TASK_PROF,           // Abtastung für /debug/tasks
+    TASK_ID_COUNT
+} task_id_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    stack;   // Bytes
+    UBaseType_t prio;
+    BaseType_t  core;    // tskNO_AFFINITY oder Kern
+} task_place_t;
+
+// Eintrag der Platzierungstabelle
+const task_place_t *task_place(task_id_t id);
+
+// Task laut Tabelle anlegen (pdPASS wie xTaskCreate)
+BaseType_t task_create(task_id_t id, TaskFunction_t fn, void *arg, TaskHandle_t *out);
+
+// Abtastung der Laufzeitzähler starten (für CPU-Anteile über ein Fenster)
+esp_err_t task_prof_start(void);
+
+// Rechenzeit seit dem Start in µs, sekündlich vom Abtast-Task fortgeschrieben:
+// busy_us über alle Kerne ohne Idle-Tasks, task_us je Tabelleneintrag
+// (alle Sender-Tasks eines Typs zusammen)
+void task_prof_cpu(uint64_t *busy_us, uint64_t task_us[TASK_ID_COUNT]);
+
+// HTTP-URI-Handler: /debug/tasks[?window=s]
+esp_err_t task_prof_handler(httpd_req_t *req);
@@ -1,35 +1,317 @@
 // wifi.c
+//
+// Verbindungsaufbau:
+//  1) Zugangsdaten und der zuletzt erfolgreiche AP (BSSID, Kanal, Auth) liegen
+//     im NVS. Beim Start wird dieser AP direkt angesprochen (ein Kanal, kein
+//     Scan) — das spart nach einem Power-Cycle die Sekunden des Vollscans.
+//  2) Erst wenn das scheitert, wird gescannt. Alle APs mit bekannter SSID
+//     werden nach RSSI und Verschlüsselung bewertet und der Reihe nach
+//     versucht, der beste zuerst.
+//  3) Nach erfolgreicher Verbindung wird der AP wieder im NVS gemerkt.
+//  4) Im Betrieb überwacht ein Hintergrund-Task RSSI und TCP-Wiederholungen.
+//     Verschlechtert sich der Link, scannt er kanalweise (ein Kanal pro
+//     Sekunde, kurze Verweilzeit, damit der Stream nicht stockt) und wechselt
+//     zu einem deutlich besseren bekannten AP.
 #include "wifi.h"
+#include "sdkconfig.h"
 #include "esp_log.h"
 #include "nvs_flash.h"
+#include "nvs.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "esp_wifi.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "lwip/stats.h"
+#include "task_prof.h"
+#include <stdio.h>
 #include <string.h>
 
-#define MAX_AP_RECORDS   20
+#define MAX_AP_RECORDS     20
+#define WIFI_MAX_CREDS     8
+#define WIFI_MAX_CANDIDATES 8
+#define WIFI_DIRECT_TRIES  2        // Direktversuche auf den gemerkten AP vor dem Scan
+#define WIFI_MIN_RSSI      (-88)    // schwächere APs gar nicht erst versuchen
+#define WIFI_NVS_NS        "wifi_cfg"
+#define WIFI_LINK_IDLE_MS  30000    // so lange nach dem letzten Client im PERF-Profil bleiben
+#define WIFI_LINK_TX_MAX   84       // 0.25 dBm → 21 dBm
+
+// Roaming
+#define WIFI_ROAM_POLL_MS      1000     // RSSI-Abfrage und ein Scan-Kanal pro Takt
+#define WIFI_ROAM_RSSI_DBM     (-70)    // darunter gilt der Link als schlecht
+#define WIFI_ROAM_RETX_PCT     10       // TCP-Wiederholungen in % der Segmente
+#define WIFI_ROAM_RETX_MIN_SEG 50       // erst ab so vielen Segmenten im Fenster werten
+#define WIFI_ROAM_WINDOW_MS    10000    // Fenster für die Wiederholungsrate
+#define WIFI_ROAM_DELTA_DB     8        // neuer AP muss so viel besser sein
+#define WIFI_ROAM_BACKOFF_MS   60000    // Mindestabstand zwischen Roaming-Scans
+#define WIFI_ROAM_BACKOFF_MAX_MS 300000
+#define WIFI_ROAM_CHANNELS     13
+#define WIFI_ROAM_DWELL_MS     40       // aktive Verweilzeit pro Kanal
 
 static const char *WIFI_TAG            = "wifi";
 static esp_netif_t *s_sta_netif        = NULL;
 static esp_netif_ip_info_t s_ip_info;
 static bool s_ip_ready                 = false;
-static bool s_scan_in_progress         = false;
 static wifi_ap_record_t s_ap_records[MAX_AP_RECORDS];
 
 // -----------------------------------------------------------------------------
-// 1) Hier kommen Deine bekannten SSID/Passwort-Kombinationen
+// 1) Bekannte SSID/Passwort-Kombinationen
+//    Nur Erstbelegung: ist das NVS leer, werden die Paare aus menuconfig
+//    ("Look-ESP WLAN", landet in sdkconfig) übernommen. Danach gilt
+//    ausschließlich der NVS-Inhalt (wifi_cred_add/remove, POST /wifi).
 // -----------------------------------------------------------------------------
 typedef struct {
-    char ssid[32];
-    char password[64];
+    char ssid[33];
+    char password[65];
 } wifi_credential_t;
 
-static const wifi_credential_t wifi_credentials[] = {
-    { "Ultranet",          "Lassmichrein!" },
-    { "AndereSSID",        "AnderesPass!"  },
-    // weitere Paare hier hinzufügen
+static const wifi_credential_t k_seed_creds[] = {
+    { CONFIG_LOOK_WIFI_SSID1, CONFIG_LOOK_WIFI_PASS1 },
+    { CONFIG_LOOK_WIFI_SSID2, CONFIG_LOOK_WIFI_PASS2 },
 };
-#define WIFI_CRED_COUNT (sizeof(wifi_credentials) / sizeof(wifi_credentials[0]))
+#define WIFI_SEED_CRED_COUNT (sizeof(k_seed_creds) / sizeof(k_seed_creds[0]))
+
+// Geschrieben vom httpd-Task (/wifi), gelesen vom Event-Task
+static wifi_credential_t s_creds[WIFI_MAX_CREDS];
+static int s_cred_n;
+static portMUX_TYPE s_cred_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Zuletzt erfolgreicher AP (NVS-Blob "last_ap")
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t authmode;
+    char    ssid[33];
+} wifi_last_ap_t;
+
+static wifi_last_ap_t s_last_ap;
+static bool s_last_ap_valid;
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t  rssi;
+    wifi_auth_mode_t authmode;
+    int     cred;
+    int     score;
+} wifi_candidate_t;
+
+static wifi_candidate_t s_cand[WIFI_MAX_CANDIDATES];
+static int s_cand_n, s_cand_i;
+
+typedef enum {
+    WIFI_ST_IDLE,        // nichts läuft — nächster wifi_start_scan() scannt
+    WIFI_ST_DIRECT,      // Direktverbindung auf den gemerkten AP
+    WIFI_ST_SCANNING,
+    WIFI_ST_CANDIDATE,   // Kandidaten aus dem Scan der Reihe nach
+    WIFI_ST_CONNECTED,
+    WIFI_ST_ROAMING,     // bewusst getrennt, um zum Roaming-Ziel zu wechseln
+} wifi_state_t;
+
+static volatile wifi_state_t s_state = WIFI_ST_IDLE;
+static int s_direct_fails;
+static int64_t s_t_attempt;              // Beginn des aktuellen Verbindungsaufbaus
+static const char *s_attempt_path = "";
+
+// Link-Profil: PERF solange Streams/Snapshots laufen, sonst ECO
+static SemaphoreHandle_t   s_link_lock;
+static portMUX_TYPE        s_link_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t  s_link_idle_timer;
+static int                 s_link_users;
+static wifi_link_profile_t s_link_profile = WIFI_LINK_ECO;
+static uint32_t            s_link_transitions;
+static int64_t             s_link_since_us;
+static int8_t              s_link_tx_default = WIFI_LINK_TX_MAX;
+
+// Roaming-Monitor (Task + Scan-Event)
+typedef struct {
+    int      rssi_avg4;          // EWMA, dBm × 4
+    uint8_t  retx_pct;
+    bool     degraded;
+    volatile bool scanning;      // Kanal-Scan läuft
+    int      channel;            // nächster Kanal der laufenden Runde, 0 = keine
+    wifi_candidate_t best;       // bester fremder AP der Runde
+    bool     have_best;
+    uint8_t  cur_bssid[6];
+    int64_t  next_scan_us;
+    uint32_t backoff_ms;
+    uint32_t scans, roams;
+} wifi_roam_t;
+
+static wifi_roam_t s_roam = { .backoff_ms = WIFI_ROAM_BACKOFF_MS };
+
+static void roam_scan_done(void);
+
+// -----------------------------------------------------------------------------
+// NVS: Zugangsdaten und letzter AP
+// -----------------------------------------------------------------------------
+static void creds_save(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(WIFI_NVS_NS, NVS_READWRITE, &h) != ESP_OK) return;
+    char key[8];
+    for (int i = 0; i < WIFI_MAX_CREDS; i++) {
+        snprintf(key, sizeof(key), "ssid%d", i);
+        if (i < s_cred_n) nvs_set_str(h, key, s_creds[i].ssid);
+        else nvs_erase_key(h, key);
+        snprintf(key, sizeof(key), "pass%d", i);
+        if (i < s_cred_n) nvs_set_str(h, key, s_creds[i].password);
+        else nvs_erase_key(h, key);
+    }
+    nvs_set_u8(h, "n", (uint8_t)s_cred_n);
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+static void creds_load(void)
+{
+    nvs_handle_t h;
+    uint8_t n = 0;
+    bool stored = false;
+    s_cred_n = 0;
+    if (nvs_open(WIFI_NVS_NS, NVS_READONLY, &h) == ESP_OK) {
+        stored = nvs_get_u8(h, "n", &n) == ESP_OK;
+        if (stored) {
+            char key[8];
+            for (int i = 0; i < n && i < WIFI_MAX_CREDS; i++) {
+                size_t ls = sizeof(s_creds[0].ssid), lp = sizeof(s_creds[0].password);
+                snprintf(key, sizeof(key), "ssid%d", i);
+                if (nvs_get_str(h, key, s_creds[s_cred_n].ssid, &ls) != ESP_OK) continue;
+                snprintf(key, sizeof(key), "pass%d", i);
+                if (nvs_get_str(h, key, s_creds[s_cred_n].password, &lp) != ESP_OK) {
+                    s_creds[s_cred_n].password[0] = '\0';
+                }
+                s_cred_n++;
+            }
+        }
+        size_t len = sizeof(s_last_ap);
+        s_last_ap_valid = nvs_get_blob(h, "last_ap", &s_last_ap, &len) == ESP_OK &&
+                          len == sizeof(s_last_ap);
+        nvs_close(h);
+    }
+    if (!stored) {
+        // Erster Start: Vorgaben aus sdkconfig ins NVS übernehmen. Ohne
+        // Vorgaben bleibt das NVS leer, damit ein späterer Build mit
+        // Zugangsdaten noch greift.
+        for (int i = 0; i < WIFI_SEED_CRED_COUNT && s_cred_n < WIFI_MAX_CREDS; i++) {
+            if (k_seed_creds[i].ssid[0]) s_creds[s_cred_n++] = k_seed_creds[i];
+        }
+        if (s_cred_n) {
+            creds_save();
+            ESP_LOGI(WIFI_TAG, "Seeded %d credential(s) into NVS", s_cred_n);
+        } else {
+            ESP_LOGW(WIFI_TAG, "No credentials: set them in menuconfig or via POST /wifi");
+        }
+    }
+    ESP_LOGI(WIFI_TAG, "%d known SSID(s), last AP %s", s_cred_n,
+             s_last_ap_valid ? s_last_ap.ssid : "(none)");
+}
+
+static int cred_find(const char *ssid)
+{
+    for (int i = 0; i < s_cred_n; i++) {
+        if (strcmp(s_creds[i].ssid, ssid) == 0) return i;
+    }
+    return -1;
+}
+
+static void last_ap_save(const wifi_event_sta_connected_t *evt)
+{
+    wifi_last_ap_t ap = { 0 };
+    memcpy(ap.bssid, evt->bssid, sizeof(ap.bssid));
+    ap.channel  = evt->channel;
+    ap.authmode = (uint8_t)evt->authmode;
+    memcpy(ap.ssid, evt->ssid, evt->ssid_len < 32 ? evt->ssid_len : 32);
+
+    // Flash nur beschreiben, wenn sich etwas geändert hat
+    if (s_last_ap_valid && memcmp(&ap, &s_last_ap, sizeof(ap)) == 0) return;
+    s_last_ap       = ap;
+    s_last_ap_valid = true;
+
+    nvs_handle_t h;
+    if (nvs_open(WIFI_NVS_NS, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_set_blob(h, "last_ap", &ap, sizeof(ap));
+    nvs_commit(h);
+    nvs_close(h);
+    ESP_LOGI(WIFI_TAG, "Cached AP %s ch %d in NVS", ap.ssid, ap.channel);
+}
+
+// -----------------------------------------------------------------------------
+// Verbinden
+// -----------------------------------------------------------------------------
+static void connect_to(int cred, const uint8_t *bssid, uint8_t channel,
+                       wifi_auth_mode_t authmode)
+{
+    wifi_config_t sta_cfg = { 0 };
+    wifi_credential_t cr = { 0 };
+    portENTER_CRITICAL(&s_cred_mux);
+    if (cred < s_cred_n) cr = s_creds[cred];    // Liste kann sich über /wifi geändert haben
+    portEXIT_CRITICAL(&s_cred_mux);
+    if (!cr.ssid[0]) {
+        s_state = WIFI_ST_IDLE;
+        return;
+    }
+    strncpy((char*)sta_cfg.sta.ssid,     cr.ssid,     sizeof(sta_cfg.sta.ssid));
+    strncpy((char*)sta_cfg.sta.password, cr.password, sizeof(sta_cfg.sta.password));
+    // Mindest-Auth = gesehener Modus, höchstens WPA2 (WPA2/WPA3-Mischbetrieb)
+    sta_cfg.sta.threshold.authmode = authmode < WIFI_AUTH_WPA2_PSK ? authmode : WIFI_AUTH_WPA2_PSK;
+    sta_cfg.sta.scan_method = WIFI_FAST_SCAN;
+    if (bssid) {
+        sta_cfg.sta.bssid_set = true;
+        memcpy(sta_cfg.sta.bssid, bssid, sizeof(sta_cfg.sta.bssid));
+        sta_cfg.sta.channel = channel;    // nur diesen Kanal abfragen
+    }
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &sta_cfg);
+    if (err == ESP_OK) err = esp_wifi_connect();
+    if (err != ESP_OK) {
+        ESP_LOGW(WIFI_TAG, "connect to \"%s\" failed: %s", cr.ssid,
+                 esp_err_to_name(err));
+        s_state = WIFI_ST_IDLE;           // kein Disconnect-Event → Scan über wifi_start_scan()
+    }
+}
+
+static bool connect_direct(void)
+{
+    if (!s_last_ap_valid) return false;
+    int cred = cred_find(s_last_ap.ssid);
+    if (cred < 0) return false;
+    ESP_LOGI(WIFI_TAG, "▶ Direct connect to cached AP \"%s\" ch %d",
+             s_last_ap.ssid, s_last_ap.channel);
+    s_state        = WIFI_ST_DIRECT;
+    s_attempt_path = "direct";
+    connect_to(cred, s_last_ap.bssid, s_last_ap.channel, s_last_ap.authmode);
+    return true;
+}
+
+static void connect_next_candidate(void)
+{
+    if (s_cand_i >= s_cand_n) {
+        ESP_LOGW(WIFI_TAG, "✖ All %d candidate(s) failed", s_cand_n);
+        s_state = WIFI_ST_IDLE;           // nächster wifi_start_scan() versucht es neu
+        return;
+    }
+    const wifi_candidate_t *c = &s_cand[s_cand_i++];
+    ESP_LOGI(WIFI_TAG, "▶ Connecting to \"%s\" ch %d RSSI %d (candidate %d/%d)",
+             s_creds[c->cred].ssid, c->channel, c->rssi, s_cand_i, s_cand_n);
+    s_state = WIFI_ST_CANDIDATE;
+    connect_to(c->cred, c->bssid, c->channel, c->authmode);
+}
+
+// Verschlüsselung als Zuschlag auf den RSSI: bei ähnlichem Pegel gewinnt
+// das sicherere Netz, offene/WEP-Netze nur als letzte Wahl
+static int auth_bonus(wifi_auth_mode_t a)
+{
+    switch (a) {
+    case WIFI_AUTH_WPA3_PSK:
+    case WIFI_AUTH_WPA2_WPA3_PSK: return 6;
+    case WIFI_AUTH_WPA2_PSK:      return 4;
+    case WIFI_AUTH_WPA_WPA2_PSK:  return 2;
+    case WIFI_AUTH_WPA_PSK:       return 0;
+    default:                      return -20;
+    }
+}
 
 // -----------------------------------------------------------------------------
 // Event-Handler: IP-Adresse erhalten
@@ -41,63 +323,369 @@ static void wifi_event_handler(void *arg, esp_event_base_t base,
         ip_event_got_ip_t *evt = data;
         s_ip_info  = evt->ip_info;
         s_ip_ready = true;
-        ESP_LOGI(WIFI_TAG, "IP obtained: " IPSTR, IP2STR(&s_ip_info.ip));
+        ESP_LOGI(WIFI_TAG, "IP obtained: " IPSTR " (%s, %lld ms)", IP2STR(&s_ip_info.ip),
+                 s_attempt_path, (long long)((esp_timer_get_time() - s_t_attempt) / 1000));
     }
 }
 
 // -----------------------------------------------------------------------------
-// Event-Handler: Scan abgeschlossen → APs prüfen und ggf. verbinden
+// Event-Handler: Scan abgeschlossen → bekannte APs bewerten und verbinden
 // -----------------------------------------------------------------------------
 static void scan_done_handler(void *arg, esp_event_base_t base,
                               int32_t id, void *data)
 {
+    if (s_roam.scanning) {
+        roam_scan_done();
+        return;
+    }
+
     uint16_t ap_num = MAX_AP_RECORDS;
     esp_wifi_scan_get_ap_records(&ap_num, s_ap_records);
     ESP_LOGI(WIFI_TAG, "Scan done, %d AP(s) found:", ap_num);
 
-    int found_idx = -1;
+    s_cand_n = s_cand_i = 0;
     for (int i = 0; i < ap_num; i++) {
+        const wifi_ap_record_t *r = &s_ap_records[i];
         ESP_LOGI(WIFI_TAG, "  %2d: SSID=\"%s\"  Ch=%2d  RSSI=%4d  Auth=%d",
-                 i,
-                 s_ap_records[i].ssid,
-                 s_ap_records[i].primary,
-                 s_ap_records[i].rssi,
-                 s_ap_records[i].authmode);
-        // suche in den hinterlegten Credentials
-        for (int j = 0; j < WIFI_CRED_COUNT; j++) {
-            if (strcmp((char*)s_ap_records[i].ssid,
-                       wifi_credentials[j].ssid) == 0) {
-                found_idx = j;
-                break;
-            }
+                 i, r->ssid, r->primary, r->rssi, r->authmode);
+        int cred = cred_find((const char *)r->ssid);
+        if (cred < 0 || r->rssi < WIFI_MIN_RSSI || r->authmode == WIFI_AUTH_ENTERPRISE ||
+            s_cand_n == WIFI_MAX_CANDIDATES) {
+            continue;
         }
-        if (found_idx >= 0) {
-            break;
+
+        // Nach Bewertung absteigend einsortieren
+        int score = r->rssi + auth_bonus(r->authmode);
+        int k = s_cand_n++;
+        while (k > 0 && s_cand[k - 1].score < score) {
+            s_cand[k] = s_cand[k - 1];
+            k--;
         }
+        wifi_candidate_t *c = &s_cand[k];
+        memcpy(c->bssid, r->bssid, sizeof(c->bssid));
+        c->channel  = r->primary;
+        c->rssi     = r->rssi;
+        c->authmode = r->authmode;
+        c->cred     = cred;
+        c->score    = score;
     }
 
-    if (found_idx >= 0) {
-        ESP_LOGI(WIFI_TAG, "▶ Found known SSID \"%s\", connecting…",
-                 wifi_credentials[found_idx].ssid);
-        wifi_config_t sta_cfg = { 0 };
-        sta_cfg.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
-        strcpy((char*)sta_cfg.sta.ssid,     wifi_credentials[found_idx].ssid);
-        strcpy((char*)sta_cfg.sta.password, wifi_credentials[found_idx].password);
-        ESP_ERROR_CHECK( esp_wifi_set_config(WIFI_IF_STA, &sta_cfg) );
-        ESP_ERROR_CHECK( esp_wifi_connect() );
-    } else {
+    if (s_state != WIFI_ST_SCANNING) return;    // z. B. Scan von außen
+    if (s_cand_n == 0) {
         ESP_LOGW(WIFI_TAG, "✖ No known SSID in this scan");
+        s_state = WIFI_ST_IDLE;
+        return;
+    }
+    connect_next_candidate();
+}
+
+// -----------------------------------------------------------------------------
+// Event-Handler: Verbindung hergestellt / verloren
+// -----------------------------------------------------------------------------
+static void sta_event_handler(void *arg, esp_event_base_t base,
+                              int32_t id, void *data)
+{
+    if (id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_event_sta_connected_t *evt = data;
+        ESP_LOGI(WIFI_TAG, "Connected to \"%.*s\" ch %d", evt->ssid_len,
+                 (const char *)evt->ssid, evt->channel);
+        if (s_state == WIFI_ST_CANDIDATE && s_cand_i == 1 && s_roam.have_best &&
+            memcmp(evt->bssid, s_roam.best.bssid, 6) == 0) {
+            s_roam.roams++;
+            s_roam.backoff_ms = WIFI_ROAM_BACKOFF_MS;
+            ESP_LOGI(WIFI_TAG, "Roamed in %lld ms",
+                     (long long)((esp_timer_get_time() - s_t_attempt) / 1000));
+        }
+        s_roam.have_best = false;
+        s_state        = WIFI_ST_CONNECTED;
+        s_direct_fails = 0;
+        last_ap_save(evt);
+        return;
     }
+    if (id != WIFI_EVENT_STA_DISCONNECTED) return;
+
+    wifi_event_sta_disconnected_t *evt = data;
+    s_ip_ready = false;
+    ESP_LOGW(WIFI_TAG, "Disconnected (reason %d, state %d)", evt->reason, s_state);
 
-    s_scan_in_progress = false;
+    switch (s_state) {
+    case WIFI_ST_CONNECTED:
+        // Verbindung verloren: zuerst denselben AP direkt wieder versuchen
+        s_t_attempt    = esp_timer_get_time();
+        s_direct_fails = 0;
+        if (!connect_direct()) {
+            s_state = WIFI_ST_IDLE;
+            wifi_start_scan();
+        }
+        break;
+    case WIFI_ST_DIRECT:
+        // AP weg oder Passwort geändert → nicht weiter direkt probieren
+        if (++s_direct_fails < WIFI_DIRECT_TRIES &&
+            evt->reason != WIFI_REASON_NO_AP_FOUND && evt->reason != WIFI_REASON_AUTH_FAIL) {
+            esp_wifi_connect();
+            break;
+        }
+        ESP_LOGW(WIFI_TAG, "Direct connect failed, falling back to scan");
+        s_state = WIFI_ST_IDLE;
+        wifi_start_scan();
+        break;
+    case WIFI_ST_CANDIDATE:
+    case WIFI_ST_ROAMING:
+        // Roaming: Ziel-AP, danach notfalls der alte AP (s_cand)
+        connect_next_candidate();
+        break;
+    default:
+        break;
+    }
 }
 
 // -----------------------------------------------------------------------------
-// Initialisierung der Wi-Fi-Station und Start des ersten Scans
+// Roaming-Monitor
+// -----------------------------------------------------------------------------
+// Ergebnis eines Ein-Kanal-Scans: besten bekannten fremden AP merken
+static void roam_scan_done(void)
+{
+    uint16_t ap_num = MAX_AP_RECORDS;
+    esp_wifi_scan_get_ap_records(&ap_num, s_ap_records);
+    for (int i = 0; i < ap_num; i++) {
+        const wifi_ap_record_t *r = &s_ap_records[i];
+        int cred = cred_find((const char *)r->ssid);
+        if (cred < 0 || r->authmode == WIFI_AUTH_ENTERPRISE ||
+            memcmp(r->bssid, s_roam.cur_bssid, 6) == 0) {
+            continue;
+        }
+        int score = r->rssi + auth_bonus(r->authmode);
+        if (s_roam.have_best && score <= s_roam.best.score) continue;
+        memcpy(s_roam.best.bssid, r->bssid, 6);
+        s_roam.best.channel  = r->primary;
+        s_roam.best.rssi     = r->rssi;
+        s_roam.best.authmode = r->authmode;
+        s_roam.best.cred     = cred;
+        s_roam.best.score    = score;
+        s_roam.have_best     = true;
+    }
+    s_roam.scanning = false;
+}
+
+// Runde beendet: wechseln, wenn der beste Kandidat deutlich stärker ist
+static void roam_evaluate(const wifi_ap_record_t *cur)
+{
+    int cur_rssi = s_roam.rssi_avg4 / 4;
+    s_roam.channel = 0;
+    if (!s_roam.have_best || s_roam.best.rssi < cur_rssi + WIFI_ROAM_DELTA_DB) {
+        ESP_LOGI(WIFI_TAG, "Roam scan: no better AP (current %d dBm, best %d dBm)",
+                 cur_rssi, s_roam.have_best ? s_roam.best.rssi : 0);
+        s_roam.have_best  = false;
+        s_roam.backoff_ms = s_roam.backoff_ms * 2 > WIFI_ROAM_BACKOFF_MAX_MS
+                            ? WIFI_ROAM_BACKOFF_MAX_MS : s_roam.backoff_ms * 2;
+        s_roam.next_scan_us = esp_timer_get_time() + s_roam.backoff_ms * 1000LL;
+        return;
+    }
+
+    // Ziel zuerst, alter AP als Rückfall — beides ohne Scan (BSSID + Kanal)
+    int cur_cred = cred_find((const char *)cur->ssid);
+    s_cand[0] = s_roam.best;
+    s_cand_n  = 1;
+    if (cur_cred >= 0) {
+        wifi_candidate_t *c = &s_cand[s_cand_n++];
+        memcpy(c->bssid, cur->bssid, 6);
+        c->channel  = cur->primary;
+        c->rssi     = cur->rssi;
+        c->authmode = cur->authmode;
+        c->cred     = cur_cred;
+        c->score    = cur->rssi + auth_bonus(cur->authmode);
+    }
+    s_cand_i = 0;
+    ESP_LOGI(WIFI_TAG, "▶ Roaming from %d dBm to \"%s\" ch %d at %d dBm",
+             cur_rssi, s_creds[s_roam.best.cred].ssid, s_roam.best.channel, s_roam.best.rssi);
+    s_roam.next_scan_us = esp_timer_get_time() + WIFI_ROAM_BACKOFF_MS * 1000LL;
+    s_t_attempt    = esp_timer_get_time();
+    s_attempt_path = "roam";
+    s_state        = WIFI_ST_ROAMING;
+    esp_wifi_disconnect();                // Disconnect-Event verbindet zu s_cand[0]
+}
+
+static void roam_task(void *arg)
+{
+#if LWIP_STATS && TCP_STATS
+    uint32_t xmit0 = 0, rexmit0 = 0;
+#endif
+    int64_t  win_t0 = esp_timer_get_time();
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(WIFI_ROAM_POLL_MS));
+        wifi_ap_record_t ap;
+        if (s_state != WIFI_ST_CONNECTED || esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+            s_roam.rssi_avg4 = 0;
+            s_roam.channel   = 0;
+            continue;
+        }
+
+        // RSSI glätten; neuer AP → Mittelwert neu aufsetzen
+        if (!s_roam.rssi_avg4 || memcmp(ap.bssid, s_roam.cur_bssid, 6) != 0) {
+            memcpy(s_roam.cur_bssid, ap.bssid, 6);
+            s_roam.rssi_avg4 = ap.rssi * 4;
+            s_roam.channel   = 0;
+        } else {
+            s_roam.rssi_avg4 += ap.rssi - s_roam.rssi_avg4 / 4;
+        }
+
+        // TCP-Wiederholungen im Fenster (benötigt CONFIG_LWIP_STATS)
+        int64_t now = esp_timer_get_time();
+        if (now - win_t0 >= WIFI_ROAM_WINDOW_MS * 1000LL) {
+#if LWIP_STATS && TCP_STATS
+            uint32_t xmit   = lwip_stats.tcp.xmit;
+            uint32_t rexmit = lwip_stats.tcp.rexmit;
+            uint32_t dx = xmit - xmit0, dr = rexmit - rexmit0;
+            s_roam.retx_pct = dx >= WIFI_ROAM_RETX_MIN_SEG ? (uint8_t)(dr * 100 / dx) : 0;
+            xmit0   = xmit;
+            rexmit0 = rexmit;
+#endif
+            win_t0 = now;
+        }
+
+        bool degraded = s_roam.rssi_avg4 / 4 < WIFI_ROAM_RSSI_DBM ||
+                        s_roam.retx_pct > WIFI_ROAM_RETX_PCT;
+        if (degraded != s_roam.degraded) {
+            ESP_LOGI(WIFI_TAG, "Link %s: RSSI %d dBm, TCP retransmits %u%%",
+                     degraded ? "degraded" : "ok", s_roam.rssi_avg4 / 4, s_roam.retx_pct);
+            s_roam.degraded = degraded;
+        }
+
+        if (s_roam.scanning) continue;            // Kanal-Scan läuft noch
+        if (s_roam.channel == 0) {
+            if (!degraded || now < s_roam.next_scan_us) continue;
+            s_roam.channel   = 1;                 // neue Runde
+            s_roam.have_best = false;
+            s_roam.scans++;
+        } else if (s_roam.channel > WIFI_ROAM_CHANNELS) {
+            roam_evaluate(&ap);
+            continue;
+        }
+
+        // Ein Kanal pro Takt: kurz weg vom Heimkanal, Stream läuft weiter
+        wifi_scan_config_t sc = {
+            .channel   = (uint8_t)s_roam.channel++,
+            .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+            .scan_time = { .active = { .min = 0, .max = WIFI_ROAM_DWELL_MS } },
+        };
+        s_roam.scanning = true;
+        if (esp_wifi_scan_start(&sc, false) != ESP_OK) s_roam.scanning = false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Link-Profile
+//   PERF: kein Modem-Sleep, volle Sendeleistung — solange ein Stream oder
+//         Snapshot läuft (jeder Send ohne Aufwach-Latenz)
+//   ECO:  Modem-Sleep, Standard-Sendeleistung — nach WIFI_LINK_IDLE_MS ohne
+//         Client
+// Die Kanalbreite gehört nicht zum Profil: der Treiber handelt sie nur beim
+// Assoziieren aus, ein Wechsel zur Laufzeit bliebe bis zum nächsten Roaming
+// wirkungslos. HT40 wird deshalb einmal vor dem ersten Verbinden gesetzt und
+// greift, wenn der AP es anbietet.
+// -----------------------------------------------------------------------------
+static void link_apply(wifi_link_profile_t p)
+{
+    xSemaphoreTake(s_link_lock, portMAX_DELAY);
+    portENTER_CRITICAL(&s_link_mux);
+    int users = s_link_users;
+    portEXIT_CRITICAL(&s_link_mux);
+    // Idle-Timer und neuer Client können sich überholen: ECO nur ohne Clients
+    if (p == WIFI_LINK_ECO && users > 0) p = s_link_profile;
+    if (p != s_link_profile) {
+        bool perf = (p == WIFI_LINK_PERF);
+        esp_err_t e1 = esp_wifi_set_ps(perf ? WIFI_PS_NONE : WIFI_PS_MIN_MODEM);
+        esp_err_t e2 = esp_wifi_set_max_tx_power(perf ? WIFI_LINK_TX_MAX : s_link_tx_default);
+        int64_t now = esp_timer_get_time();
+        ESP_LOGI(WIFI_TAG, "link profile %s -> %s after %lld ms (ps %s, tx %s)",
+                 s_link_profile == WIFI_LINK_PERF ? "PERF" : "ECO", perf ? "PERF" : "ECO",
+                 (long long)((now - s_link_since_us) / 1000),
+                 esp_err_to_name(e1), esp_err_to_name(e2));
+        s_link_profile  = p;
+        s_link_since_us = now;
+        s_link_transitions++;
+    }
+    xSemaphoreGive(s_link_lock);
+}
+
+static void link_idle_cb(void *arg)
+{
+    portENTER_CRITICAL(&s_link_mux);
+    int users = s_link_users;
+    portEXIT_CRITICAL(&s_link_mux);
+    if (users == 0) link_apply(WIFI_LINK_ECO);
+}
+
+static void link_init(void)
+{
+    s_link_lock = xSemaphoreCreateMutex();
+    const esp_timer_create_args_t targs = {
+        .callback = link_idle_cb,
+        .name     = "wifi_link_idle",
+    };
+    esp_timer_create(&targs, &s_link_idle_timer);
+    esp_wifi_get_max_tx_power(&s_link_tx_default);
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    // Vor dem ersten connect: gilt ab der Assoziation, HT20-APs bleiben HT20
+    esp_err_t err = esp_wifi_set_bandwidth(WIFI_IF_STA, WIFI_BW_HT40);
+    if (err != ESP_OK) ESP_LOGW(WIFI_TAG, "HT40 not set: %s", esp_err_to_name(err));
+    s_link_since_us = esp_timer_get_time();
+}
+
+void wifi_link_acquire(void)
+{
+    if (!s_link_lock) return;
+    portENTER_CRITICAL(&s_link_mux);
+    s_link_users++;
+    portEXIT_CRITICAL(&s_link_mux);
+    esp_timer_stop(s_link_idle_timer);
+    link_apply(WIFI_LINK_PERF);
+}
+
+void wifi_link_release(void)
+{
+    if (!s_link_lock) return;
+    portENTER_CRITICAL(&s_link_mux);
+    int users = s_link_users > 0 ? --s_link_users : 0;
+    portEXIT_CRITICAL(&s_link_mux);
+    if (users == 0) {
+        esp_timer_stop(s_link_idle_timer);
+        esp_timer_start_once(s_link_idle_timer, WIFI_LINK_IDLE_MS * 1000ULL);
+    }
+}
+
+void wifi_link_get_status(wifi_link_status_t *st)
+{
+    portENTER_CRITICAL(&s_link_mux);
+    st->users = s_link_users;
+    portEXIT_CRITICAL(&s_link_mux);
+    st->profile     = s_link_profile;
+    st->transitions = s_link_transitions;
+    st->since_us    = s_link_since_us;
+    wifi_ap_record_t ap;
+    wifi_bandwidth_t bw;
+    bool up = s_state == WIFI_ST_CONNECTED && esp_wifi_sta_get_ap_info(&ap) == ESP_OK;
+    st->rssi = up ? ap.rssi : 0;
+    // HT40 nur, wenn eingestellt und der AP einen Nebenkanal führt
+    st->bw_mhz = !up ? 0
+               : esp_wifi_get_bandwidth(WIFI_IF_STA, &bw) == ESP_OK && bw == WIFI_BW_HT40 &&
+                 ap.second != WIFI_SECOND_CHAN_NONE ? 40 : 20;
+    st->rssi_avg   = (int8_t)(s_roam.rssi_avg4 / 4);
+    st->retx_pct   = s_roam.retx_pct;
+    st->degraded   = s_roam.degraded;
+    st->roam_scans = s_roam.scans;
+    st->roams      = s_roam.roams;
+}
+
+// -----------------------------------------------------------------------------
+// Initialisierung der Wi-Fi-Station: Direktverbindung oder erster Scan
 // -----------------------------------------------------------------------------
 void wifi_init_sta(void)
 {
-    // NVS (für Wi-Fi-Config)
+    s_t_attempt = esp_timer_get_time();
+
+    // NVS (Zugangsdaten, letzter AP)
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES ||
         ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -105,15 +693,17 @@ void wifi_init_sta(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    creds_load();
 
     // TCP/IP + Event-Loop + Netif
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     s_sta_netif = esp_netif_create_default_wifi_sta();
 
-    // Wi-Fi init
+    // Wi-Fi init; Config verwalten wir selbst im NVS
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
 
     // Event-Handler registrieren
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
@@ -124,14 +714,26 @@ void wifi_init_sta(void)
         WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
         &scan_done_handler, NULL, NULL
     ));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(
+        WIFI_EVENT, WIFI_EVENT_STA_CONNECTED,
+        &sta_event_handler, NULL, NULL
+    ));
+    ESP_ERROR_CHECK(esp_event_handler_instance_register(
+        WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+        &sta_event_handler, NULL, NULL
+    ));
 
     // Station mode & start
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_start());
-    ESP_LOGI(WIFI_TAG, "wifi_init_sta finished, starting AP scan…");
+    link_init();
+    task_create(TASK_WIFI_ROAM, roam_task, NULL, NULL);
+    ESP_LOGI(WIFI_TAG, "wifi_init_sta finished");
 
-    // ersten Scan anstoßen
-    wifi_start_scan();
+    // Gemerkten AP direkt ansprechen, sonst ersten Scan anstoßen
+    if (!connect_direct()) {
+        wifi_start_scan();
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -147,23 +749,172 @@ bool wifi_get_ip_info(esp_netif_ip_info_t *info)
 }
 
 // -----------------------------------------------------------------------------
-// AP-Scan non-blocking anstoßen
+// AP-Scan non-blocking anstoßen (nur wenn gerade kein Verbindungsaufbau läuft)
 // -----------------------------------------------------------------------------
 void wifi_start_scan(void)
 {
-    if (s_scan_in_progress) return;
+    if (s_state != WIFI_ST_IDLE) return;
     wifi_scan_config_t scan_conf = {
         .ssid        = NULL,
         .bssid       = NULL,
         .channel     = 0,
-        .show_hidden = true,
+        .show_hidden = false,     // versteckte SSIDs sind ohnehin nicht zuordenbar
     };
     esp_err_t err = esp_wifi_scan_start(&scan_conf, false);
     if (err == ESP_OK) {
-        s_scan_in_progress = true;
+        s_state        = WIFI_ST_SCANNING;
+        s_attempt_path = "scan";
         ESP_LOGI(WIFI_TAG, "AP scan started…");
     } else {
         ESP_LOGW(WIFI_TAG, "Failed to start AP scan: %s",
                  esp_err_to_name(err));
     }
 }
+
+// -----------------------------------------------------------------------------
+// Zugangsdaten im NVS pflegen
+// -----------------------------------------------------------------------------
+esp_err_t wifi_cred_add(const char *ssid, const char *password)
+{
+    if (!ssid || !ssid[0] || strlen(ssid) > 32 || (password && strlen(password) > 64)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&s_cred_mux);
+    int i = cred_find(ssid);
+    if (i < 0 && s_cred_n < WIFI_MAX_CREDS) i = s_cred_n++;
+    if (i >= 0) {
+        strncpy(s_creds[i].ssid, ssid, sizeof(s_creds[i].ssid) - 1);
+        strncpy(s_creds[i].password, password ? password : "", sizeof(s_creds[i].password) - 1);
+    } else {
+        err = ESP_ERR_NO_MEM;
+    }
+    portEXIT_CRITICAL(&s_cred_mux);
+    if (err == ESP_OK) creds_save();
+    return err;
+}
+
+esp_err_t wifi_cred_remove(const char *ssid)
+{
+    portENTER_CRITICAL(&s_cred_mux);
+    int i = cred_find(ssid);
+    if (i >= 0) {
+        memmove(&s_creds[i], &s_creds[i + 1], (s_cred_n - i - 1) * sizeof(s_creds[0]));
+        s_cred_n--;
+    }
+    portEXIT_CRITICAL(&s_cred_mux);
+    if (i < 0) return ESP_ERR_NOT_FOUND;
+    creds_save();
+    return ESP_OK;
+}
+
+// -----------------------------------------------------------------------------
+// HTTP: GET /wifi → bekannte SSIDs (ohne Passwörter) und aktueller AP
+//       POST /wifi mit Formular-Body add=<ssid>&pass=<pw> | remove=<ssid>
+// -----------------------------------------------------------------------------
+#define WIFI_BODY_MAX 160
+
+// Formularwert dekodieren (%XX und '+'); ESP_ERR_INVALID_SIZE, wenn er
+// nicht in out passt
+static esp_err_t form_value(const char *body, const char *key, char *out, size_t size)
+{
+    char raw[3 * 64 + 1];
+    esp_err_t err = httpd_query_key_value(body, key, raw, sizeof(raw));
+    if (err == ESP_ERR_HTTPD_RESULT_TRUNC) return ESP_ERR_INVALID_SIZE;
+    if (err != ESP_OK) return err;
+    size_t n = 0;
+    for (const char *p = raw; *p; p++) {
+        if (n + 1 >= size) return ESP_ERR_INVALID_SIZE;
+        unsigned v;
+        if (*p == '%' && p[1] && p[2] && sscanf(p + 1, "%2x", &v) == 1) {
+            out[n++] = (char)v;
+            p += 2;
+        } else {
+            out[n++] = *p == '+' ? ' ' : *p;
+        }
+    }
+    out[n] = '\0';
+    return ESP_OK;
+}
+
+// SSID als JSON-String (Anführungszeichen, Backslash, Steuerzeichen)
+static int json_ssid(char *out, size_t size, const char *ssid)
+{
+    size_t n = 0;
+    if (size < 3) return 0;
+    out[n++] = '"';
+    for (const char *p = ssid; *p && n + 8 < size; p++) {
+        unsigned char ch = (unsigned char)*p;
+        if (ch == '"' || ch == '\\') {
+            out[n++] = '\\';
+            out[n++] = ch;
+        } else if (ch < 0x20) {
+            n += snprintf(out + n, size - n, "\\u%04x", ch);
+        } else {
+            out[n++] = ch;
+        }
+    }
+    out[n++] = '"';
+    out[n] = '\0';
+    return n;
+}
+
+esp_err_t wifi_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_POST) {
+        char body[WIFI_BODY_MAX];
+        if (req->content_len >= sizeof(body)) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "body too long");
+        }
+        int got = 0;
+        while (got < (int)req->content_len) {
+            int n = httpd_req_recv(req, body + got, req->content_len - got);
+            if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+            if (n <= 0) return ESP_FAIL;
+            got += n;
+        }
+        body[got] = '\0';
+
+        char ssid[33], pass[65] = "";
+        esp_err_t err;
+        if ((err = form_value(body, "add", ssid, sizeof(ssid))) != ESP_ERR_NOT_FOUND) {
+            if (err == ESP_OK) err = form_value(body, "pass", pass, sizeof(pass));
+            if (err == ESP_ERR_NOT_FOUND) err = ESP_OK;        // offenes Netz
+            if (err == ESP_OK) err = wifi_cred_add(ssid, pass);
+            ESP_LOGI(WIFI_TAG, "/wifi: add \"%s\": %s", ssid, esp_err_to_name(err));
+        } else if (form_value(body, "remove", ssid, sizeof(ssid)) == ESP_OK) {
+            err = wifi_cred_remove(ssid);
+            ESP_LOGI(WIFI_TAG, "/wifi: remove \"%s\": %s", ssid, esp_err_to_name(err));
+        } else {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "need add= or remove=");
+        }
+        if (err == ESP_ERR_NOT_FOUND) {
+            return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "unknown ssid");
+        }
+        if (err != ESP_OK) {
+            return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, esp_err_to_name(err));
+        }
+        // Ohne Verbindung gleich mit der neuen Liste suchen
+        if (!s_ip_ready) wifi_start_scan();
+    }
+
+    char buf[64 + WIFI_MAX_CREDS * 72], ssid[72];
+    int n = 0;
+    wifi_ap_record_t ap;
+    bool up = esp_wifi_sta_get_ap_info(&ap) == ESP_OK;
+    if (up) json_ssid(ssid, sizeof(ssid), (const char *)ap.ssid);
+    n += snprintf(buf + n, sizeof(buf) - n, "{\"connected\":%s,\"known\":[",
+                  up ? ssid : "null");
+    wifi_credential_t creds[WIFI_MAX_CREDS];
+    portENTER_CRITICAL(&s_cred_mux);
+    int cn = s_cred_n;
+    memcpy(creds, s_creds, cn * sizeof(creds[0]));
+    portEXIT_CRITICAL(&s_cred_mux);
+    for (int i = 0; i < cn; i++) {
+        json_ssid(ssid, sizeof(ssid), creds[i].ssid);
+        n += snprintf(buf + n, sizeof(buf) - n, "%s%s", i ? "," : "", ssid);
+    }
+    snprintf(buf + n, sizeof(buf) - n, "],\"max\":%d}", WIFI_MAX_CREDS);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, buf);
+}
@@ -1,9 +1,40 @@
 // wifi.h
 #pragma once
 #include "esp_err.h"
+#include "esp_http_server.h"
 #include "esp_netif.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 void     wifi_init_sta(void);
 bool     wifi_get_ip_info(esp_netif_ip_info_t *info);
-void     wifi_start_scan(void);      // Scan anstoßen
+void     wifi_start_scan(void);      // Scan anstoßen (nur ohne laufenden Verbindungsaufbau)
+
+// Zugangsdaten im NVS (ersetzt ein vorhandenes Passwort derselben SSID)
+esp_err_t wifi_cred_add(const char *ssid, const char *password);
+esp_err_t wifi_cred_remove(const char *ssid);
+
+// HTTP-URI-Handler /wifi: GET listet die SSIDs, POST add=…&pass=… | remove=…
+esp_err_t wifi_handler(httpd_req_t *req);
+
+// Link-Profil: ECO (Modem-Sleep) ohne Clients, PERF (kein Sleep, volle
+// Sendeleistung) solange mindestens ein Stream/Snapshot aktiv ist
+typedef enum { WIFI_LINK_ECO = 0, WIFI_LINK_PERF = 1 } wifi_link_profile_t;
+
+typedef struct {
+    wifi_link_profile_t profile;
+    int      users;          // aktive Streams/Snapshots
+    uint32_t transitions;
+    int64_t  since_us;       // esp_timer-Zeit des letzten Wechsels
+    int8_t   rssi;           // 0 = nicht verbunden
+    uint8_t  bw_mhz;         // Kanalbreite der Verbindung (20/40), 0 = nicht verbunden
+    int8_t   rssi_avg;       // geglättet (Roaming-Monitor)
+    uint8_t  retx_pct;       // TCP-Wiederholungen im letzten Fenster
+    bool     degraded;
+    uint32_t roam_scans;     // Roaming-Scanrunden
+    uint32_t roams;          // erfolgreiche AP-Wechsel
+} wifi_link_status_t;
+
+void wifi_link_acquire(void);    // Client beginnt → sofort PERF
+void wifi_link_release(void);    // letzter Client fertig → nach Idle-Zeit ECO
+void wifi_link_get_status(wifi_link_status_t *st);
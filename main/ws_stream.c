@@ -0,0 +1,327 @@
+// ws_stream.c — /ws: jeder Frame eine WebSocket-Binärnachricht, Ack-Fenster
+//
+// Nachricht = 24-Byte-Kopf (little-endian: seq u32, JPEG-Länge u32,
+// Aufnahmezeit u64, Sendezeit u64, beide µs esp_timer) + JPEG.
+// Der Client quittiert jede Nachricht mit ihrer seq (4 Byte binär LE oder als
+// Text). Sobald Quittungen kommen, hält der Sender höchstens WS_MAX_OUTSTANDING
+// unquittierte Bytes im Netz; liegt der Client zurück, wartet er und schickt
+// danach den neuesten Frame — ältere werden nie nachgereicht. Ohne Quittungen
+// bremst nur der TCP-Sendepuffer (wie bei /stream).
+//
+// Die Zeit von der Aufnahme bis zur Quittung ist die Obergrenze für
+// Glass-to-Glass und landet in cam_ws_frame_age_at_ack_seconds.
+//
+// Gesendet wird wie bei /stream direkt auf den Socket aus einem eigenen Task,
+// damit ein langsamer Client nie den httpd-Task blockiert; httpd liefert nur
+// die eingehenden Nachrichten an ws_handler.
+#include "ws_stream.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "camera.h"
+#include "frame_ring.h"
+#include "metrics.h"
+#include "rate_ctrl.h"
+#include "task_prof.h"
+#include "wifi.h"
+
+static const char *TAG = "ws_stream";
+
+#define WS_MAX_OUTSTANDING   (32 * 1024)  // unquittierte Bytes pro Client
+#define WS_MAX_INFLIGHT      8            // unquittierte Nachrichten pro Client
+#define WS_ACK_TIMEOUT_MS    2000         // danach Fenster verwerfen, nur noch TCP
+#define WS_FRAME_WAIT_MS     500          // Takt, in dem Schließen bemerkt wird
+#define WS_IDLE_TIMEOUT_MS   5000         // kein neuer Frame → Verbindung beenden
+#define WS_RX_MAX            16           // Quittungen sind kurz
+
+typedef struct {
+    uint32_t seq;
+    uint32_t len;
+    int64_t  capture_us;
+} ws_inflight_t;
+
+typedef struct {
+    int             fd;           // -1: Slot frei
+    httpd_handle_t  hd;
+    TaskHandle_t    task;
+    frame_reader_t *rd;
+    volatile bool   closing;      // Client hat CLOSE geschickt
+    volatile bool   gone;         // Session geschlossen, Socket per shutdown() beendet
+    bool            acking;       // Client quittiert → Fenster aktiv
+    ws_inflight_t   inflight[WS_MAX_INFLIGHT];
+    int             head, count;
+    uint32_t        outstanding;  // Summe der unquittierten Bytes
+} ws_client_t;
+
+static ws_client_t  s_clients[WS_MAX_CLIENTS] = {
+    [0 ... WS_MAX_CLIENTS - 1] = { .fd = -1 },
+};
+static portMUX_TYPE s_ws_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static ws_client_t *find_client(int fd)
+{
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd == fd) return &s_clients[i];
+    }
+    return NULL;
+}
+
+static bool window_full(ws_client_t *c)
+{
+    portENTER_CRITICAL(&s_ws_mux);
+    bool full = c->acking &&
+                (c->outstanding >= WS_MAX_OUTSTANDING || c->count == WS_MAX_INFLIGHT);
+    portEXIT_CRITICAL(&s_ws_mux);
+    return full;
+}
+
+static void window_push(ws_client_t *c, uint32_t seq, uint32_t len, int64_t capture_us)
+{
+    portENTER_CRITICAL(&s_ws_mux);
+    if (c->count < WS_MAX_INFLIGHT) {
+        c->inflight[(c->head + c->count) % WS_MAX_INFLIGHT] =
+            (ws_inflight_t){ .seq = seq, .len = len, .capture_us = capture_us };
+        c->count++;
+        c->outstanding += len;
+    }
+    portEXIT_CRITICAL(&s_ws_mux);
+}
+
+static void window_reset(ws_client_t *c)
+{
+    portENTER_CRITICAL(&s_ws_mux);
+    c->head = c->count = 0;
+    c->outstanding = 0;
+    c->acking = false;
+    portEXIT_CRITICAL(&s_ws_mux);
+}
+
+// Quittung für seq (kumulativ): alle älteren Nachrichten gelten als angekommen
+static void handle_ack(int fd, uint32_t seq)
+{
+    int64_t now = esp_timer_get_time(), capture_us = 0;
+    TaskHandle_t task = NULL;
+
+    portENTER_CRITICAL(&s_ws_mux);
+    ws_client_t *c = find_client(fd);
+    if (c) {
+        c->acking = true;
+        while (c->count && (int32_t)(c->inflight[c->head].seq - seq) <= 0) {
+            ws_inflight_t *e = &c->inflight[c->head];
+            if (e->seq == seq) capture_us = e->capture_us;
+            c->outstanding -= e->len;
+            c->head = (c->head + 1) % WS_MAX_INFLIGHT;
+            c->count--;
+        }
+        task = c->task;
+    }
+    portEXIT_CRITICAL(&s_ws_mux);
+
+    if (capture_us) metrics_observe(MET_H_WS_ACK_AGE_US, (uint32_t)(now - capture_us));
+    if (task) xTaskNotifyGive(task);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+// Kopf einer unmaskierten Server-Nachricht (FIN + opcode, Länge 7/16/64 Bit)
+static size_t ws_frame_header(uint8_t *p, uint8_t opcode, uint64_t len)
+{
+    p[0] = 0x80 | opcode;
+    if (len < 126) {
+        p[1] = len;
+        return 2;
+    }
+    if (len <= 0xFFFF) {
+        p[1] = 126;
+        p[2] = len >> 8;
+        p[3] = len;
+        return 4;
+    }
+    p[1] = 127;
+    for (int i = 0; i < 8; i++) p[2 + i] = len >> (8 * (7 - i));
+    return 10;
+}
+
+// Sender-Task pro Client; endet bei CLOSE, Sendefehler oder ohne neue Frames
+static void ws_task(void *arg)
+{
+    ws_client_t *c = arg;
+    int fd = c->fd;
+    int idle_ms = 0;
+    int slot = metrics_client_open("ws", fd);
+    wifi_link_acquire();
+    stream_tune_socket(fd);
+
+    while (!c->closing && !c->gone) {
+        if (window_full(c)) {
+            if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WS_ACK_TIMEOUT_MS)) && window_full(c)) {
+                ESP_LOGW(TAG, "fd %d: no ack for %d ms, falling back to TCP flow control",
+                         fd, WS_ACK_TIMEOUT_MS);
+                window_reset(c);
+            }
+            continue;
+        }
+        const frame_t *f = frame_ring_next(c->rd, pdMS_TO_TICKS(WS_FRAME_WAIT_MS));
+        if (!f) {
+            idle_ms += WS_FRAME_WAIT_MS;
+            if (idle_ms >= WS_IDLE_TIMEOUT_MS) {
+                ESP_LOGW(TAG, "fd %d: no frame, closing", fd);
+                break;
+            }
+            continue;
+        }
+        idle_ms = 0;
+
+        int64_t t_send = esp_timer_get_time();
+        uint8_t hdr[10 + WS_FRAME_HDR_LEN];
+        size_t h = ws_frame_header(hdr, HTTPD_WS_TYPE_BINARY, WS_FRAME_HDR_LEN + f->len);
+        put_le32(hdr + h,      f->seq);
+        put_le32(hdr + h + 4,  f->len);
+        put_le64(hdr + h + 8,  f->timestamp_us);
+        put_le64(hdr + h + 16, t_send);
+        h += WS_FRAME_HDR_LEN;
+
+        // Vor dem Senden eintragen, damit eine schnelle Quittung ihn findet
+        window_push(c, f->seq, h + f->len, f->timestamp_us);
+        struct iovec iov[2] = {
+            { .iov_base = hdr,            .iov_len = h },
+            { .iov_base = (void *)f->buf, .iov_len = f->len },
+        };
+        size_t len = f->len;
+        esp_err_t res = c->gone ? ESP_FAIL : stream_writev_all(fd, iov, 2);
+        frame_ring_release(f);
+        if (res != ESP_OK) {
+            if (!c->gone) ESP_LOGW(TAG, "fd %d: send error, errno %d", fd, errno);
+            break;
+        }
+        int64_t send_us = esp_timer_get_time() - t_send;
+        metrics_observe(MET_H_SEND_US, (uint32_t)send_us);
+        metrics_client_frame(slot, len, frame_ring_reader_dropped(c->rd));
+        camera_report_send_time(send_us);
+        rate_ctrl_report(len, send_us);
+    }
+
+    ESP_LOGI(TAG, "fd %d closed, %u frame(s) skipped", fd,
+             (unsigned)frame_ring_reader_dropped(c->rd));
+    frame_ring_reader_close(c->rd);
+    metrics_client_close(slot);
+    wifi_link_release();
+
+    // Der Task besitzt den Socket, bis c->fd freigegeben ist: schließt httpd
+    // die Session vorher, macht ws_stream_sess_closed() nur shutdown() und
+    // das close() bleibt hier — so kann die fd-Nummer nicht neu vergeben
+    // werden, solange noch geschrieben wird.
+    if (!c->gone) {
+        // CLOSE beantworten bzw. selbst schließen (1001: going away)
+        uint8_t bye[4] = { 0x80 | HTTPD_WS_TYPE_CLOSE, 2, 0x03, 0xE9 };
+        send(fd, bye, sizeof(bye), MSG_DONTWAIT);
+    }
+    portENTER_CRITICAL(&s_ws_mux);
+    bool gone = c->gone;
+    httpd_handle_t hd = c->hd;
+    c->fd = -1;
+    portEXIT_CRITICAL(&s_ws_mux);
+    if (gone) {
+        close(fd);
+    } else {
+        httpd_sess_trigger_close(hd, fd);    // close_fn findet den Client nicht mehr
+    }
+    vTaskDelete(NULL);
+}
+
+// Handshake ist erledigt (httpd hat 101 gesendet): Sender starten
+static esp_err_t ws_open(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+    ws_client_t *c = NULL;
+    portENTER_CRITICAL(&s_ws_mux);
+    if (!find_client(fd)) c = find_client(-1);
+    if (c) {
+        memset(c, 0, sizeof(*c));
+        c->fd = fd;
+        c->hd = req->handle;
+    }
+    portEXIT_CRITICAL(&s_ws_mux);
+    if (!c) {
+        ESP_LOGW(TAG, "too many websocket clients");
+        return ESP_FAIL;          // httpd schließt die Session
+    }
+
+    c->rd = frame_ring_reader_open();
+    if (!c->rd || task_create(TASK_WS, ws_task, c, &c->task) != pdPASS) {
+        ESP_LOGE(TAG, "ws client start failed");
+        if (c->rd) frame_ring_reader_close(c->rd);
+        c->fd = -1;
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "fd %d opened", fd);
+    return ESP_OK;
+}
+
+esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) return ws_open(req);
+
+    uint8_t buf[WS_RX_MAX + 1];
+    httpd_ws_frame_t fr = { .payload = buf };
+    if (httpd_ws_recv_frame(req, &fr, 0) != ESP_OK || fr.len > WS_RX_MAX) {
+        return ESP_FAIL;
+    }
+    if (fr.len && httpd_ws_recv_frame(req, &fr, WS_RX_MAX) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    int fd = httpd_req_to_sockfd(req);
+    switch (fr.type) {
+    case HTTPD_WS_TYPE_BINARY:
+        if (fr.len >= 4) {
+            handle_ack(fd, buf[0] | buf[1] << 8 | buf[2] << 16 | (uint32_t)buf[3] << 24);
+        }
+        break;
+    case HTTPD_WS_TYPE_TEXT:
+        buf[fr.len] = '\0';
+        handle_ack(fd, strtoul((const char *)buf, NULL, 10));
+        break;
+    case HTTPD_WS_TYPE_CLOSE: {
+        portENTER_CRITICAL(&s_ws_mux);
+        ws_client_t *c = find_client(fd);
+        TaskHandle_t task = c ? c->task : NULL;
+        if (c) c->closing = true;
+        portEXIT_CRITICAL(&s_ws_mux);
+        if (task) xTaskNotifyGive(task);
+        break;
+    }
+    default:                      // PING/PONG: nicht benötigt
+        break;
+    }
+    return ESP_OK;
+}
+
+bool ws_stream_sess_closed(int fd)
+{
+    TaskHandle_t task = NULL;
+    portENTER_CRITICAL(&s_ws_mux);
+    ws_client_t *c = find_client(fd);
+    if (c) {
+        c->gone = true;
+        task = c->task;
+    }
+    portEXIT_CRITICAL(&s_ws_mux);
+    if (!task) return false;
+    // Blockierendes writev im Sender sofort beenden; close() macht der Sender
+    shutdown(fd, SHUT_RDWR);
+    xTaskNotifyGive(task);
+    return true;
+}
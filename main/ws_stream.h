@@ -0,0 +1,17 @@
+// ws_stream.h — Frames als WebSocket-Binärnachrichten (/ws)
+#pragma once
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#define WS_MAX_CLIENTS      4
+#define WS_FRAME_HDR_LEN    24      // Kopf vor jedem JPEG, siehe ws_stream.c
+
+// HTTP-URI-Handler für /ws (is_websocket, handle_ws_control_frames):
+// Handshake startet den Sender-Task, eingehende Nachrichten sind Quittungen
+esp_err_t ws_handler(httpd_req_t *req);
+
+// Aus dem close_fn des Servers: Session fd ist weg. Gehört der Socket noch
+// einem Sender-Task, wird er nur per shutdown() beendet und true geliefert —
+// der Task schließt ihn dann selbst. false: der Aufrufer muss close() rufen.
+bool ws_stream_sess_closed(int fd);
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""Last- und Durchsatztest für /stream und /snapshot.
+
+Startet N Stream-Clients und M Snapshot-Clients gegen ein Board (oder die
+Host-Firmware look_host, siehe host/), misst FPS, Frame-Abstände, Übertragungszeiten und
+Snapshot-Latenzen und liest vorher/nachher /metrics, um die Stufen auf dem
+Gerät (fb_get-Wartezeit, Sendezeit, CPU pro Frame) zuzuordnen.
+
+Beispiele:
+    tools/bench.py 192.168.1.50 --clients 3 --duration 20
+    tools/bench.py 127.0.0.1:8080 --clients 4 --snapshots 2 --maxage 2000
+    tools/bench.py 192.168.1.50 --json result.json --baseline last.json
+
+Mit --baseline endet das Skript mit Exit-Code 1, wenn die FPS um mehr als
+--tolerance Prozent unter dem gespeicherten Lauf liegen.
+"""
+import argparse
+import http.client
+import json
+import re
+import socket
+import sys
+import threading
+import time
+
+BOUNDARY_RE = re.compile(rb"boundary=([^\s;]+)")
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    s = sorted(values)
+    k = (len(s) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(s) - 1)
+    return s[lo] + (s[hi] - s[lo]) * (k - lo)
+
+
+def split_host(host):
+    if ":" in host:
+        h, p = host.rsplit(":", 1)
+        return h, int(p)
+    return host, 80
+
+
+class StreamClient(threading.Thread):
+    """Liest multipart/x-mixed-replace und protokolliert jeden Frame."""
+
+    def __init__(self, host, port, path, stop_at):
+        super().__init__(daemon=True)
+        self.host, self.port, self.path = host, port, path
+        self.stop_at = stop_at
+        self.frames = []          # (Ankunft, Bytes, Lesedauer)
+        self.first_frame_s = None
+        self.error = None
+
+    def run(self):
+        try:
+            self._run()
+        except Exception as e:    # Abbruch zählt als Fehler des Clients
+            self.error = str(e)
+
+    def _run(self):
+        t_open = time.monotonic()
+        sock = socket.create_connection((self.host, self.port), timeout=10)
+        sock.sendall(f"GET {self.path} HTTP/1.1\r\nHost: {self.host}\r\n\r\n".encode())
+        f = sock.makefile("rb")
+
+        status = f.readline()
+        if b" 200 " not in status:
+            raise RuntimeError(f"stream: {status.strip().decode(errors='replace')}")
+        boundary = b"frame"
+        while True:
+            line = f.readline()
+            if not line or line in (b"\r\n", b"\n"):
+                break
+            m = BOUNDARY_RE.search(line)
+            if m:
+                boundary = m.group(1)
+
+        marker = b"--" + boundary
+        while time.monotonic() < self.stop_at:
+            line = f.readline()
+            if not line:
+                raise RuntimeError("stream closed by device")
+            if not line.startswith(marker):
+                continue
+            t_part = time.monotonic()
+            length = None
+            while True:
+                h = f.readline()
+                if not h or h in (b"\r\n", b"\n"):
+                    break
+                k, _, v = h.partition(b":")
+                if k.strip().lower() == b"content-length":
+                    length = int(v.strip())
+            if length is None:
+                raise RuntimeError("part without Content-Length")
+            body = f.read(length)
+            t_done = time.monotonic()
+            if len(body) != length:
+                raise RuntimeError("short frame")
+            if self.first_frame_s is None:
+                self.first_frame_s = t_done - t_open
+            self.frames.append((t_done, length, t_done - t_part))
+        sock.close()
+
+
+class SnapshotClient(threading.Thread):
+    def __init__(self, host, port, path, interval, stop_at):
+        super().__init__(daemon=True)
+        self.host, self.port, self.path = host, port, path
+        self.interval = interval
+        self.stop_at = stop_at
+        self.latencies = []
+        self.cache = {}
+        self.errors = 0
+
+    def run(self):
+        etag = None
+        while time.monotonic() < self.stop_at:
+            t0 = time.monotonic()
+            try:
+                c = http.client.HTTPConnection(self.host, self.port, timeout=30)
+                headers = {"If-None-Match": etag} if etag else {}
+                c.request("GET", self.path, headers=headers)
+                r = c.getresponse()
+                r.read()
+                if r.status in (200, 304):
+                    self.latencies.append(time.monotonic() - t0)
+                    state = r.getheader("X-Cache", "304" if r.status == 304 else "-")
+                    self.cache[state] = self.cache.get(state, 0) + 1
+                    etag = r.getheader("ETag", etag)
+                else:
+                    self.errors += 1
+                c.close()
+            except OSError:
+                self.errors += 1
+            rest = self.interval - (time.monotonic() - t0)
+            if rest > 0:
+                time.sleep(rest)
+
+
+def read_metrics(host, port):
+    """/metrics als {Name{Labels}: Wert}; leer, wenn das Gerät keine hat."""
+    try:
+        c = http.client.HTTPConnection(host, port, timeout=5)
+        c.request("GET", "/metrics")
+        r = c.getresponse()
+        text = r.read().decode(errors="replace")
+        if r.status != 200:
+            return {}
+    except OSError:
+        return {}
+    out = {}
+    for line in text.splitlines():
+        if not line or line.startswith("#"):
+            continue
+        key, _, val = line.rpartition(" ")
+        try:
+            out[key] = float(val)
+        except ValueError:
+            pass
+    return out
+
+
+def metric_delta(before, after, key):
+    return after.get(key, 0.0) - before.get(key, 0.0)
+
+
+def device_stages(before, after):
+    """Mittlere Stufenzeiten pro Frame aus den Histogramm-Summen."""
+    res = {}
+    frames = metric_delta(before, after, "cam_frames_captured_total")
+    res["frames_captured"] = frames
+    res["frames_dropped"] = metric_delta(before, after, "cam_frames_dropped_total")
+    for name, key in (("fb_get_wait_ms", "cam_fb_get_wait_seconds"),
+                      ("send_ms", "cam_stream_send_seconds"),
+                      ("mode_switch_ms", "cam_mode_switch_seconds")):
+        n = metric_delta(before, after, key + "_count")
+        if n > 0:
+            res[name] = metric_delta(before, after, key + "_sum") / n * 1000.0
+    # CPU-Zeit (task_prof): Gerät gesamt, Capture-Task, Sender-Tasks
+    if frames > 0:
+        for name, tasks in (("cpu_ms_per_frame", None),
+                            ("capture_cpu_ms_per_frame", ("cam_capture",)),
+                            ("send_cpu_ms_per_frame", ("stream", "ws_stream", "rtsp_sess"))):
+            keys = (["process_cpu_seconds_total"] if tasks is None else
+                    ['task_cpu_seconds_total{task="%s"}' % t for t in tasks])
+            if not all(k in after for k in keys):
+                continue
+            cpu = sum(metric_delta(before, after, k) for k in keys)
+            res[name] = cpu / frames * 1000.0
+    return res
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("host", help="IP[:Port] des Boards oder von look_host")
+    ap.add_argument("--clients", type=int, default=1, help="Stream-Clients")
+    ap.add_argument("--fps", type=int, default=0, help="?fps= pro Stream-Client")
+    ap.add_argument("--snapshots", type=int, default=0, help="Snapshot-Clients")
+    ap.add_argument("--snapshot-interval", type=float, default=1.0, help="s zwischen Snapshots")
+    ap.add_argument("--maxage", type=int, default=0, help="?maxage= für Snapshots (ms)")
+    ap.add_argument("--duration", type=float, default=15.0, help="Messdauer in s")
+    ap.add_argument("--warmup", type=float, default=2.0, help="nicht gewertete Anlaufzeit in s")
+    ap.add_argument("--json", help="Ergebnis als JSON speichern")
+    ap.add_argument("--baseline", help="früheres JSON-Ergebnis zum Vergleich")
+    ap.add_argument("--tolerance", type=float, default=10.0, help="erlaubter FPS-Verlust in %%")
+    args = ap.parse_args()
+
+    host, port = split_host(args.host)
+    before = read_metrics(host, port)
+    t_start = time.monotonic()
+    stop_at = t_start + args.warmup + args.duration
+    t_eval = t_start + args.warmup
+
+    stream_path = "/stream" + (f"?fps={args.fps}" if args.fps else "")
+    snap_path = "/snapshot" + (f"?maxage={args.maxage}" if args.maxage else "")
+    streams = [StreamClient(host, port, stream_path, stop_at) for _ in range(args.clients)]
+    snaps = [SnapshotClient(host, port, snap_path, args.snapshot_interval, stop_at)
+             for _ in range(args.snapshots)]
+    for t in streams + snaps:
+        t.start()
+    for t in streams + snaps:
+        t.join(timeout=args.warmup + args.duration + 30)
+    after = read_metrics(host, port)
+
+    result = {"clients": [], "snapshot": {}, "device": device_stages(before, after)}
+    all_gaps, all_reads, total_fps = [], [], 0.0
+    for i, c in enumerate(streams):
+        fr = [f for f in c.frames if f[0] >= t_eval]
+        gaps = [(b[0] - a[0]) * 1000.0 for a, b in zip(fr, fr[1:])]
+        reads = [f[2] * 1000.0 for f in fr]
+        span = fr[-1][0] - fr[0][0] if len(fr) > 1 else 0.0
+        fps = (len(fr) - 1) / span if span > 0 else 0.0
+        kbps = sum(f[1] for f in fr) * 8 / 1000.0 / span if span > 0 else 0.0
+        total_fps += fps
+        all_gaps += gaps
+        all_reads += reads
+        result["clients"].append({
+            "fps": round(fps, 2), "kbps": round(kbps, 1), "frames": len(fr),
+            "first_frame_ms": round((c.first_frame_s or 0) * 1000.0, 1),
+            "gap_p50_ms": round(percentile(gaps, 50), 1),
+            "gap_p95_ms": round(percentile(gaps, 95), 1),
+            "gap_p99_ms": round(percentile(gaps, 99), 1),
+            "gap_max_ms": round(max(gaps) if gaps else 0.0, 1),
+            "read_p50_ms": round(percentile(reads, 50), 1),
+            "read_p95_ms": round(percentile(reads, 95), 1),
+            "error": c.error,
+        })
+    result["fps_total"] = round(total_fps, 2)
+    result["fps_per_client"] = round(total_fps / len(streams), 2) if streams else 0.0
+    result["gap_p95_ms"] = round(percentile(all_gaps, 95), 1)
+    result["read_p95_ms"] = round(percentile(all_reads, 95), 1)
+
+    lat = [l * 1000.0 for s in snaps for l in s.latencies]
+    if snaps:
+        cache = {}
+        for s in snaps:
+            for k, v in s.cache.items():
+                cache[k] = cache.get(k, 0) + v
+        result["snapshot"] = {
+            "requests": len(lat), "errors": sum(s.errors for s in snaps),
+            "p50_ms": round(percentile(lat, 50), 1),
+            "p95_ms": round(percentile(lat, 95), 1),
+            "p99_ms": round(percentile(lat, 99), 1),
+            "cache": cache,
+        }
+
+    # Ausgabe
+    print(f"{'client':>6} {'fps':>6} {'kbit/s':>8} {'first':>7} {'gap50':>7} {'gap95':>7} "
+          f"{'gap99':>7} {'gapmax':>7} {'read95':>7}")
+    for i, c in enumerate(result["clients"]):
+        print(f"{i:>6} {c['fps']:>6.1f} {c['kbps']:>8.0f} {c['first_frame_ms']:>7.0f} "
+              f"{c['gap_p50_ms']:>7.1f} {c['gap_p95_ms']:>7.1f} {c['gap_p99_ms']:>7.1f} "
+              f"{c['gap_max_ms']:>7.1f} {c['read_p95_ms']:>7.1f}"
+              + (f"  ERROR: {c['error']}" if c["error"] else ""))
+    print(f"total {result['fps_total']:.1f} fps, {result['fps_per_client']:.1f} per client")
+    if result["snapshot"]:
+        s = result["snapshot"]
+        print(f"snapshot: {s['requests']} ok, {s['errors']} errors, p50 {s['p50_ms']:.0f} ms, "
+              f"p95 {s['p95_ms']:.0f} ms, p99 {s['p99_ms']:.0f} ms, cache {s['cache']}")
+    if result["device"]:
+        print("device: " + ", ".join(f"{k} {v:.1f}" if isinstance(v, float) else f"{k} {v}"
+                                     for k, v in result["device"].items()))
+
+    if args.json:
+        with open(args.json, "w") as fh:
+            json.dump(result, fh, indent=2)
+
+    rc = 0
+    if any(c["error"] for c in result["clients"]):
+        rc = 1
+    if args.baseline:
+        with open(args.baseline) as fh:
+            base = json.load(fh)
+        ref = base.get("fps_per_client", 0.0)
+        if ref > 0:
+            loss = (ref - result["fps_per_client"]) / ref * 100.0
+            print(f"baseline {ref:.1f} fps per client, change {-loss:+.1f}%")
+            if loss > args.tolerance:
+                print("REGRESSION: fps below baseline")
+                rc = 1
+    sys.exit(rc)
+
+
+if __name__ == "__main__":
+    main()
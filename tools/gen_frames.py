@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""Synthetische Kamera-Frames als Baseline-JPEG (4:2:2 wie der OV5640).
+
+Erzeugt kurze Sequenzen für Host-Tests und look_host (host/), ohne
+Board und ohne Bildbibliothek:
+
+    still    ruhige Szene, nur Sensorrauschen
+    moving   dieselbe Szene, ein heller Block wandert von links nach rechts
+    aec      ruhige Szene, alle Frames gleichmäßig heller (Belichtungssprung)
+
+    tools/gen_frames.py host/test/frames
+    tools/gen_frames.py frames/ --scene moving --size 1024x768 --count 20
+
+Ohne --scene werden die Fixtures für host/test/test_motion.c geschrieben.
+"""
+import argparse
+import math
+import os
+import random
+import struct
+
+ZIGZAG = [
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+]
+QT_LUM = [
+    16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99,
+]
+QT_CHR = [17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+          24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99] + [99] * 32
+
+# ITU T.81 Annex K.3
+DC_LUM_BITS = [0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0]
+DC_CHR_BITS = [0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0]
+DC_VALS = list(range(12))
+AC_LUM_BITS = [0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d]
+AC_LUM_VALS = bytes.fromhex(
+    "01020300041105122131410613516107227114328191a1082342b1c11552d1f0"
+    "2433627282090a161718191a25262728292a3435363738393a43444546474849"
+    "4a535455565758595a636465666768696a737475767778797a83848586878889"
+    "8a92939495969798999aa2a3a4a5a6a7a8a9aab2b3b4b5b6b7b8b9bac2c3c4c5"
+    "c6c7c8c9cad2d3d4d5d6d7d8d9dae1e2e3e4e5e6e7e8e9eaf1f2f3f4f5f6f7f8"
+    "f9fa")
+AC_CHR_BITS = [0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77]
+AC_CHR_VALS = bytes.fromhex(
+    "000102031104052131061241510761711322328108144291a1b1c109233352f0"
+    "156272d10a162434e125f11718191a262728292a35363738393a434445464748"
+    "494a535455565758595a636465666768696a737475767778797a828384858687"
+    "88898a92939495969798999aa2a3a4a5a6a7a8a9aab2b3b4b5b6b7b8b9bac2c3"
+    "c4c5c6c7c8c9cad2d3d4d5d6d7d8d9dae2e3e4e5e6e7e8e9eaf2f3f4f5f6f7f8"
+    "f9fa")
+
+COS = [[(math.sqrt(0.5) if u == 0 else 1.0) * 0.5 * math.cos((2 * x + 1) * u * math.pi / 16)
+        for x in range(8)] for u in range(8)]
+
+
+def scale_qt(qt, quality):
+    s = 5000 // quality if quality < 50 else 200 - 2 * quality
+    return [min(255, max(1, (q * s + 50) // 100)) for q in qt]
+
+
+def huff_codes(bits, vals):
+    codes, code, k = {}, 0, 0
+    for length in range(1, 17):
+        for _ in range(bits[length - 1]):
+            codes[vals[k]] = (code, length)
+            code += 1
+            k += 1
+        code <<= 1
+    return codes
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.n = 0
+
+    def put(self, code, length):
+        self.acc = (self.acc << length) | code
+        self.n += length
+        while self.n >= 8:
+            b = (self.acc >> (self.n - 8)) & 0xFF
+            self.out.append(b)
+            if b == 0xFF:
+                self.out.append(0)
+            self.n -= 8
+        self.acc &= (1 << self.n) - 1
+
+    def flush(self):
+        if self.n:
+            self.put((1 << (8 - self.n)) - 1, 8 - self.n)
+
+
+def fdct(block):
+    tmp = [[sum(COS[u][x] * block[y * 8 + x] for x in range(8)) for u in range(8)]
+           for y in range(8)]
+    return [sum(COS[v][y] * tmp[y][u] for y in range(8)) for v in range(8) for u in range(8)]
+
+
+def magnitude(v):
+    n = abs(v).bit_length()
+    return n, (v if v >= 0 else v + (1 << n) - 1)
+
+
+def encode_block(bw, block, qt, pred, dc, ac):
+    coef = fdct([p - 128 for p in block])
+    q = [int(round(coef[ZIGZAG[i]] / qt[i])) for i in range(64)]
+    n, bits = magnitude(q[0] - pred)
+    bw.put(*dc[n])
+    if n:
+        bw.put(bits, n)
+    run = 0
+    for i in range(1, 64):
+        if q[i] == 0:
+            run += 1
+            continue
+        while run > 15:
+            bw.put(*ac[0xF0])
+            run -= 16
+        n, bits = magnitude(q[i])
+        bw.put(*ac[(run << 4) | n])
+        bw.put(bits, n)
+        run = 0
+    if run:
+        bw.put(*ac[0x00])
+    return q[0]
+
+
+def encode(w, h, pixel, quality=50):
+    """pixel(x, y) -> (Y, Cb, Cr); 4:2:2, MCU = 2 Luma-Blöcke nebeneinander."""
+    qts = [scale_qt(QT_LUM, quality), scale_qt(QT_CHR, quality)]
+    qzz = [[qt[ZIGZAG[i]] for i in range(64)] for qt in qts]
+    dc = [huff_codes(DC_LUM_BITS, DC_VALS), huff_codes(DC_CHR_BITS, DC_VALS)]
+    ac = [huff_codes(AC_LUM_BITS, AC_LUM_VALS), huff_codes(AC_CHR_BITS, AC_CHR_VALS)]
+    mcux, mcuy = (w + 15) // 16, (h + 7) // 8
+
+    def clamp(v):
+        return 0 if v < 0 else 255 if v > 255 else int(v)
+
+    bw = BitWriter()
+    pred = [0, 0, 0]
+    for my in range(mcuy):
+        for mx in range(mcux):
+            px = [[pixel(min(mx * 16 + x, w - 1), min(my * 8 + y, h - 1)) for x in range(16)]
+                  for y in range(8)]
+            for b in range(2):
+                blk = [clamp(px[y][b * 8 + x][0]) for y in range(8) for x in range(8)]
+                pred[0] = encode_block(bw, blk, qzz[0], pred[0], dc[0], ac[0])
+            for c in (1, 2):
+                blk = [clamp((px[y][2 * x][c] + px[y][2 * x + 1][c]) / 2)
+                       for y in range(8) for x in range(8)]
+                pred[c] = encode_block(bw, blk, qzz[1], pred[c], dc[1], ac[1])
+    bw.flush()
+
+    def seg(marker, body):
+        return struct.pack(">BBH", 0xFF, marker, len(body) + 2) + body
+
+    def dht(cls, idx, bits, vals):
+        return bytes([cls << 4 | idx]) + bytes(bits) + bytes(vals)
+
+    out = bytearray(b"\xFF\xD8")
+    out += seg(0xE0, b"JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00")
+    out += seg(0xDB, bytes([0]) + bytes(qts[0][ZIGZAG[i]] for i in range(64)))
+    out += seg(0xDB, bytes([1]) + bytes(qts[1][ZIGZAG[i]] for i in range(64)))
+    out += seg(0xC0, struct.pack(">BHHB", 8, h, w, 3) +
+               bytes([1, 0x21, 0, 2, 0x11, 1, 3, 0x11, 1]))
+    out += seg(0xC4, dht(0, 0, DC_LUM_BITS, DC_VALS) + dht(1, 0, AC_LUM_BITS, AC_LUM_VALS) +
+               dht(0, 1, DC_CHR_BITS, DC_VALS) + dht(1, 1, AC_CHR_BITS, AC_CHR_VALS))
+    out += seg(0xDA, bytes([3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0]))
+    out += bw.out + b"\xFF\xD9"
+    return bytes(out)
+
+
+def scene(w, h, seed, gain=0, block=None):
+    """Verlauf mit zwei festen Flächen, Rauschen ±2; block = (x, y, Kante) hell."""
+    rnd = random.Random(seed)
+    noise = [rnd.randint(-2, 2) for _ in range(4096)]
+
+    def pixel(x, y):
+        Y = 60 + 100 * x // w + 40 * y // h + noise[(x * 31 + y * 17) & 4095] + gain
+        cb, cr = 128 - 20 * y // h, 128 + 15 * x // w
+        if w // 8 <= x < w // 4 and h // 2 <= y < 3 * h // 4:
+            Y, cb, cr = Y - 40, 150, 110
+        if 3 * w // 5 <= x < 3 * w // 4 and h // 6 <= y < h // 3:
+            Y, cb, cr = Y + 30, 100, 150
+        if block and block[0] <= x < block[0] + block[2] and block[1] <= y < block[1] + block[2]:
+            Y, cb, cr = 235, 128, 128
+        return Y, cb, cr
+    return pixel
+
+
+def sequence(name, w, h, count, quality):
+    """Frames einer Szene als Liste von (Dateiname, JPEG)."""
+    edge = w // 8
+    frames = []
+    for i in range(count):
+        if name == "moving":
+            x = w // 16 + i * (w - edge - w // 8) // max(1, count - 1)
+            pix = scene(w, h, i, block=(x, h // 2 - edge // 2, edge))
+        elif name == "aec":
+            pix = scene(w, h, i, gain=25)
+        else:
+            pix = scene(w, h, i)
+        frames.append(("%s_%dx%d_%02d.jpg" % (name, w, h, i), encode(w, h, pix, quality)))
+    return frames
+
+
+# Fixtures für host/test/test_motion.c
+FIXTURES = [
+    ("still", 640, 480, 4),
+    ("moving", 640, 480, 5),
+    ("aec", 640, 480, 1),
+    ("still", 1024, 768, 1),
+    ("moving", 1024, 768, 2),
+]
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("outdir")
+    ap.add_argument("--scene", choices=["still", "moving", "aec"])
+    ap.add_argument("--size", default="640x480", help="BxH, Breite durch 16 teilbar")
+    ap.add_argument("--count", type=int, default=10)
+    ap.add_argument("--quality", type=int, default=50)
+    args = ap.parse_args()
+
+    os.makedirs(args.outdir, exist_ok=True)
+    if args.scene:
+        w, h = (int(v) for v in args.size.split("x"))
+        jobs = [(args.scene, w, h, args.count)]
+    else:
+        jobs = FIXTURES
+    for name, w, h, count in jobs:
+        for fname, data in sequence(name, w, h, count, args.quality):
+            with open(os.path.join(args.outdir, fname), "wb") as f:
+                f.write(data)
+            print("%s: %d bytes" % (fname, len(data)))
+
+
+if __name__ == "__main__":
+    main()
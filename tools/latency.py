@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Latenz, Jitter und Lücken eines /stream aus den Part-Headern.
+
+Jeder Part trägt X-Frame-Seq, X-Timestamp (Aufnahme), X-Enqueue-Us
+(Veröffentlichung im Ring), X-Send-Us (Sendebeginn) und X-Prev-Sent-Us
+(Sendeende des vorigen Parts), alle auf der esp_timer-Uhr des Boards. Das
+Skript liest den Stream, stempelt jeden Part beim Empfang und wertet aus:
+
+  * Stufen auf dem Gerät: Aufnahme → Ring → Sendebeginn, Sendedauer
+  * Aufnahme → Empfang: Die Board-Uhr wird über den kleinsten Abstand
+    zwischen Sendebeginn und Ankunft des Part-Headers auf die Host-Uhr
+    gelegt. Die Werte enthalten damit alles außer der minimalen
+    Netzlaufzeit (im WLAN meist 1–3 ms).
+  * Jitter: Ankunftsabstände gegen Aufnahmeabstände (wie RFC 3550)
+  * Lücken: fehlende X-Frame-Seq, also beim Client übersprungene Frames
+
+Beispiele:
+    tools/latency.py 192.168.1.50 --duration 30
+    tools/latency.py 192.168.1.50 --fps 10 --csv frames.csv --json lat.json
+    tools/latency.py 127.0.0.1:8080        # gegen host/look_host
+"""
+import argparse
+import csv
+import json
+import socket
+import sys
+import time
+
+from bench import BOUNDARY_RE, percentile, split_host
+
+
+def read_parts(host, port, path, duration, warmup):
+    """Liefert pro Frame ein dict mit Headern und Host-Empfangszeiten (µs)."""
+    sock = socket.create_connection((host, port), timeout=10)
+    sock.sendall(f"GET {path} HTTP/1.1\r\nHost: {host}\r\n\r\n".encode())
+    f = sock.makefile("rb")
+    status = f.readline()
+    if b" 200 " not in status:
+        raise SystemExit(f"stream: {status.strip().decode(errors='replace')}")
+    boundary = b"frame"
+    while True:
+        line = f.readline()
+        if not line or line in (b"\r\n", b"\n"):
+            break
+        m = BOUNDARY_RE.search(line)
+        if m:
+            boundary = m.group(1)
+
+    marker = b"--" + boundary
+    t_start = time.monotonic()
+    stop_at = t_start + warmup + duration
+    frames = []
+    while time.monotonic() < stop_at:
+        line = f.readline()
+        if not line:
+            raise SystemExit("stream closed by device")
+        if not line.startswith(marker):
+            continue
+        t_hdr = time.monotonic()
+        hdr = {}
+        while True:
+            h = f.readline()
+            if not h or h in (b"\r\n", b"\n"):
+                break
+            k, _, v = h.partition(b":")
+            hdr[k.strip().lower().decode()] = v.strip().decode()
+        length = int(hdr.get("content-length", "-1"))
+        if length < 0:
+            raise SystemExit("part without Content-Length")
+        if len(f.read(length)) != length:
+            raise SystemExit("short frame")
+        t_done = time.monotonic()
+        if "x-frame-seq" not in hdr:
+            raise SystemExit("device sends no X-Frame-Seq headers (old firmware?)")
+        if t_hdr < t_start + warmup:
+            continue
+        sec, _, usec = hdr["x-timestamp"].partition(".")
+        frames.append({
+            "seq": int(hdr["x-frame-seq"]),
+            "bytes": length,
+            "capture_us": int(sec) * 1000000 + int(usec or 0),
+            "enqueue_us": int(hdr.get("x-enqueue-us", 0)),
+            "send_us": int(hdr.get("x-send-us", 0)),
+            "prev_sent_us": int(hdr.get("x-prev-sent-us", 0)),
+            "hdr_host_us": t_hdr * 1e6,
+            "done_host_us": t_done * 1e6,
+        })
+    sock.close()
+    return frames
+
+
+def analyze(frames):
+    if len(frames) < 2:
+        raise SystemExit("too few frames")
+
+    # Board-Uhr → Host-Uhr über die schnellste Übertragung des Part-Headers
+    offset = min(fr["hdr_host_us"] - fr["send_us"] for fr in frames)
+    for fr in frames:
+        fr["latency_ms"] = (fr["done_host_us"] - offset - fr["capture_us"]) / 1000.0
+        fr["queue_ms"] = (fr["enqueue_us"] - fr["capture_us"]) / 1000.0
+        fr["wait_ms"] = (fr["send_us"] - fr["enqueue_us"]) / 1000.0
+
+    # Sendedauer steht im nächsten Part (Sendeende des vorigen)
+    send_ms = [(b["prev_sent_us"] - a["send_us"]) / 1000.0
+               for a, b in zip(frames, frames[1:]) if b["prev_sent_us"]]
+
+    gaps, missing, jitter, arrival = [], 0, 0.0, []
+    jit_series = []
+    for a, b in zip(frames, frames[1:]):
+        d_seq = b["seq"] - a["seq"]
+        if d_seq > 1:
+            gaps.append((a["seq"], d_seq - 1))
+            missing += d_seq - 1
+        arrival.append((b["done_host_us"] - a["done_host_us"]) / 1000.0)
+        d = abs((b["done_host_us"] - a["done_host_us"]) - (b["capture_us"] - a["capture_us"]))
+        jitter += (d / 1000.0 - jitter) / 16.0
+        jit_series.append(d / 1000.0)
+
+    def stats(vals):
+        return {"p50": round(percentile(vals, 50), 1), "p95": round(percentile(vals, 95), 1),
+                "p99": round(percentile(vals, 99), 1), "max": round(max(vals) if vals else 0.0, 1)}
+
+    span = (frames[-1]["done_host_us"] - frames[0]["done_host_us"]) / 1e6
+    return {
+        "frames": len(frames),
+        "fps": round((len(frames) - 1) / span, 2) if span > 0 else 0.0,
+        "latency_ms": stats([fr["latency_ms"] for fr in frames]),
+        "capture_to_ring_ms": stats([fr["queue_ms"] for fr in frames]),
+        "ring_to_send_ms": stats([fr["wait_ms"] for fr in frames]),
+        "send_ms": stats(send_ms),
+        "arrival_gap_ms": stats(arrival),
+        "jitter_ms": round(jitter, 2),
+        "jitter_abs_ms": stats(jit_series),
+        "seq_first": frames[0]["seq"],
+        "seq_last": frames[-1]["seq"],
+        "missing": missing,
+        "loss_pct": round(missing * 100.0 / (frames[-1]["seq"] - frames[0]["seq"] + 1), 2),
+        "gaps": len(gaps),
+        "largest_gaps": sorted(gaps, key=lambda g: -g[1])[:5],
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("host", help="IP[:Port] des Boards oder des Replay-Servers")
+    ap.add_argument("--fps", type=int, default=0, help="?fps= für den Stream")
+    ap.add_argument("--duration", type=float, default=15.0, help="Messdauer in s")
+    ap.add_argument("--warmup", type=float, default=2.0, help="nicht gewertete Anlaufzeit in s")
+    ap.add_argument("--csv", help="Werte pro Frame als CSV speichern")
+    ap.add_argument("--json", help="Zusammenfassung als JSON speichern")
+    args = ap.parse_args()
+
+    host, port = split_host(args.host)
+    path = "/stream" + (f"?fps={args.fps}" if args.fps else "")
+    frames = read_parts(host, port, path, args.duration, args.warmup)
+    res = analyze(frames)
+
+    print(f"{res['frames']} frames, {res['fps']:.1f} fps, seq {res['seq_first']}..{res['seq_last']}, "
+          f"{res['missing']} skipped ({res['loss_pct']:.1f}%) in {res['gaps']} gaps")
+    print(f"{'stage [ms]':<22} {'p50':>7} {'p95':>7} {'p99':>7} {'max':>7}")
+    for name, key in (("capture -> ring", "capture_to_ring_ms"),
+                      ("ring -> send start", "ring_to_send_ms"),
+                      ("send duration", "send_ms"),
+                      ("capture -> receive", "latency_ms"),
+                      ("arrival gap", "arrival_gap_ms"),
+                      ("|arrival - capture|", "jitter_abs_ms")):
+        s = res[key]
+        print(f"{name:<22} {s['p50']:>7.1f} {s['p95']:>7.1f} {s['p99']:>7.1f} {s['max']:>7.1f}")
+    print(f"jitter (RFC 3550) {res['jitter_ms']:.2f} ms")
+    if res["largest_gaps"]:
+        print("largest gaps: " + ", ".join(f"after {s}: {n}" for s, n in res["largest_gaps"]))
+
+    if args.csv:
+        keys = ["seq", "bytes", "capture_us", "enqueue_us", "send_us", "prev_sent_us",
+                "latency_ms", "queue_ms", "wait_ms"]
+        with open(args.csv, "w", newline="") as fh:
+            w = csv.DictWriter(fh, fieldnames=keys, extrasaction="ignore")
+            w.writeheader()
+            w.writerows(frames)
+    if args.json:
+        with open(args.json, "w") as fh:
+            json.dump(res, fh, indent=2)
+    sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""RTSP-Session ohne weitere Anfragen offen halten und den RTP-Fluss prüfen.
+
+Spielt einen minimalen Client: OPTIONS, DESCRIBE, SETUP, PLAY und danach
+keine RTSP-Anfrage mehr. Bei UDP gehen nur RTCP Receiver Reports an
+server_port+1 — genau das, was VLC/ffmpeg während einer langen Wiedergabe
+schicken. Ausgewertet werden Pakete, vollständige Frames (Marker-Bit),
+Sequenzlücken und die längste Pause im Fluss.
+
+Exit-Code 0, wenn der Stream bis zum Ende lief; mit --expect-timeout, wenn
+der Server die Session vorher beendet hat (Gegenprobe ohne RTCP).
+
+Beispiele:
+    tools/rtsp_check.py 192.168.1.50 --duration 90
+    tools/rtsp_check.py 127.0.0.1:8554 --duration 25             # look_host, Timeout 10 s
+    tools/rtsp_check.py 127.0.0.1:8554 --duration 25 --rtcp-interval 0 --expect-timeout
+    tools/rtsp_check.py 127.0.0.1:8554 --transport tcp
+"""
+import argparse
+import re
+import select
+import socket
+import struct
+import sys
+import time
+
+
+class Rtsp:
+    def __init__(self, host, port, timeout=5.0):
+        self.url = "rtsp://%s:%d/stream" % (host, port)
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.cseq = 0
+        self.session = None
+        self.buf = b""
+
+    def request(self, method, url=None, headers=None):
+        self.cseq += 1
+        lines = ["%s %s RTSP/1.0" % (method, url or self.url), "CSeq: %d" % self.cseq]
+        if self.session:
+            lines.append("Session: %s" % self.session)
+        lines += ["%s: %s" % kv for kv in (headers or {}).items()]
+        self.sock.sendall(("\r\n".join(lines) + "\r\n\r\n").encode())
+        return self.response()
+
+    def response(self):
+        while True:
+            # Interleaved-Pakete vor der Antwort überspringen
+            while len(self.buf) >= 4 and self.buf[0:1] == b"$":
+                n = 4 + struct.unpack("!H", self.buf[2:4])[0]
+                if len(self.buf) < n:
+                    break
+                self.buf = self.buf[n:]
+            if self.buf[0:1] != b"$" and b"\r\n\r\n" in self.buf:
+                break
+            data = self.sock.recv(65536)
+            if not data:
+                raise ConnectionError("RTSP connection closed")
+            self.buf += data
+        head, self.buf = self.buf.split(b"\r\n\r\n", 1)
+        lines = head.decode(errors="replace").split("\r\n")
+        status = int(lines[0].split()[1])
+        hdrs = {}
+        for line in lines[1:]:
+            k, _, v = line.partition(":")
+            hdrs[k.strip().lower()] = v.strip()
+        body_len = int(hdrs.get("content-length", 0))
+        while len(self.buf) < body_len:
+            self.buf += self.sock.recv(4096)
+        body, self.buf = self.buf[:body_len], self.buf[body_len:]
+        if status != 200:
+            raise RuntimeError("%s -> %d" % (lines[0], status))
+        return hdrs, body
+
+
+class Flow:
+    """Zählt RTP-Pakete und Frames, merkt sich Lücken und Pausen."""
+
+    def __init__(self):
+        self.packets = self.frames = self.lost = 0
+        self.seq = None
+        self.first = self.last = None
+        self.max_gap = 0.0
+
+    def rtp(self, pkt, now):
+        if len(pkt) < 12 or pkt[0] >> 6 != 2:
+            return
+        seq = struct.unpack("!H", pkt[2:4])[0]
+        if self.seq is not None:
+            self.lost += (seq - self.seq - 1) & 0xFFFF
+        self.seq = seq
+        self.packets += 1
+        if pkt[1] & 0x80:
+            self.frames += 1
+        if self.last is not None:
+            self.max_gap = max(self.max_gap, now - self.last)
+        self.first = self.first or now
+        self.last = now
+
+
+def rtcp_rr(ssrc):
+    # Receiver Report ohne Report-Block (V=2, RC=0, PT=201, Länge 1)
+    return struct.pack("!BBHI", 0x80, 201, 1, ssrc)
+
+
+def rtcp_bye(ssrc):
+    return struct.pack("!BBHI", 0x81, 203, 1, ssrc)
+
+
+def open_udp_pair():
+    for _ in range(20):
+        rtp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        rtp.bind(("0.0.0.0", 0))
+        port = rtp.getsockname()[1]
+        if port % 2:
+            rtp.close()
+            continue
+        rtcp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        try:
+            rtcp.bind(("0.0.0.0", port + 1))
+        except OSError:
+            rtp.close()
+            rtcp.close()
+            continue
+        return rtp, rtcp, port
+    raise OSError("no free even/odd UDP port pair")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host", help="IP[:Port] des Boards oder von look_host (Port 554)")
+    ap.add_argument("--transport", choices=["udp", "tcp"], default="udp")
+    ap.add_argument("--duration", type=float, default=90.0,
+                    help="Laufzeit ohne RTSP-Anfragen in s (über dem Session-Timeout wählen)")
+    ap.add_argument("--rtcp-interval", type=float, default=5.0,
+                    help="s zwischen Receiver Reports, 0 = keine (nur UDP)")
+    ap.add_argument("--expect-timeout", action="store_true",
+                    help="Erfolg, wenn der Server die Session vor --duration beendet")
+    ap.add_argument("--stall", type=float, default=3.0,
+                    help="so lange ohne RTP gilt die Session als beendet (s)")
+    args = ap.parse_args()
+
+    host, _, port = args.host.partition(":")
+    port = int(port) if port else 554
+    c = Rtsp(host, port)
+    c.request("OPTIONS")
+    _, sdp = c.request("DESCRIBE", headers={"Accept": "application/sdp"})
+    m = re.search(rb"a=control:(\S+)", sdp.split(b"m=video", 1)[-1])
+    track = m.group(1).decode() if m else "track1"
+    track_url = track if track.startswith("rtsp:") else c.url + "/" + track
+
+    ssrc = 0x10C0FFEE
+    rtp = rtcp = None
+    if args.transport == "udp":
+        rtp, rtcp, cport = open_udp_pair()
+        hdrs, _ = c.request("SETUP", track_url,
+                            {"Transport": "RTP/AVP;unicast;client_port=%d-%d" % (cport, cport + 1)})
+        sp = re.search(r"server_port=(\d+)-(\d+)", hdrs.get("transport", ""))
+        if not sp:
+            sys.exit("SETUP without server_port: %s" % hdrs.get("transport"))
+        rtcp_to = (host, int(sp.group(2)))
+        print("udp: client %d-%d, server %s-%s" % (cport, cport + 1, sp.group(1), sp.group(2)))
+    else:
+        hdrs, _ = c.request("SETUP", track_url,
+                            {"Transport": "RTP/AVP/TCP;unicast;interleaved=0-1"})
+    c.session = hdrs.get("session", "").split(";")[0]
+    c.request("PLAY", headers={"Range": "npt=0.000-"})
+
+    flow = Flow()
+    t0 = time.monotonic()
+    next_rr = t0 + args.rtcp_interval if args.rtcp_interval > 0 else None
+    ended = None
+    c.sock.setblocking(False)
+    while True:
+        now = time.monotonic()
+        if now - t0 >= args.duration:
+            break
+        if flow.last and now - flow.last > args.stall:
+            ended = flow.last - t0
+            break
+        if rtcp and next_rr and now >= next_rr:
+            rtcp.sendto(rtcp_rr(ssrc), rtcp_to)
+            next_rr += args.rtcp_interval
+        socks = [c.sock] + ([rtp, rtcp] if rtp else [])
+        ready, _, _ = select.select(socks, [], [], 0.2)
+        for s in ready:
+            if s is rtp:
+                flow.rtp(rtp.recv(65536), time.monotonic())
+            elif s is rtcp:
+                rtcp.recv(2048)
+            else:
+                try:
+                    data = c.sock.recv(65536)
+                except BlockingIOError:
+                    continue
+                if not data:
+                    ended = time.monotonic() - t0
+                    break
+                c.buf += data
+                # Interleaved: $ Kanal Länge Paket
+                while len(c.buf) >= 4 and c.buf[0:1] == b"$":
+                    n = struct.unpack("!H", c.buf[2:4])[0]
+                    if len(c.buf) < 4 + n:
+                        break
+                    if c.buf[1] == 0:
+                        flow.rtp(c.buf[4:4 + n], time.monotonic())
+                    c.buf = c.buf[4 + n:]
+        if ended is not None:
+            break
+
+    span = (flow.last - flow.first) if flow.packets > 1 else 0
+    fps = (flow.frames - 1) / span if span > 0 else 0
+    print("%s: %d packets, %d frames (%.1f fps), %d lost, longest pause %.0f ms"
+          % (args.transport, flow.packets, flow.frames, fps, flow.lost, flow.max_gap * 1000))
+    if ended is not None:
+        print("session ended by server after %.1f s" % ended)
+    else:
+        print("session alive after %.1f s" % args.duration)
+        c.sock.setblocking(True)
+        if rtcp:
+            rtcp.sendto(rtcp_bye(ssrc), rtcp_to)
+        try:
+            c.request("TEARDOWN")
+        except (ConnectionError, RuntimeError, OSError):
+            pass
+
+    ok = flow.frames > 0 and (ended is not None) == args.expect_timeout
+    print("OK" if ok else "FAIL")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()